@@ -0,0 +1,480 @@
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include <cairo.h>
+
+#include "boardrenderer.h"
+#include "trace.h"
+
+static const BoardPalette LIGHT_PALETTE =
+{
+    { 255/255.0 , 255/255.0 , 255/255.0 , 1.0 },
+    {   0/255.0 ,   0/255.0 ,   0/255.0 , 1.0 },
+    {  74/255.0 , 144/255.0 , 226/255.0 , 1.0 },
+    { 226/255.0 , 231/255.0 , 237/255.0 , 1.0 },
+    { 187/255.0 , 222/255.0 , 251/255.0 , 1.0 },
+    {   1/255.0 ,   2/255.0 , 255/255.0 , 1.0 },
+    { 190/255.0 , 198/255.0 , 212/255.0 , 1.0 },
+    { 229/255.0 ,  57/255.0 ,  53/255.0 , 1.0 },
+};
+
+static const BoardPalette DARK_PALETTE =
+{
+    {  45/255.0 ,  45/255.0 ,  45/255.0 , 1.0 },
+    { 171/255.0 , 171/255.0 , 171/255.0 , 1.0 },
+    { 255/255.0 , 255/255.0 , 255/255.0 , 1.0 },
+    { 141/255.0 ,  38/255.0 ,  99/255.0 , 1.0 },
+    {  86/255.0 , 187/255.0 , 235/255.0 , 1.0 },
+    {  44/255.0 , 243/255.0 , 151/255.0 , 1.0 },
+    { 241/255.0 , 224/255.0 ,  10/255.0 , 1.0 },
+    { 255/255.0 ,  82/255.0 ,  82/255.0 , 1.0 },
+};
+
+const BoardPalette& get_palette( Themes theme ) noexcept( true )
+{
+    switch ( theme )
+    {
+        case Themes::DARK:
+            return DARK_PALETTE;
+        default:
+        case Themes::LIGHT:
+            return LIGHT_PALETTE;
+    }
+}
+
+void set_rgba( const Cairo::RefPtr<Cairo::Context> & cairo_context , const BoardRGBA& rgba )
+{
+    cairo_context->set_source_rgba( rgba.red , rgba.green , rgba.blue , rgba.alpha );
+}
+
+BoardRenderer::BoardRenderer( const Glib::ustring& candidate_font , const Glib::ustring& solutions_font ) noexcept( false ):
+    candidate_font( candidate_font ),
+    solutions_font( solutions_font ),
+    theme( Themes::LIGHT ),
+    scale( 1 )
+{
+    //layout from pangocairo font map,no widget or display needed
+    auto measure_surface = Cairo::ImageSurface::create( Cairo::FORMAT_ARGB32 , 1 , 1 );
+    this->layout = Pango::Layout::create( Cairo::Context::create( measure_surface ) );
+    this->layout->set_font_description( this->candidate_font );
+    this->font_size = this->candidate_font.get_size()/Pango::SCALE;
+    this->bold_line_size = this->font_size/2;
+    this->line_size = this->bold_line_size/2;
+    this->grid_size = 6*( this->font_size );
+    this->row_index_size = 5*this->font_size;
+    this->column_index_size = 5*this->font_size;
+    this->board_size = 2*( this->column_index_size ) + 9*( this->grid_size );
+}
+
+std::size_t BoardRenderer::get_board_size( void ) const noexcept( true )
+{
+    return this->board_size;
+}
+
+std::size_t BoardRenderer::get_grid_size( void ) const noexcept( true )
+{
+    return this->grid_size;
+}
+
+std::size_t BoardRenderer::get_row_index_size( void ) const noexcept( true )
+{
+    return this->row_index_size;
+}
+
+std::size_t BoardRenderer::get_column_index_size( void ) const noexcept( true )
+{
+    return this->column_index_size;
+}
+
+std::size_t BoardRenderer::get_bold_line_size( void ) const noexcept( true )
+{
+    return this->bold_line_size;
+}
+
+void BoardRenderer::set_theme( Themes theme ) noexcept( true )
+{
+    this->theme = theme;
+}
+
+Themes BoardRenderer::get_theme( void ) const noexcept( true )
+{
+    return this->theme;
+}
+
+void BoardRenderer::set_device_scale( int scale ) noexcept( true )
+{
+    this->scale = ( scale < 1 ) ? 1 : scale;
+}
+
+void BoardRenderer::draw_frame( const Cairo::RefPtr<Cairo::Context> & cairo_context , int width , int height , const BoardView& view )
+{
+    SUDOKU_TRACE_SCOPE( "BoardRenderer::draw_frame" );
+    cairo_context->save();
+    cairo_context->set_line_join( Cairo::LINE_JOIN_MITER );
+
+    //background,index,box
+    this->update_layer_cache( width , height );
+    cairo_context->set_source( this->base_layer , 0 , 0 );
+    cairo_context->paint();
+
+    if ( view.select_cell )
+        this->draw_highlight( cairo_context , view.select_x , view.select_y );
+
+    //board line over the highlight
+    cairo_context->set_source( this->line_layer , 0 , 0 );
+    cairo_context->paint();
+
+    this->draw_cells( cairo_context , view );
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_message( const Cairo::RefPtr<Cairo::Context> & cairo_context , const std::string& message )
+{
+    cairo_context->save();
+    this->draw_background_color( cairo_context );
+    set_rgba( cairo_context , get_palette( this->theme ).puzzle_number );
+    this->layout->set_font_description( this->candidate_font );
+    this->layout->set_text( message );
+    int layout_width = 0 , layout_height = 0;
+    this->layout->get_pixel_size( layout_width , layout_height );
+    cairo_context->move_to( this->board_size/2 - layout_width/2 , this->board_size/2 - layout_height/2 );
+    this->layout->show_in_cairo_context( cairo_context );
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_overlay( const Cairo::RefPtr<Cairo::Context> & cairo_context , const std::vector<std::string>& lines )
+{
+    if ( lines.empty() )
+        return ;
+    std::string text;
+    for ( const auto& line : lines )
+    {
+        if ( text.empty() == false )
+            text += '\n';
+        text += line;
+    }
+    cairo_context->save();
+    this->layout->set_font_description( this->candidate_font );
+    this->layout->set_text( text );
+    int layout_width = 0 , layout_height = 0;
+    this->layout->get_pixel_size( layout_width , layout_height );
+    int padding = this->font_size/2;
+    cairo_context->set_source_rgba( 0.0 , 0.0 , 0.0 , 0.7 );
+    cairo_context->rectangle( 0 , 0 , layout_width + padding*2 , layout_height + padding*2 );
+    cairo_context->fill();
+    cairo_context->set_source_rgba( 1.0 , 1.0 , 1.0 , 1.0 );
+    cairo_context->move_to( padding , padding );
+    this->layout->show_in_cairo_context( cairo_context );
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_print( const Cairo::RefPtr<Cairo::Context> & cairo_context , const puzzle_t& puzzle )
+{
+    this->draw_background_color( cairo_context );
+    this->draw_index( cairo_context );
+    this->draw_board_box( cairo_context );
+    this->draw_board_line( cairo_context );
+    this->draw_puzzle( cairo_context , puzzle );
+}
+
+void BoardRenderer::draw_background_color( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+{
+    cairo_context->save();
+    //draw background color
+    set_rgba( cairo_context , get_palette( this->theme ).background );
+    cairo_context->paint();
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_index( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+{
+    cairo_context->save();
+    constexpr const char * row_indexs[] =
+    {
+        "A" , "B" , "C" , "D" , "E" , "F" , "G" , "H" , "I"
+    };
+    constexpr const char * column_indexs[] =
+    {
+        "1" , "2" , "3" , "4" , "5" , "6" , "7" , "8" , "9"
+    };
+
+    //draw index
+    set_rgba( cairo_context , get_palette( this->theme ).puzzle_number );
+    this->layout->set_font_description( this->candidate_font );
+    cairo_context->set_line_width( this->line_size );
+    for( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        int layout_width , layout_height;
+        this->layout->set_text( row_indexs[i] );
+        this->layout->get_pixel_size( layout_width , layout_height );
+        cairo_context->move_to( this->row_index_size/2 - layout_width/2 ,
+            this->column_index_size + ( this->grid_size )/2 - ( this->font_size )/2 + i*( ( this->grid_size ) ) - layout_height/2 );
+        this->layout->show_in_cairo_context( cairo_context );
+        this->layout->set_text( column_indexs[i] );
+        this->layout->get_pixel_size( layout_width , layout_height );
+        cairo_context->move_to( this->row_index_size + ( this->grid_size )/2 - ( this->font_size )/2 + i*( ( this->grid_size ) ) - layout_width/2 ,
+            this->column_index_size/2 - layout_height/2 );
+        this->layout->show_in_cairo_context( cairo_context );
+    }
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_board_box( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+{
+    cairo_context->save();
+    //draw board box
+    set_rgba( cairo_context , get_palette( this->theme ).puzzle_number );
+    cairo_context->rectangle( this->row_index_size , this->column_index_size , SUDOKU_SIZE*( this->grid_size ) , SUDOKU_SIZE*( this->grid_size ) );
+    cairo_context->stroke();
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_board_line( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+{
+    cairo_context->save();
+    //draw board line
+    set_rgba( cairo_context , get_palette( this->theme ).puzzle_number );
+    for ( cell_t i = 1 ; i < SUDOKU_SIZE ; i++ )
+    {
+        if ( i%SUDOKU_BOX_SIZE == 0 )
+            cairo_context->set_line_width( this->bold_line_size );
+        else
+            cairo_context->set_line_width( this->line_size );
+        cairo_context->move_to( this->row_index_size + i*( this->grid_size ) , this->column_index_size );
+        cairo_context->line_to( this->row_index_size + i*( this->grid_size ) , this->column_index_size +
+                                SUDOKU_SIZE*( this->grid_size ) );
+
+        cairo_context->move_to( this->row_index_size , this->column_index_size + i*( this->grid_size ) );
+        cairo_context->line_to( this->row_index_size + SUDOKU_SIZE*( this->grid_size )
+                                , this->column_index_size + i*( this->grid_size ) );
+        cairo_context->stroke();
+    }
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_puzzle( const Cairo::RefPtr<Cairo::Context> & cairo_context , const puzzle_t& puzzle )
+{
+    cairo_context->save();
+    //draw puzzle
+    set_rgba( cairo_context , get_palette( this->theme ).puzzle_number );
+    this->layout->set_font_description( this->solutions_font );
+    for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+        {
+            cell_t number = puzzle[i][j];
+            if ( number == 0 )
+                continue;
+            this->layout->set_text( std::to_string( number ) );
+            int layout_width , layout_height;
+            this->layout->get_pixel_size( layout_width , layout_height );
+            cairo_context->move_to( this->row_index_size + j*( this->grid_size ) + ( this->grid_size )/2 - layout_width/2
+                                        , this->column_index_size + i*( this->grid_size ) + ( this->grid_size )/2 - layout_height/2 );
+            this->layout->show_in_cairo_context( cairo_context );
+        }
+    }
+
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_highlight( const Cairo::RefPtr<Cairo::Context> & cairo_context , cell_t x , cell_t y )
+{
+    cairo_context->save();
+    const BoardPalette& palette = get_palette( this->theme );
+    cell_t column_id = x;
+    cell_t row_id = y;
+    cell_t box_id = ( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + y/SUDOKU_BOX_SIZE;
+
+    set_rgba( cairo_context , palette.select_row );
+    cairo_context->rectangle( this->row_index_size + this->line_size + row_id*( this->grid_size ) , this->column_index_size + this->line_size ,
+                    ( this->grid_size ) - this->line_size , SUDOKU_SIZE*( this->grid_size ) - 2*this->line_size );
+    cairo_context->stroke_preserve();
+    cairo_context->fill();
+
+    cairo_context->rectangle( this->row_index_size + this->line_size , this->column_index_size + this->line_size + column_id*( this->grid_size ) ,
+                    SUDOKU_SIZE*( this->grid_size ) - 2*this->line_size , ( this->grid_size ) - 2*this->line_size );
+    cairo_context->stroke_preserve();
+    cairo_context->fill();
+
+    cairo_context->rectangle( this->row_index_size + this->line_size + box_id%SUDOKU_BOX_SIZE*SUDOKU_BOX_SIZE*( this->grid_size ) ,
+                    this->column_index_size + this->line_size + box_id/SUDOKU_BOX_SIZE*SUDOKU_BOX_SIZE*( this->grid_size ) ,
+                    SUDOKU_BOX_SIZE*( this->grid_size ) - 2*this->line_size , SUDOKU_BOX_SIZE*( this->grid_size ) - 2*this->line_size );
+    cairo_context->stroke_preserve();
+    cairo_context->fill();
+
+    set_rgba( cairo_context , palette.select_cell );
+    cairo_context->rectangle( this->column_index_size + this->line_size + row_id*( this->grid_size ) ,
+                        this->row_index_size + this->line_size + column_id*( this->grid_size ) ,
+                        ( this->grid_size ) - 2*this->line_size , ( this->grid_size ) - 2*this->line_size );
+    cairo_context->stroke_preserve();
+    cairo_context->fill();
+    cairo_context->restore();
+}
+
+void BoardRenderer::draw_cells( const Cairo::RefPtr<Cairo::Context> & cairo_context , const BoardView& view )
+{
+    if ( view.puzzle == nullptr )
+        return ;
+    this->update_glyph_cache();
+
+    const puzzle_t& puzzle = *view.puzzle;
+    cell_t select_number = 0;
+    if ( view.select_cell && view.highlight_number )
+        select_number = puzzle[view.select_x][view.select_y];
+
+    //one blit every cell
+    cairo_context->save();
+    for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+        {
+            cell_t number = puzzle[i][j];
+            if ( number != 0 )
+            {
+                GlyphColor color = PUZZLE_GLYPH;
+                if ( view.conflicts[ i*SUDOKU_SIZE + j ] )
+                {
+                    color = CONFLICT_GLYPH;
+                }
+                else if ( number == select_number )
+                {
+                    color = SELECT_GLYPH;
+                }
+                else if ( view.answers[ i*SUDOKU_SIZE + j ] )
+                {
+                    color = ANSWER_GLYPH;
+                }
+                this->draw_digit( cairo_context , i , j , number , color );
+                continue;
+            }
+            if ( view.candidates == nullptr )
+                continue;
+
+            std::uint32_t mask = 0;
+            for ( auto candidate : ( *view.candidates )[i][j] )
+            {
+                mask |= 1U << ( candidate - 1 );
+            }
+            if ( mask != 0 )
+                this->draw_candidates( cairo_context , i , j , mask );
+        }
+    }
+    cairo_context->restore();
+}
+
+Cairo::RefPtr<Cairo::ImageSurface> BoardRenderer::create_scaled_surface( int width , int height , int scale )
+{
+    auto surface = Cairo::ImageSurface::create( Cairo::FORMAT_ARGB32 , width*scale , height*scale );
+    cairo_surface_set_device_scale( surface->cobj() , scale , scale );
+    return surface;
+}
+
+void BoardRenderer::update_layer_cache( int width , int height )
+{
+    if ( this->base_layer && ( this->layer_theme == this->theme ) && ( this->layer_scale == this->scale ) &&
+         ( this->layer_width == width ) && ( this->layer_height == height ) )
+    {
+        return ;
+    }
+
+    this->base_layer = create_scaled_surface( width , height , this->scale );
+    auto base_context = Cairo::Context::create( this->base_layer );
+    base_context->set_line_join( Cairo::LINE_JOIN_MITER );
+    this->draw_background_color( base_context );
+    this->draw_index( base_context );
+    this->draw_board_box( base_context );
+
+    this->line_layer = create_scaled_surface( width , height , this->scale );
+    auto line_context = Cairo::Context::create( this->line_layer );
+    line_context->set_line_join( Cairo::LINE_JOIN_MITER );
+    this->draw_board_line( line_context );
+
+    this->layer_theme = this->theme;
+    this->layer_scale = this->scale;
+    this->layer_width = width;
+    this->layer_height = height;
+}
+
+void BoardRenderer::update_glyph_cache( void )
+{
+    if ( this->digit_glyphs && ( this->glyph_theme == this->theme ) && ( this->glyph_scale == this->scale ) )
+    {
+        return ;
+    }
+    const BoardPalette& palette = get_palette( this->theme );
+    int tile_size = this->grid_size;
+
+    this->digit_glyphs = create_scaled_surface( SUDOKU_SIZE*tile_size , _GLYPH_COLOR_COUNT*tile_size , this->scale );
+    auto digit_context = Cairo::Context::create( this->digit_glyphs );
+    const BoardRGBA * colors[_GLYPH_COLOR_COUNT] = { &palette.puzzle_number , &palette.answer_number ,
+                                                       &palette.select_number , &palette.conflict_number };
+    this->layout->set_font_description( this->solutions_font );
+    for ( int color = 0 ; color < _GLYPH_COLOR_COUNT ; color++ )
+    {
+        set_rgba( digit_context , *colors[color] );
+        for ( int k = 0 ; k < SUDOKU_SIZE ; k++ )
+        {
+            this->layout->set_text( std::to_string( k + 1 ) );
+            int layout_width , layout_height;
+            this->layout->get_pixel_size( layout_width , layout_height );
+            digit_context->move_to( k*tile_size + tile_size/2 - layout_width/2 , color*tile_size + tile_size/2 - layout_height/2 );
+            this->layout->show_in_cairo_context( digit_context );
+        }
+    }
+
+    this->candidate_glyphs = create_scaled_surface( SUDOKU_SIZE*tile_size , tile_size , this->scale );
+    auto candidate_context = Cairo::Context::create( this->candidate_glyphs );
+    set_rgba( candidate_context , palette.puzzle_number );
+    this->layout->set_font_description( this->candidate_font );
+    for ( int k = 0 ; k < SUDOKU_SIZE ; k++ )
+    {
+        this->layout->set_text( std::to_string( k + 1 ) );
+        candidate_context->move_to( k*tile_size + ( this->font_size )/2 + k%SUDOKU_BOX_SIZE*2*( this->font_size ) ,
+                                    k/SUDOKU_BOX_SIZE*2*( this->font_size ) );
+        this->layout->show_in_cairo_context( candidate_context );
+    }
+
+    this->candidate_atlas = create_scaled_surface( ATLAS_COLUMNS*tile_size , ( ATLAS_TILES/ATLAS_COLUMNS )*tile_size , this->scale );
+    this->atlas_rendered.reset();
+
+    this->glyph_theme = this->theme;
+    this->glyph_scale = this->scale;
+}
+
+void BoardRenderer::blit_tile( const Cairo::RefPtr<Cairo::Context> & cairo_context , const Cairo::RefPtr<Cairo::ImageSurface>& source ,
+                               int tile_x , int tile_y , cell_t x , cell_t y )
+{
+    double cell_x = this->row_index_size + y*( this->grid_size );
+    double cell_y = this->column_index_size + x*( this->grid_size );
+    cairo_context->set_source( source , cell_x - tile_x , cell_y - tile_y );
+    cairo_context->rectangle( cell_x , cell_y , this->grid_size , this->grid_size );
+    cairo_context->fill();
+}
+
+void BoardRenderer::draw_digit( const Cairo::RefPtr<Cairo::Context> & cairo_context , cell_t x , cell_t y , cell_t number , GlyphColor color )
+{
+    this->blit_tile( cairo_context , this->digit_glyphs , ( number - 1 )*this->grid_size , color*this->grid_size , x , y );
+}
+
+void BoardRenderer::draw_candidates( const Cairo::RefPtr<Cairo::Context> & cairo_context , cell_t x , cell_t y , std::uint32_t mask )
+{
+    int tile_size = this->grid_size;
+    int tile_x = ( mask%ATLAS_COLUMNS )*tile_size;
+    int tile_y = ( mask/ATLAS_COLUMNS )*tile_size;
+    if ( this->atlas_rendered[mask] == false )
+    {
+        auto atlas_context = Cairo::Context::create( this->candidate_atlas );
+        for ( int k = 0 ; k < SUDOKU_SIZE ; k++ )
+        {
+            if ( ( mask & ( 1U << k ) ) == 0 )
+                continue;
+            atlas_context->set_source( this->candidate_glyphs , tile_x - k*tile_size , tile_y );
+            atlas_context->rectangle( tile_x , tile_y , tile_size , tile_size );
+            atlas_context->fill();
+        }
+        this->atlas_rendered[mask] = true;
+    }
+    this->blit_tile( cairo_context , this->candidate_atlas , tile_x , tile_y , x , y );
+}
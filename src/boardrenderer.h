@@ -0,0 +1,180 @@
+#pragma once
+#ifndef BOARDRENDERER_H
+#define BOARDRENDERER_H
+
+#include <cstdint>
+
+#include <bitset>
+#include <string>
+#include <vector>
+
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+#include <pangomm/fontdescription.h>
+#include <pangomm/layout.h>
+
+#include "sudoku.h"
+
+//plain color,no gdk dependency so renderer work without display
+struct BoardRGBA
+{
+    double red;
+    double green;
+    double blue;
+    double alpha;
+};
+
+enum class Themes:std::uint32_t
+{
+    LIGHT,
+    DARK
+};
+
+struct BoardPalette
+{
+    BoardRGBA background;
+    BoardRGBA puzzle_number;
+    BoardRGBA answer_number;
+    BoardRGBA select_row;
+    BoardRGBA select_cell;
+    BoardRGBA select_number;
+    BoardRGBA button_border;
+    BoardRGBA conflict_number;
+};
+
+const BoardPalette& get_palette( Themes theme ) noexcept( true );
+
+void set_rgba( const Cairo::RefPtr<Cairo::Context> & cairo_context , const BoardRGBA& rgba );
+
+//content of one frame,independent of widget and game state
+struct BoardView
+{
+    const puzzle_t * puzzle = nullptr;
+    //nullptr:don't draw pencil marks( solution view )
+    const candidate_t * candidates = nullptr;
+    //cells filled by player,bit index:x*SUDOKU_SIZE + y
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > answers;
+    //digits repeated in a unit,drawn in conflict color over any other
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > conflicts;
+    bool select_cell = false;
+    cell_t select_x = 0;
+    cell_t select_y = 0;
+    //digits equal to selected cell digit use select color
+    bool highlight_number = true;
+};
+
+//draw sudoku board onto any cairo context( widget,image,pdf ).
+//own pango layout and surface caches,one instance per thread
+class BoardRenderer
+{
+    public:
+        BoardRenderer( const Glib::ustring& candidate_font = "Ubuntu Mono 14" ,
+                       const Glib::ustring& solutions_font = "Ubuntu Mono 28" ) noexcept( false );
+        BoardRenderer( const BoardRenderer& ) = delete;
+        BoardRenderer& operator=( const BoardRenderer& ) = delete;
+        ~BoardRenderer() = default;
+
+        /*
+        * column_index_size: 5*$(font size)
+        * '  A  '
+        *
+        * grid size: 6*$(font size)
+        *    '       '
+        *    ' 1 2 3 '
+        *    '       '
+        *    ' 4 5 6 '
+        *    '       '
+        *    ' 7 8 9 '
+        *    '       '
+        *  board size: column_index_size*2 + 9*grid_size
+        */
+        std::size_t get_board_size( void ) const noexcept( true );
+        std::size_t get_grid_size( void ) const noexcept( true );
+        std::size_t get_row_index_size( void ) const noexcept( true );
+        std::size_t get_column_index_size( void ) const noexcept( true );
+        std::size_t get_bold_line_size( void ) const noexcept( true );
+
+        void set_theme( Themes theme ) noexcept( true );
+        Themes get_theme( void ) const noexcept( true );
+        //device pixel per user unit of cached surface( hidpi scale factor )
+        void set_device_scale( int scale ) noexcept( true );
+
+        //playing/solution frame,static layers and glyphs from cache
+        void draw_frame( const Cairo::RefPtr<Cairo::Context> & cairo_context , int width , int height , const BoardView& view );
+        //pause/loading frame
+        void draw_message( const Cairo::RefPtr<Cairo::Context> & cairo_context , const std::string& message );
+        //text lines in a translucent box at top left,over a drawn frame( performance hud )
+        void draw_overlay( const Cairo::RefPtr<Cairo::Context> & cairo_context , const std::vector<std::string>& lines );
+        //board and puzzle as vector path,for print surface
+        void draw_print( const Cairo::RefPtr<Cairo::Context> & cairo_context , const puzzle_t& puzzle );
+
+        //single passes,uncached
+        void draw_background_color( const Cairo::RefPtr<Cairo::Context> & cairo_context );
+        void draw_index( const Cairo::RefPtr<Cairo::Context> & cairo_context );
+        void draw_board_box( const Cairo::RefPtr<Cairo::Context> & cairo_context );
+        void draw_board_line( const Cairo::RefPtr<Cairo::Context> & cairo_context );
+        void draw_puzzle( const Cairo::RefPtr<Cairo::Context> & cairo_context , const puzzle_t& puzzle );
+        //row,column,box and cell of the selected cell
+        void draw_highlight( const Cairo::RefPtr<Cairo::Context> & cairo_context , cell_t x , cell_t y );
+        //digits and pencil marks,blit from glyph cache
+        void draw_cells( const Cairo::RefPtr<Cairo::Context> & cairo_context , const BoardView& view );
+    private:
+        //pre-rendered glyphs,every tile is grid_size*grid_size
+        //digit_glyphs:row is GlyphColor,column k is digit k + 1
+        //candidate_glyphs:tile k is candidate k + 1 at its position in cell
+        //candidate_atlas:tile index is 9 bit candidate mask,ATLAS_COLUMNS tiles a row,
+        //  composed from candidate_glyphs at first use,so only the masks really appear occupy memory
+        enum GlyphColor
+        {
+            PUZZLE_GLYPH = 0,
+            ANSWER_GLYPH,
+            SELECT_GLYPH,
+            CONFLICT_GLYPH,
+            _GLYPH_COLOR_COUNT
+        };
+        static constexpr int ATLAS_COLUMNS = 32;
+        static constexpr int ATLAS_TILES = 1 << SUDOKU_SIZE;
+
+        //hidpi:surface in device pixel,drawing in user coordinate
+        static Cairo::RefPtr<Cairo::ImageSurface> create_scaled_surface( int width , int height , int scale );
+        //static layers of the board,only rebuild when theme,scale factor or size changed
+        void update_layer_cache( int width , int height );
+        //glyphs,only rebuild when theme or scale factor changed
+        void update_glyph_cache( void );
+        //copy a grid_size tile of source to board cell ( x , y )
+        void blit_tile( const Cairo::RefPtr<Cairo::Context> & cairo_context , const Cairo::RefPtr<Cairo::ImageSurface>& source ,
+                        int tile_x , int tile_y , cell_t x , cell_t y );
+        void draw_digit( const Cairo::RefPtr<Cairo::Context> & cairo_context , cell_t x , cell_t y , cell_t number , GlyphColor color );
+        void draw_candidates( const Cairo::RefPtr<Cairo::Context> & cairo_context , cell_t x , cell_t y , std::uint32_t mask );
+
+        Pango::FontDescription candidate_font;
+        Pango::FontDescription solutions_font;
+        Glib::RefPtr<Pango::Layout> layout;
+        std::size_t bold_line_size;
+        std::size_t line_size;
+        std::size_t font_size;
+        std::size_t row_index_size;
+        std::size_t column_index_size;
+        std::size_t grid_size;
+        std::size_t board_size;
+
+        Themes theme;
+        int scale;
+
+        //base_layer:background,index,box;line_layer:board line( transparent ),drawn over select highlight
+        Cairo::RefPtr<Cairo::ImageSurface> base_layer;
+        Cairo::RefPtr<Cairo::ImageSurface> line_layer;
+        Themes layer_theme = Themes::LIGHT;
+        int layer_scale = 0;
+        int layer_width = 0;
+        int layer_height = 0;
+
+        Cairo::RefPtr<Cairo::ImageSurface> digit_glyphs;
+        Cairo::RefPtr<Cairo::ImageSurface> candidate_glyphs;
+        Cairo::RefPtr<Cairo::ImageSurface> candidate_atlas;
+        std::bitset<ATLAS_TILES> atlas_rendered;
+        Themes glyph_theme = Themes::LIGHT;
+        int glyph_scale = 0;
+};
+
+#endif
@@ -0,0 +1,344 @@
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+#include <pangomm/fontdescription.h>
+#include <pangomm/layout.h>
+
+#include "booklet.h"
+#include "puzzlepool.h"
+
+static const Glib::ustring CAPTION_FONT( "Ubuntu Mono 10" );
+static constexpr double PAGE_MARGIN = 36.0;
+static constexpr double CAPTION_HEIGHT = 16.0;
+
+static std::size_t resolve_worker_number( std::size_t worker_number , std::size_t job_number )
+{
+    if ( worker_number == 0 )
+        worker_number = std::max( 1U , std::thread::hardware_concurrency() );
+    return std::max<std::size_t>( 1 , std::min( worker_number , job_number ) );
+}
+
+static bool is_cancelled( const std::atomic<bool> * cancel )
+{
+    return ( cancel != nullptr ) && cancel->load( std::memory_order_relaxed );
+}
+
+std::string booklet_page_path( const std::string& path , std::size_t page ) noexcept( true )
+{
+    std::string stem( path );
+    std::size_t dot = stem.find_last_of( '.' );
+    std::size_t slash = stem.find_last_of( '/' );
+    if ( ( dot != std::string::npos ) && ( ( slash == std::string::npos ) || ( dot > slash ) ) )
+        stem.erase( dot );
+    char suffix[32];
+    std::snprintf( suffix , sizeof( suffix ) , "-%04zu.png" , page );
+    return stem + suffix;
+}
+
+std::vector<BookletEntry> collect_booklet_puzzles( BookletSource source , SUDOKU_LEVEL level , std::size_t count ,
+                                                   bool need_solution , std::size_t worker_number ,
+                                                   const std::atomic<bool> * cancel ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    if ( level >= SUDOKU_LEVEL::_LEVEL_COUNT )
+    {
+        except_message += ":unknown puzzle level";
+        throw std::out_of_range( except_message );
+    }
+
+    std::vector<BookletEntry> entries( count );
+    std::atomic<std::size_t> next_index( 0 );
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    //a generation or solve in flight stop at the next search node on cancel
+    SolveLimits limits;
+    limits.stop = cancel;
+    auto collect = [ & ]()
+    {
+        while ( is_cancelled( cancel ) == false )
+        {
+            std::size_t index = next_index++;
+            if ( index >= count )
+                break;
+            try
+            {
+                BookletEntry& entry = entries[index];
+                if ( source == BookletSource::GENERATOR )
+                {
+                    SolveStatus status;
+                    entry.puzzle = Sudoku( limits , status ).get_puzzle();
+                    if ( status != SolveStatus::COMPLETE )
+                        break;
+                }
+                else
+                {
+                    entry.puzzle = get_local_puzzle( level );
+                    if ( entry.puzzle == puzzle_t() )
+                        throw std::runtime_error( except_message + ":local puzzle corpus of " + level_to_string( level ) + " is empty" );
+                }
+                entry.solution = puzzle_t();
+                if ( need_solution )
+                {
+                    std::vector<puzzle_t> solutions;
+                    SolveStatus status = Sudoku( entry.puzzle , level ).get_solution( solutions , 1 , limits );
+                    if ( status != SolveStatus::COMPLETE )
+                        break;
+                    if ( solutions.empty() )
+                        throw std::invalid_argument( except_message + ":puzzle not exist solution" );
+                    entry.solution = solutions[0];
+                }
+            }
+            catch( ... )
+            {
+                std::lock_guard<std::mutex> lock( error_mutex );
+                if ( error == nullptr )
+                    error = std::current_exception();
+                //stop other workers
+                next_index = count;
+                break;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    std::size_t thread_number = resolve_worker_number( worker_number , count );
+    for ( std::size_t i = 1 ; i < thread_number ; i++ )
+    {
+        workers.emplace_back( collect );
+    }
+    collect();
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+    if ( error )
+        std::rethrow_exception( error );
+    if ( is_cancelled( cancel ) )
+        entries.clear();
+    return entries;
+}
+
+//page index >= puzzle page number are answer pages
+static void render_page( BoardRenderer& renderer , const Glib::RefPtr<Pango::Layout>& caption ,
+                         const Cairo::RefPtr<Cairo::Context>& cairo_context ,
+                         const std::vector<BookletEntry>& entries , const BookletOptions& options ,
+                         std::size_t page , std::size_t puzzle_pages )
+{
+    std::size_t per_page = options.columns*options.rows;
+    bool answer_page = ( page >= puzzle_pages );
+    std::size_t first = ( answer_page ? page - puzzle_pages : page )*per_page;
+    std::size_t last = std::min( first + per_page , entries.size() );
+
+    cairo_context->save();
+    set_rgba( cairo_context , get_palette( options.theme ).background );
+    cairo_context->paint();
+    cairo_context->restore();
+
+    double cell_width = ( options.page_width - 2*PAGE_MARGIN )/options.columns;
+    double cell_height = ( options.page_height - 2*PAGE_MARGIN )/options.rows;
+    double board_size = renderer.get_board_size();
+    double board_scale = std::min( cell_width , cell_height - CAPTION_HEIGHT )/board_size;
+    for ( std::size_t index = first ; index < last ; index++ )
+    {
+        std::size_t slot = index - first;
+        double origin_x = PAGE_MARGIN + ( slot%options.columns )*cell_width + ( cell_width - board_size*board_scale )/2;
+        double origin_y = PAGE_MARGIN + ( slot/options.columns )*cell_height + ( cell_height - CAPTION_HEIGHT - board_size*board_scale )/2;
+
+        //draw_print paint background,clip it to the board
+        cairo_context->save();
+        cairo_context->translate( origin_x , origin_y );
+        cairo_context->scale( board_scale , board_scale );
+        cairo_context->rectangle( 0 , 0 , board_size , board_size );
+        cairo_context->clip();
+        renderer.draw_print( cairo_context , answer_page ? entries[index].solution : entries[index].puzzle );
+        cairo_context->restore();
+
+        cairo_context->save();
+        set_rgba( cairo_context , get_palette( options.theme ).puzzle_number );
+        caption->set_text( "No." + std::to_string( index + 1 ) + ( answer_page ? " answer" : "" ) );
+        cairo_context->move_to( origin_x , origin_y + board_size*board_scale );
+        caption->show_in_cairo_context( cairo_context );
+        cairo_context->restore();
+    }
+}
+
+std::size_t export_booklet( const std::vector<BookletEntry>& entries , const std::string& path , const BookletOptions& options ,
+                            const std::atomic<bool> * cancel ,
+                            std::function<void( double )> on_progress ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    if ( ( options.columns == 0 ) || ( options.rows == 0 ) )
+    {
+        except_message += ":page layout need at least one column and one row";
+        throw std::invalid_argument( except_message );
+    }
+    if ( entries.empty() )
+        return 0;
+
+    std::size_t per_page = options.columns*options.rows;
+    std::size_t puzzle_pages = ( entries.size() + per_page - 1 )/per_page;
+    std::size_t page_number = options.answer_pages ? 2*puzzle_pages : puzzle_pages;
+    std::size_t worker_number = resolve_worker_number( options.worker_number , page_number );
+    //rendered but unwritten pages bound
+    std::size_t window = 2*worker_number;
+
+    std::mutex page_mutex;
+    std::condition_variable page_condition;
+    std::map< std::size_t , Cairo::RefPtr<Cairo::Surface> > ready_pages;
+    std::size_t next_page = 0;
+    std::size_t written_pages = 0;
+    bool abort = false;
+    std::exception_ptr error;
+
+    auto render_loop = [ & ]()
+    {
+        //pango/cairo objects are not shared between threads
+        BoardRenderer renderer;
+        renderer.set_theme( options.theme );
+        Glib::RefPtr<Pango::Layout> caption;
+        while ( true )
+        {
+            std::size_t page = 0;
+            {
+                std::unique_lock<std::mutex> lock( page_mutex );
+                page_condition.wait( lock , [ & ]()
+                {
+                    return abort || ( next_page >= page_number ) || ( next_page < written_pages + window );
+                } );
+                if ( abort || ( next_page >= page_number ) )
+                    break;
+                page = next_page++;
+            }
+
+            Cairo::RefPtr<Cairo::Surface> surface;
+            try
+            {
+                Cairo::RefPtr<Cairo::Context> cairo_context;
+                Cairo::RefPtr<Cairo::ImageSurface> image;
+                if ( options.format == BookletFormat::PDF )
+                {
+                    //vector commands,replayed into the pdf by the writer
+                    Cairo::Rectangle extents = { 0 , 0 , options.page_width , options.page_height };
+                    surface = Cairo::RecordingSurface::create( extents );
+                    cairo_context = Cairo::Context::create( surface );
+                }
+                else
+                {
+                    image = Cairo::ImageSurface::create( Cairo::FORMAT_ARGB32 ,
+                                                         static_cast<int>( options.page_width*options.png_scale ) ,
+                                                         static_cast<int>( options.page_height*options.png_scale ) );
+                    cairo_context = Cairo::Context::create( image );
+                    cairo_context->scale( options.png_scale , options.png_scale );
+                }
+                if ( !caption )
+                {
+                    caption = Pango::Layout::create( cairo_context );
+                    caption->set_font_description( Pango::FontDescription( CAPTION_FONT ) );
+                }
+                render_page( renderer , caption , cairo_context , entries , options , page , puzzle_pages );
+                if ( image )
+                {
+                    //png compression is the slow part,keep it in parallel
+                    image->write_to_png( booklet_page_path( path , page + 1 ) );
+                    surface = image;
+                }
+            }
+            catch( ... )
+            {
+                std::lock_guard<std::mutex> lock( page_mutex );
+                if ( error == nullptr )
+                    error = std::current_exception();
+                abort = true;
+                page_condition.notify_all();
+                break;
+            }
+
+            std::lock_guard<std::mutex> lock( page_mutex );
+            ready_pages[page] = surface;
+            page_condition.notify_all();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for ( std::size_t i = 0 ; i < worker_number ; i++ )
+    {
+        workers.emplace_back( render_loop );
+    }
+
+    //writer:page order
+    try
+    {
+        Cairo::RefPtr<Cairo::PdfSurface> pdf;
+        Cairo::RefPtr<Cairo::Context> pdf_context;
+        if ( options.format == BookletFormat::PDF )
+        {
+            pdf = Cairo::PdfSurface::create( path , options.page_width , options.page_height );
+            pdf_context = Cairo::Context::create( pdf );
+        }
+        while ( written_pages < page_number )
+        {
+            Cairo::RefPtr<Cairo::Surface> surface;
+            {
+                std::unique_lock<std::mutex> lock( page_mutex );
+                page_condition.wait( lock , [ & ]()
+                {
+                    return abort || ( ready_pages.count( written_pages ) != 0 );
+                } );
+                if ( abort )
+                    break;
+                surface = ready_pages[written_pages];
+                ready_pages.erase( written_pages );
+            }
+            if ( pdf_context )
+            {
+                pdf_context->set_source( surface , 0 , 0 );
+                pdf_context->paint();
+                pdf_context->show_page();
+            }
+            surface.reset();
+
+            {
+                std::lock_guard<std::mutex> lock( page_mutex );
+                written_pages++;
+                if ( is_cancelled( cancel ) )
+                    abort = true;
+                page_condition.notify_all();
+            }
+            if ( on_progress )
+                on_progress( static_cast<double>( written_pages )/page_number );
+        }
+        if ( pdf )
+            pdf->finish();
+    }
+    catch( ... )
+    {
+        std::lock_guard<std::mutex> lock( page_mutex );
+        if ( error == nullptr )
+            error = std::current_exception();
+        abort = true;
+        page_condition.notify_all();
+    }
+
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+    if ( error )
+        std::rethrow_exception( error );
+    return written_pages;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef BOOKLET_H
+#define BOOKLET_H
+
+#include <cstdint>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "boardrenderer.h"
+#include "sudoku.h"
+
+enum class BookletFormat:std::uint32_t
+{
+    //one multi-page file
+    PDF = 0,
+    //one file every page:$(stem)-0001.png ...
+    PNG
+};
+
+enum class BookletSource:std::uint32_t
+{
+    //local puzzle corpus of the level
+    CORPUS = 0,
+    //Sudoku() generator,ignore level
+    GENERATOR
+};
+
+struct BookletOptions
+{
+    BookletFormat format = BookletFormat::PDF;
+    //puzzles per page:columns*rows
+    std::size_t columns = 2;
+    std::size_t rows = 3;
+    //append solution pages after puzzle pages,same layout
+    bool answer_pages = false;
+    //point,default A4
+    double page_width = 595.0;
+    double page_height = 842.0;
+    //png pixel per point
+    double png_scale = 2.0;
+    //0:hardware concurrency
+    std::size_t worker_number = 0;
+    Themes theme = Themes::LIGHT;
+};
+
+struct BookletEntry
+{
+    puzzle_t puzzle;
+    //all zero when not solved
+    puzzle_t solution;
+};
+
+//fetch/generate count puzzles in parallel,solve them when need_solution
+std::vector<BookletEntry> collect_booklet_puzzles( BookletSource source , SUDOKU_LEVEL level , std::size_t count ,
+                                                   bool need_solution , std::size_t worker_number = 0 ,
+                                                   const std::atomic<bool> * cancel = nullptr ) noexcept( false );
+
+//pages rendered in parallel by worker threads( one BoardRenderer each ),written in page order by the caller thread,
+//at most 2*worker pages wait in memory.on_progress( written/total ) run in the caller thread.
+//cancel stop after current pages,return written page number
+std::size_t export_booklet( const std::vector<BookletEntry>& entries , const std::string& path , const BookletOptions& options ,
+                            const std::atomic<bool> * cancel = nullptr ,
+                            std::function<void( double )> on_progress = nullptr ) noexcept( false );
+
+//"booklet.png" page 3 -> "booklet-0003.png"
+std::string booklet_page_path( const std::string& path , std::size_t page ) noexcept( true );
+
+#endif
@@ -2,6 +2,23 @@
 
 #include <stdexcept>
 
+//deadline read the clock,only every this many node
+static constexpr std::uint64_t DEADLINE_CHECK_NODES = 1024;
+
+const char * solve_status_to_string( SolveStatus status ) noexcept( true )
+{
+    switch ( status )
+    {
+        case SolveStatus::COMPLETE:
+            return "complete";
+        case SolveStatus::CANCELLED:
+            return "cancelled";
+        case SolveStatus::BUDGET_EXCEEDED:
+            return "budget exceeded";
+    }
+    return "unknown";
+}
+
 DancingLinksCell::DancingLinksCell()
 {
     this->left_ptr = this->right_ptr = this->up_ptr = this->down_ptr = nullptr;
@@ -87,6 +104,11 @@ DancingLinks::DancingLinks()
     this->dummy_column->set_essential( false );
     this->columns = nullptr;
     this->cells = nullptr;
+    this->limits = nullptr;
+    this->solution_limit = 0;
+    this->found = 0;
+    this->node_count = 0;
+    this->status = SolveStatus::COMPLETE;
 }
 
 DancingLinks::~DancingLinks()
@@ -123,58 +145,63 @@ void DancingLinks::create( std::int32_t R , std::int32_t C , bool * matrix )
         this->columns[i + 1].set_left_ptr( &this->columns[i] );
     }
 
-    for ( std::int32_t i = 0 ; i < C ; i++ )
+    //only 1-elements get a cell,the matrix is mostly 0
+    std::size_t cell_number = 0;
+    for ( std::int64_t k = 0 ; k < static_cast<std::int64_t>( R )*C ; k++ )
     {
-        this->columns[i].set_size( R );
-        this->columns[i].set_essential( i < C );
+        if ( matrix[k] )
+            cell_number++;
     }
+    this->cells = new DancingLinksCell[cell_number > 0 ? cell_number : 1];
 
-    ////overdose alloc,fast.
-    this->cells = new DancingLinksCell[R * C];
+    //last cell of every column,link downward while scanning rows
+    std::vector<DancingLinksCell *> column_tails( C );
+    for ( std::int32_t j = 0 ; j < C ; j++ )
+    {
+        this->columns[j].set_size( 0 );
+        this->columns[j].set_essential( true );
+        column_tails[j] = this->columns[j].get_dummy_cell();
+    }
 
-    for ( std::int32_t i = 0, k = 0 ; i < R ; i++ )
+    std::size_t k = 0;
+    for ( std::int32_t i = 0 ; i < R ; i++ )
     {
-        for ( std::int32_t j = 0 ; j < C ; j++, k++ )
+        DancingLinksCell * row_first = nullptr;
+        DancingLinksCell * row_last = nullptr;
+        const bool * row = matrix + static_cast<std::int64_t>( i )*C;
+        for ( std::int32_t j = 0 ; j < C ; j++ )
         {
-            this->cells[k].set_row_id( i );
-            this->cells[k].set_column_ptr( &this->columns[j] );
-
-            if ( k%C == 0 )
-                this->cells[k].set_left_ptr( &this->cells[k + C-1] );
-            else
-                this->cells[k].set_left_ptr( &this->cells[k-1] );
-
-            if ( k%C == C-1 )
-                this->cells[k].set_right_ptr( &this->cells[k-C+1] );
-            else
-                this->cells[k].set_right_ptr( &this->cells[k+1] );
-
-            if ( k < C )
-            {
-                this->cells[k].set_up_ptr( this->columns[j].get_dummy_cell() );
-                this->columns[j].get_dummy_cell()->set_down_ptr( &this->cells[k] );
-            }
+            if ( row[j] == false )
+                continue;
+            DancingLinksCell * cell = &this->cells[k++];
+            cell->set_row_id( i );
+            cell->set_column_ptr( &this->columns[j] );
+            this->columns[j].increment_size();
+
+            cell->set_up_ptr( column_tails[j] );
+            column_tails[j]->set_down_ptr( cell );
+            column_tails[j] = cell;
+
+            if ( row_first == nullptr )
+                row_first = cell;
             else
-                this->cells[k].set_up_ptr( &this->cells[k - C] );
-
-            if ( k >= ( (R-1)*C ) )
             {
-                this->cells[k].set_down_ptr( this->columns[j].get_dummy_cell() );
-                this->columns[j].get_dummy_cell()->set_up_ptr( &this->cells[k] );
+                cell->set_left_ptr( row_last );
+                row_last->set_right_ptr( cell );
             }
-            else
-                this->cells[k].set_down_ptr( &this->cells[k + C] );
+            row_last = cell;
         }
-    }
-
-    for ( std::int32_t i = 0 , k = 0 ; i < R ; i++ )
-    {
-        for ( std::int32_t j = 0 ; j < C ; j++ , k++ )
+        if ( row_first != nullptr )
         {
-            if ( matrix[k] == false )
-                this->cells[k].erase();
+            row_first->set_left_ptr( row_last );
+            row_last->set_right_ptr( row_first );
         }
     }
+    for ( std::int32_t j = 0 ; j < C ; j++ )
+    {
+        column_tails[j]->set_down_ptr( this->columns[j].get_dummy_cell() );
+        this->columns[j].get_dummy_cell()->set_up_ptr( column_tails[j] );
+    }
 }
 
 void DancingLinks::destroy( void )
@@ -193,14 +220,59 @@ void DancingLinks::destroy( void )
     this->dummy_column->set_right_ptr( nullptr );
 }
 
+SolveStatus DancingLinks::solve( std::vector<std::vector<std::int32_t>>& all_solutions , std::size_t solution_limit , const SolveLimits& limits )
+{
+    std::vector<std::int32_t> current_solution;
+    this->limits = &limits;
+    this->solution_limit = solution_limit;
+    this->found = 0;
+    this->node_count = 0;
+    this->status = SolveStatus::COMPLETE;
+    this->search( all_solutions , current_solution );
+    this->limits = nullptr;
+    return this->status;
+}
+
+std::uint64_t DancingLinks::get_node_count( void ) const noexcept( true )
+{
+    return this->node_count;
+}
+
+bool DancingLinks::check_limits( void ) noexcept( true )
+{
+    this->node_count++;
+    if ( ( this->limits->node_budget != 0 ) && ( this->node_count > this->limits->node_budget ) )
+    {
+        this->status = SolveStatus::BUDGET_EXCEEDED;
+        return true;
+    }
+    if ( ( this->limits->stop != nullptr ) && this->limits->stop->load( std::memory_order_relaxed ) )
+    {
+        this->status = SolveStatus::CANCELLED;
+        return true;
+    }
+    if ( ( this->node_count%DEADLINE_CHECK_NODES == 0 ) &&
+         ( this->limits->deadline != std::chrono::steady_clock::time_point::max() ) &&
+         ( std::chrono::steady_clock::now() >= this->limits->deadline ) )
+    {
+        this->status = SolveStatus::BUDGET_EXCEEDED;
+        return true;
+    }
+    return false;
+}
+
 //https://en.wikipedia.org/wiki/Knuth%27s_Algorithm_X
-bool DancingLinks::solve( std::vector<std::vector<int32_t>>& all_solutions , std::vector<int32_t>& current_solution , bool need_all )
+bool DancingLinks::search( std::vector<std::vector<std::int32_t>>& all_solutions , std::vector<std::int32_t>& current_solution )
 {
+    if ( this->check_limits() )
+        return true;
+
     if ( this->dummy_column->get_right_ptr()->get_essential() == false )
     {
         // No more constraints left to be satisfied. Success
         all_solutions.push_back( current_solution );
-        return true;
+        this->found++;
+        return ( this->solution_limit != 0 ) && ( this->found >= this->solution_limit );
     }
 
     // Find the essential column with the lowest degree
@@ -218,7 +290,7 @@ bool DancingLinks::solve( std::vector<std::vector<int32_t>>& all_solutions , std
     //no way to satisfy some constraint. failure
     if ( min_count == 0 )
         return false;
-    bool flag = false;
+    bool stop = false;
 
     //remove the chosen column
     chosen_column->remove_column();
@@ -234,24 +306,20 @@ bool DancingLinks::solve( std::vector<std::vector<int32_t>>& all_solutions , std
         }
 
         //recurse to solve the modified board
-        if ( this->solve( all_solutions , current_solution , need_all ) )
-            flag = true;
+        stop = this->search( all_solutions , current_solution );
 
-        //unremove all those columns
-        for ( DancingLinksCell * ptr2 = ptr->get_right_ptr() ; ptr2 != ptr ; ptr2 = ptr2->get_right_ptr() )
+        //unremove all those columns,also on the way out of an aborted search
+        for ( DancingLinksCell * ptr2 = ptr->get_left_ptr() ; ptr2 != ptr ; ptr2 = ptr2->get_left_ptr() )
         {
             ptr2->get_column_ptr()->unremove_column();
         }
         current_solution.pop_back();
 
-        //if only one solution needs to be found and we have found one, don't bother checking for the rest
-        if ( ( flag == true ) && ( need_all == false ) )
-        {
-            chosen_column->unremove_column();
-            return flag;
-        }
+        //solution limit reached or search aborted,don't bother checking for the rest
+        if ( stop )
+            break;
     }
     //unremove the chosen column
     chosen_column->unremove_column();
-    return flag;
+    return stop;
 }
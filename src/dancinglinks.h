@@ -3,11 +3,45 @@
 #define DANCINGLINKS_H
 
 #include <cstdint>
+
+#include <atomic>
+#include <chrono>
 #include <vector>
 
 class DancingLinksCell;
 class DancingLinksColumn;
 
+enum class SolveStatus:std::uint32_t
+{
+    //search space exhausted or solution limit reached
+    COMPLETE = 0,
+    //stop token set,solutions found so far kept
+    CANCELLED,
+    //node budget or deadline reached,solutions found so far kept
+    BUDGET_EXCEEDED
+};
+
+//limits of one search,default:no limit
+struct SolveLimits
+{
+    //checked every search node,nullptr never stop
+    const std::atomic<bool> * stop = nullptr;
+    //checked every DEADLINE_CHECK_NODES search node
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    //search node number,0 unlimited
+    std::uint64_t node_budget = 0;
+
+    static SolveLimits with_timeout( std::chrono::steady_clock::duration timeout , const std::atomic<bool> * stop = nullptr ) noexcept( true )
+    {
+        SolveLimits limits;
+        limits.stop = stop;
+        limits.deadline = std::chrono::steady_clock::now() + timeout;
+        return limits;
+    }
+};
+
+const char * solve_status_to_string( SolveStatus status ) noexcept( true );
+
 // 1-elements in the adjacency list
 class DancingLinksCell
 {
@@ -167,11 +201,27 @@ class DancingLinks
 
         void destroy( void );
 
-        bool solve( std::vector<std::vector<std::int32_t>> &allsolutions , std::vector<int32_t>& current_solution , bool need_all = false );
+        //append row id sets to all_solutions,stop after solution_limit new solutions( 0 all ).
+        //an aborted search unwind the matrix,the object can solve again
+        SolveStatus solve( std::vector<std::vector<std::int32_t>>& all_solutions , std::size_t solution_limit = 1 , const SolveLimits& limits = SolveLimits() );
+        //search node number of the last solve
+        std::uint64_t get_node_count( void ) const noexcept( true );
     private:
+        //true:stop the whole search
+        bool search( std::vector<std::vector<std::int32_t>>& all_solutions , std::vector<std::int32_t>& current_solution );
+        //count a node,set status when a limit is hit
+        bool check_limits( void ) noexcept( true );
+
         DancingLinksColumn * dummy_column;
         DancingLinksColumn * columns;
         DancingLinksCell * cells;
+
+        //state of the running solve
+        const SolveLimits * limits;
+        std::size_t solution_limit;
+        std::size_t found;
+        std::uint64_t node_count;
+        SolveStatus status;
 };
 
 #endif
\ No newline at end of file
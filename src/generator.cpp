@@ -0,0 +1,434 @@
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dancinglinks.h"
+#include "generator.h"
+#include "metrics.h"
+#include "puzzleimport.h"
+#include "sudoku.h"
+#include "trace.h"
+#include "variant.h"
+
+static constexpr std::size_t CELL_NUMBER = SUDOKU_SIZE*SUDOKU_SIZE;
+
+//carve stop at this clue number,the rate stage fine tune from there
+static constexpr std::array< std::size_t , static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) > CLUE_FLOORS = { 36 , 28 , 0 , 0 };
+
+//blocking queue between two stages,close wake every waiter
+template<typename T>
+class StageQueue
+{
+    public:
+        explicit StageQueue( std::size_t capacity ) : capacity( capacity ) , closed( false ) {}
+
+        //false:queue closed,item dropped
+        bool push( T item )
+        {
+            std::unique_lock<std::mutex> lock( this->mutex );
+            this->not_full.wait( lock , [ this ](){ return this->closed || ( this->items.size() < this->capacity ); } );
+            if ( this->closed )
+                return false;
+            this->items.push_back( std::move( item ) );
+            this->not_empty.notify_one();
+            return true;
+        }
+
+        //false:queue closed
+        bool pop( T& item )
+        {
+            std::unique_lock<std::mutex> lock( this->mutex );
+            this->not_empty.wait( lock , [ this ](){ return this->closed || ( this->items.empty() == false ); } );
+            if ( this->closed )
+                return false;
+            item = std::move( this->items.front() );
+            this->items.pop_front();
+            this->not_full.notify_one();
+            return true;
+        }
+
+        //false:queue full or closed,item kept by the caller
+        bool try_push( const T& item )
+        {
+            std::lock_guard<std::mutex> lock( this->mutex );
+            if ( this->closed || ( this->items.size() >= this->capacity ) )
+                return false;
+            this->items.push_back( item );
+            this->not_empty.notify_one();
+            return true;
+        }
+
+        //false:queue empty or closed
+        bool try_pop( T& item )
+        {
+            std::lock_guard<std::mutex> lock( this->mutex );
+            if ( this->closed || this->items.empty() )
+                return false;
+            item = std::move( this->items.front() );
+            this->items.pop_front();
+            this->not_full.notify_one();
+            return true;
+        }
+
+        void close( void )
+        {
+            std::lock_guard<std::mutex> lock( this->mutex );
+            this->closed = true;
+            this->not_empty.notify_all();
+            this->not_full.notify_all();
+        }
+    private:
+        std::mutex mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+        std::deque<T> items;
+        std::size_t capacity;
+        bool closed;
+};
+
+struct CarvedPuzzle
+{
+    puzzle_t puzzle;
+    puzzle_t solution;
+};
+
+//random complete grid,backtracking in reading order with shuffled digits
+static puzzle_t random_grid( std::mt19937& rand_gen )
+{
+    std::array<cell_t , CELL_NUMBER> values = { 0 };
+    std::array< std::array<cell_t , SUDOKU_SIZE> , CELL_NUMBER > orders;
+    std::array<std::size_t , CELL_NUMBER> tried = { 0 };
+    std::array<std::uint16_t , SUDOKU_SIZE> rows = { 0 } , columns = { 0 } , boxes = { 0 };
+    for ( auto& order : orders )
+    {
+        for ( std::size_t k = 0 ; k < SUDOKU_SIZE ; k++ )
+        {
+            order[k] = k + 1;
+        }
+        std::shuffle( order.begin() , order.end() , rand_gen );
+    }
+    std::size_t cell = 0;
+    while ( cell < CELL_NUMBER )
+    {
+        std::size_t x = cell/SUDOKU_SIZE , y = cell%SUDOKU_SIZE;
+        std::size_t box = ( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + y/SUDOKU_BOX_SIZE;
+        if ( values[cell] != 0 )
+        {
+            std::uint16_t bit = ~( 1U << ( values[cell] - 1 ) );
+            rows[x] &= bit;
+            columns[y] &= bit;
+            boxes[box] &= bit;
+            values[cell] = 0;
+        }
+        bool placed = false;
+        while ( tried[cell] < SUDOKU_SIZE )
+        {
+            cell_t digit = orders[cell][tried[cell]++];
+            std::uint16_t bit = 1U << ( digit - 1 );
+            if ( ( ( rows[x] | columns[y] | boxes[box] ) & bit ) == 0 )
+            {
+                values[cell] = digit;
+                rows[x] |= bit;
+                columns[y] |= bit;
+                boxes[box] |= bit;
+                placed = true;
+                break;
+            }
+        }
+        if ( placed )
+        {
+            cell++;
+            continue;
+        }
+        //dead end,retry the previous cell with its next digit
+        tried[cell] = 0;
+        cell--;
+    }
+    puzzle_t grid;
+    for ( std::size_t index = 0 ; index < CELL_NUMBER ; index++ )
+    {
+        grid[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = values[index];
+    }
+    return grid;
+}
+
+static std::size_t count_clues( const puzzle_t& puzzle )
+{
+    std::size_t clues = 0;
+    for ( const auto& row : puzzle )
+    {
+        clues += std::count_if( row.begin() , row.end() , []( cell_t value ){ return value != 0; } );
+    }
+    return clues;
+}
+
+static bool is_unique( const VariantModel& model , const puzzle_t& puzzle )
+{
+    std::vector<puzzle_t> solutions;
+    model.solve( puzzle , solutions , 2 );
+    return solutions.size() == 1;
+}
+
+//remove one clue in random order keeping the puzzle unique,false:every clue is needed
+static bool carve_one( const VariantModel& model , puzzle_t& puzzle , std::mt19937& rand_gen )
+{
+    std::array<std::size_t , CELL_NUMBER> cells;
+    for ( std::size_t index = 0 ; index < CELL_NUMBER ; index++ )
+    {
+        cells[index] = index;
+    }
+    std::shuffle( cells.begin() , cells.end() , rand_gen );
+    for ( std::size_t index : cells )
+    {
+        cell_t& value = puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE];
+        if ( value == 0 )
+            continue;
+        cell_t old_value = value;
+        value = 0;
+        if ( is_unique( model , puzzle ) )
+            return true;
+        value = old_value;
+    }
+    return false;
+}
+
+//give back one solution digit in random order
+static void restore_one( puzzle_t& puzzle , const puzzle_t& solution , std::mt19937& rand_gen )
+{
+    std::vector<std::size_t> empty_cells;
+    for ( std::size_t index = 0 ; index < CELL_NUMBER ; index++ )
+    {
+        if ( puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE] == 0 )
+            empty_cells.push_back( index );
+    }
+    if ( empty_cells.empty() )
+        return ;
+    std::uniform_int_distribution<std::size_t> index_dist( 0 , empty_cells.size() - 1 );
+    std::size_t index = empty_cells[index_dist( rand_gen )];
+    puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = solution[index/SUDOKU_SIZE][index%SUDOKU_SIZE];
+}
+
+static bool is_stopped( const SolveLimits& limits )
+{
+    if ( ( limits.stop != nullptr ) && limits.stop->load( std::memory_order_relaxed ) )
+        return true;
+    return ( limits.deadline != std::chrono::steady_clock::time_point::max() ) &&
+           ( std::chrono::steady_clock::now() >= limits.deadline );
+}
+
+std::vector<GeneratedPuzzle> generate_puzzles( const GeneratorOptions& options , GeneratorStats * stats ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    if ( options.level >= SUDOKU_LEVEL::_LEVEL_COUNT )
+    {
+        except_message += ":unknown puzzle level";
+        throw std::out_of_range( except_message );
+    }
+    static MetricHistogram& generate_us = metrics().histogram( "generator.generate_us" );
+    MetricTimer timer( generate_us );
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<GeneratedPuzzle> results;
+    if ( options.count == 0 )
+    {
+        if ( stats != nullptr )
+            *stats = GeneratorStats();
+        return results;
+    }
+
+    const VariantModel model( classic_spec() );
+    const std::size_t target = static_cast<std::size_t>( options.level );
+    const std::size_t clue_floor = CLUE_FLOORS[target];
+    StageQueue<puzzle_t> grid_queue( GENERATOR_QUEUE_CAPACITY );
+    StageQueue<CarvedPuzzle> carved_queue( GENERATOR_QUEUE_CAPACITY );
+    std::mutex result_mutex;
+    std::exception_ptr error;
+    std::atomic<bool> finished( false );
+
+    std::atomic<std::uint64_t> grids( 0 ) , carved( 0 ) , mutations( 0 ) , dropped( 0 );
+    std::array< std::atomic<std::uint64_t> , static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) > graded;
+    for ( auto& count : graded )
+    {
+        count = 0;
+    }
+
+    auto finish = [ & ]()
+    {
+        finished = true;
+        grid_queue.close();
+        carved_queue.close();
+    };
+    //stage body,the first exception end the pipeline
+    auto run_stage = [ & ]( const char * name , auto body )
+    {
+        return [ & , name , body ]()
+        {
+            SUDOKU_TRACE_THREAD( name );
+            try
+            {
+                std::random_device rand_div;
+                std::mt19937 rand_gen( rand_div() );
+                body( rand_gen );
+            }
+            catch( ... )
+            {
+                {
+                    std::lock_guard<std::mutex> lock( result_mutex );
+                    if ( error == nullptr )
+                        error = std::current_exception();
+                }
+                finish();
+            }
+        };
+    };
+
+    auto grid_stage = run_stage( "generator grid" , [ & ]( std::mt19937& rand_gen )
+    {
+        while ( ( finished == false ) && ( is_stopped( options.limits ) == false ) )
+        {
+            SUDOKU_TRACE_SCOPE( "generator:grid" );
+            if ( grid_queue.push( random_grid( rand_gen ) ) == false )
+                break;
+            grids++;
+        }
+    } );
+    //false:the pipeline is finished
+    auto rate = [ & ]( CarvedPuzzle& carved_puzzle , std::mt19937& rand_gen )
+    {
+        if ( is_stopped( options.limits ) )
+        {
+            finish();
+            return false;
+        }
+        SUDOKU_TRACE_SCOPE( "generator:rate" );
+        puzzle_t& puzzle = carved_puzzle.puzzle;
+        bool accepted = false;
+        for ( std::size_t mutation = 0 ; mutation <= GENERATOR_MAX_MUTATIONS ; mutation++ )
+        {
+            std::size_t level = static_cast<std::size_t>( grade_puzzle( puzzle ) );
+            graded[level]++;
+            if ( level == target )
+            {
+                accepted = true;
+                break;
+            }
+            if ( mutation == GENERATOR_MAX_MUTATIONS )
+                break;
+            mutations++;
+            if ( level > target )
+                restore_one( puzzle , carved_puzzle.solution , rand_gen );
+            else if ( carve_one( model , puzzle , rand_gen ) == false )
+                break;
+        }
+        if ( accepted == false )
+        {
+            dropped++;
+            return true;
+        }
+        std::lock_guard<std::mutex> lock( result_mutex );
+        if ( results.size() < options.count )
+            results.push_back( { puzzle , carved_puzzle.solution , options.level , count_clues( puzzle ) } );
+        if ( results.size() >= options.count )
+        {
+            finish();
+            return false;
+        }
+        return true;
+    };
+    //carve and rate share the workers:the mutations of the hard bands cost more than the first carve,
+    //so a worker rate a waiting puzzle before carving a new grid
+    auto carve_rate_stage = run_stage( "generator carve/rate" , [ & ]( std::mt19937& rand_gen )
+    {
+        puzzle_t grid;
+        CarvedPuzzle carved_puzzle;
+        while ( finished == false )
+        {
+            if ( carved_queue.try_pop( carved_puzzle ) == false )
+            {
+                if ( grid_queue.pop( grid ) == false )
+                    break;
+                {
+                    SUDOKU_TRACE_SCOPE( "generator:carve" );
+                    carved_puzzle = { grid , grid };
+                    std::size_t clues = CELL_NUMBER;
+                    while ( ( clues > clue_floor ) && ( finished == false ) && carve_one( model , carved_puzzle.puzzle , rand_gen ) )
+                    {
+                        clues--;
+                    }
+                }
+                carved++;
+                //queue full:rate it here
+                if ( carved_queue.try_push( carved_puzzle ) )
+                    continue;
+            }
+            if ( rate( carved_puzzle , rand_gen ) == false )
+                break;
+        }
+    } );
+
+    //a grid take microseconds,every other thread carve and rate
+    std::size_t worker_number = options.worker_number;
+    if ( worker_number == 0 )
+        worker_number = std::max( 1U , std::thread::hardware_concurrency() );
+    std::size_t carve_rate_number = std::max<std::size_t>( 1 , worker_number - 1 );
+    std::vector<std::thread> workers;
+    try
+    {
+        workers.emplace_back( grid_stage );
+        for ( std::size_t i = 0 ; i < carve_rate_number ; i++ )
+        {
+            workers.emplace_back( carve_rate_stage );
+        }
+    }
+    catch( ... )
+    {
+        finish();
+        for ( auto& worker : workers )
+        {
+            worker.join();
+        }
+        throw;
+    }
+    //limits watch,stages may block on a queue
+    while ( finished == false )
+    {
+        if ( is_stopped( options.limits ) )
+        {
+            finish();
+            break;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+    if ( error )
+        std::rethrow_exception( error );
+
+    if ( stats != nullptr )
+    {
+        stats->grids = grids;
+        stats->carved = carved;
+        for ( std::size_t level = 0 ; level < graded.size() ; level++ )
+        {
+            stats->graded[level] = graded[level];
+        }
+        stats->mutations = mutations;
+        stats->dropped = dropped;
+        stats->accepted = results.size();
+        stats->seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+    }
+    return results;
+}
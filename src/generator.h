@@ -0,0 +1,68 @@
+#pragma once
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstdint>
+
+#include <array>
+#include <vector>
+
+#include "dancinglinks.h"
+#include "sudoku.h"
+
+//rate stage mutation number before a puzzle is dropped
+constexpr std::size_t GENERATOR_MAX_MUTATIONS = 24;
+//capacity of every queue between two stages
+constexpr std::size_t GENERATOR_QUEUE_CAPACITY = 64;
+
+struct GeneratedPuzzle
+{
+    puzzle_t puzzle;
+    puzzle_t solution;
+    //grade_puzzle result,equal the target level
+    SUDOKU_LEVEL level;
+    std::size_t clues;
+};
+
+struct GeneratorOptions
+{
+    SUDOKU_LEVEL level = SUDOKU_LEVEL::MEDIUM;
+    std::size_t count = 1;
+    //0 hardware concurrency,at least one thread every stage
+    std::size_t worker_number = 0;
+    //stop flag and deadline end the pipeline,node budget unused
+    SolveLimits limits;
+};
+
+struct GeneratorStats
+{
+    //full grids made by the grid stage
+    std::uint64_t grids = 0;
+    //unique puzzles out of the carve stage
+    std::uint64_t carved = 0;
+    //grade_puzzle result of every rating,mutated puzzles rated again
+    std::array< std::uint64_t , static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) > graded = { 0 };
+    std::uint64_t mutations = 0;
+    //out of mutations before reaching the target
+    std::uint64_t dropped = 0;
+    std::uint64_t accepted = 0;
+    double seconds = 0.0;
+
+    double get_accepted_rate( void ) const noexcept( true )
+    {
+        return ( this->seconds > 0.0 ) ? this->accepted/this->seconds : 0.0;
+    }
+};
+
+#if SUDOKU_SIZE != 9
+    [[deprecated("not implemented")]]
+#endif
+//count unique puzzles graded at options.level.stages run as a pipeline:
+//  grid:random full grid,on its own thread
+//  carve:remove clues in random order while the puzzle stay unique,down to the clue floor of the level
+//  rate:grade_puzzle,accept on target,otherwise add a clue back( too hard ) or carve one more( too easy ) and rate again
+//every other worker run carve and rate,rating the queued carved puzzles first
+//fewer puzzles when stopped by the limits.stats filled when not nullptr
+std::vector<GeneratedPuzzle> generate_puzzles( const GeneratorOptions& options , GeneratorStats * stats = nullptr ) noexcept( false );
+
+#endif
@@ -0,0 +1,321 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <array>
+#include <string>
+
+#if defined( __x86_64__ ) && defined( __GNUC__ )
+    #define GRID_KERNEL_X86
+    #include <immintrin.h>
+#endif
+
+#include "gridkernel.h"
+
+static_assert( sizeof( puzzle_t ) == SUDOKU_SIZE*SUDOKU_SIZE , "puzzle_t must be 81 contiguous cells" );
+
+constexpr candidate_mask_t ALL_DIGITS = ( 1U << SUDOKU_SIZE ) - 1;
+constexpr std::size_t CELL_NUMBER = SUDOKU_SIZE*SUDOKU_SIZE;
+
+static std::size_t box_of( std::size_t x , std::size_t y )
+{
+    return ( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + y/SUDOKU_BOX_SIZE;
+}
+
+candidate_mask_t GridMasks::get_allowed( std::size_t x , std::size_t y ) const noexcept( true )
+{
+    return ALL_DIGITS & ~( this->rows[x] | this->columns[y] | this->boxes[box_of( x , y )] );
+}
+
+GridMasks grid_masks( const puzzle_t& puzzle ) noexcept( true )
+{
+    GridMasks masks;
+    masks.rows.fill( 0 );
+    masks.columns.fill( 0 );
+    masks.boxes.fill( 0 );
+    bool out_of_range = false;
+    candidate_mask_t repeated = 0;
+    for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
+    {
+        for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            cell_t value = puzzle[x][y];
+            if ( value == 0 )
+                continue;
+            if ( value > SUDOKU_SIZE )
+            {
+                out_of_range = true;
+                continue;
+            }
+            candidate_mask_t bit = 1U << ( value - 1 );
+            candidate_mask_t& box = masks.boxes[box_of( x , y )];
+            repeated |= ( masks.rows[x] | masks.columns[y] | box ) & bit;
+            masks.rows[x] |= bit;
+            masks.columns[y] |= bit;
+            box |= bit;
+        }
+    }
+    masks.illegal = out_of_range || ( repeated != 0 );
+    return masks;
+}
+
+bool grid_candidates( const puzzle_t& puzzle , std::array< candidate_mask_t , SUDOKU_SIZE*SUDOKU_SIZE >& masks ) noexcept( true )
+{
+    GridMasks units = grid_masks( puzzle );
+    masks.fill( 0 );
+    if ( units.illegal )
+        return false;
+    for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
+    {
+        for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            if ( puzzle[x][y] == 0 )
+                masks[x*SUDOKU_SIZE + y] = units.get_allowed( x , y );
+        }
+    }
+    return true;
+}
+
+//puzzles [ begin , end ) one at a time,also the tail of the vector kernels
+static void scan_scalar( const cell_t * cells , std::size_t count , std::size_t begin , std::size_t end ,
+                         std::uint8_t * legal , candidate_mask_t * candidates )
+{
+    puzzle_t puzzle;
+    std::array< candidate_mask_t , CELL_NUMBER > masks;
+    for ( std::size_t p = begin ; p < end ; p++ )
+    {
+        for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+        {
+            puzzle[k/SUDOKU_SIZE][k%SUDOKU_SIZE] = cells[k*count + p];
+        }
+        if ( candidates == nullptr )
+        {
+            legal[p] = grid_masks( puzzle ).illegal ? 0 : 1;
+            continue;
+        }
+        legal[p] = grid_candidates( puzzle , masks ) ? 1 : 0;
+        for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+        {
+            candidates[k*count + p] = masks[k];
+        }
+    }
+}
+
+#ifdef GRID_KERNEL_X86
+
+//unit indexes of every cell:row,column,box
+struct CellUnits
+{
+    std::array< std::array< std::uint8_t , 3 > , CELL_NUMBER > units;
+
+    CellUnits()
+    {
+        for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+        {
+            std::size_t x = k/SUDOKU_SIZE;
+            std::size_t y = k%SUDOKU_SIZE;
+            this->units[k] = { static_cast<std::uint8_t>( x ) , static_cast<std::uint8_t>( SUDOKU_SIZE + y ) ,
+                               static_cast<std::uint8_t>( 2*SUDOKU_SIZE + box_of( x , y ) ) };
+        }
+    }
+};
+
+static const CellUnits cell_units;
+
+/*
+* digit bit of a byte value by two pshufb:low byte table and high byte table,interleaved into 16 bit lanes.
+* value 10-15 give no bit and value above 15 give garbage,both are caught by the saturating value - 9 test.
+* lane order:ssse3 bits[0] puzzle 0-7,bits[1] 8-15.avx2 shuffle inside 128 bit halves,
+* bits[0] puzzle 0-7 and 16-23,bits[1] 8-15 and 24-31,packs_epi16 of the two restore 0-31
+*/
+__attribute__(( target( "ssse3" ) ))
+static void scan_block_ssse3( const cell_t * cells , std::size_t count , std::size_t p , std::uint8_t * legal , candidate_mask_t * candidates )
+{
+    const __m128i low_table = _mm_setr_epi8( 0 , 1 , 2 , 4 , 8 , 16 , 32 , 64 , -128 , 0 , 0 , 0 , 0 , 0 , 0 , 0 );
+    const __m128i high_table = _mm_setr_epi8( 0 , 0 , 0 , 0 , 0 , 0 , 0 , 0 , 0 , 1 , 0 , 0 , 0 , 0 , 0 , 0 );
+    const __m128i max_value = _mm_set1_epi8( SUDOKU_SIZE );
+    const __m128i zero = _mm_setzero_si128();
+    __m128i units[3*SUDOKU_SIZE][2];
+    for ( auto& unit : units )
+    {
+        unit[0] = unit[1] = zero;
+    }
+    __m128i repeated[2] = { zero , zero };
+    __m128i out_of_range = zero;
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+    {
+        __m128i value = _mm_loadu_si128( reinterpret_cast<const __m128i *>( cells + k*count + p ) );
+        out_of_range = _mm_or_si128( out_of_range , _mm_subs_epu8( value , max_value ) );
+        __m128i low = _mm_shuffle_epi8( low_table , value );
+        __m128i high = _mm_shuffle_epi8( high_table , value );
+        __m128i bits[2] = { _mm_unpacklo_epi8( low , high ) , _mm_unpackhi_epi8( low , high ) };
+        for ( std::size_t half = 0 ; half < 2 ; half++ )
+        {
+            for ( auto unit : cell_units.units[k] )
+            {
+                repeated[half] = _mm_or_si128( repeated[half] , _mm_and_si128( units[unit][half] , bits[half] ) );
+                units[unit][half] = _mm_or_si128( units[unit][half] , bits[half] );
+            }
+        }
+    }
+    __m128i legal_mask = _mm_and_si128( _mm_packs_epi16( _mm_cmpeq_epi16( repeated[0] , zero ) , _mm_cmpeq_epi16( repeated[1] , zero ) ) ,
+                                        _mm_cmpeq_epi8( out_of_range , zero ) );
+    _mm_storeu_si128( reinterpret_cast<__m128i *>( legal + p ) , _mm_and_si128( legal_mask , _mm_set1_epi8( 1 ) ) );
+    if ( candidates == nullptr )
+        return ;
+
+    const __m128i all_digits = _mm_set1_epi16( ALL_DIGITS );
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+    {
+        __m128i value = _mm_loadu_si128( reinterpret_cast<const __m128i *>( cells + k*count + p ) );
+        __m128i empty = _mm_and_si128( _mm_cmpeq_epi8( value , zero ) , legal_mask );
+        __m128i empty_lanes[2] = { _mm_unpacklo_epi8( empty , empty ) , _mm_unpackhi_epi8( empty , empty ) };
+        const auto& unit = cell_units.units[k];
+        for ( std::size_t half = 0 ; half < 2 ; half++ )
+        {
+            __m128i used = _mm_or_si128( _mm_or_si128( units[unit[0]][half] , units[unit[1]][half] ) , units[unit[2]][half] );
+            __m128i allowed = _mm_and_si128( _mm_andnot_si128( used , all_digits ) , empty_lanes[half] );
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( candidates + k*count + p + half*8 ) , allowed );
+        }
+    }
+}
+
+__attribute__(( target( "avx2" ) ))
+static void scan_block_avx2( const cell_t * cells , std::size_t count , std::size_t p , std::uint8_t * legal , candidate_mask_t * candidates )
+{
+    const __m256i low_table = _mm256_setr_epi8( 0 , 1 , 2 , 4 , 8 , 16 , 32 , 64 , -128 , 0 , 0 , 0 , 0 , 0 , 0 , 0 ,
+                                                0 , 1 , 2 , 4 , 8 , 16 , 32 , 64 , -128 , 0 , 0 , 0 , 0 , 0 , 0 , 0 );
+    const __m256i high_table = _mm256_setr_epi8( 0 , 0 , 0 , 0 , 0 , 0 , 0 , 0 , 0 , 1 , 0 , 0 , 0 , 0 , 0 , 0 ,
+                                                 0 , 0 , 0 , 0 , 0 , 0 , 0 , 0 , 0 , 1 , 0 , 0 , 0 , 0 , 0 , 0 );
+    const __m256i max_value = _mm256_set1_epi8( SUDOKU_SIZE );
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i units[3*SUDOKU_SIZE][2];
+    for ( auto& unit : units )
+    {
+        unit[0] = unit[1] = zero;
+    }
+    __m256i repeated[2] = { zero , zero };
+    __m256i out_of_range = zero;
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+    {
+        __m256i value = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( cells + k*count + p ) );
+        out_of_range = _mm256_or_si256( out_of_range , _mm256_subs_epu8( value , max_value ) );
+        __m256i low = _mm256_shuffle_epi8( low_table , value );
+        __m256i high = _mm256_shuffle_epi8( high_table , value );
+        __m256i bits[2] = { _mm256_unpacklo_epi8( low , high ) , _mm256_unpackhi_epi8( low , high ) };
+        for ( std::size_t half = 0 ; half < 2 ; half++ )
+        {
+            for ( auto unit : cell_units.units[k] )
+            {
+                repeated[half] = _mm256_or_si256( repeated[half] , _mm256_and_si256( units[unit][half] , bits[half] ) );
+                units[unit][half] = _mm256_or_si256( units[unit][half] , bits[half] );
+            }
+        }
+    }
+    __m256i legal_mask = _mm256_and_si256( _mm256_packs_epi16( _mm256_cmpeq_epi16( repeated[0] , zero ) , _mm256_cmpeq_epi16( repeated[1] , zero ) ) ,
+                                           _mm256_cmpeq_epi8( out_of_range , zero ) );
+    _mm256_storeu_si256( reinterpret_cast<__m256i *>( legal + p ) , _mm256_and_si256( legal_mask , _mm256_set1_epi8( 1 ) ) );
+    if ( candidates == nullptr )
+        return ;
+
+    const __m256i all_digits = _mm256_set1_epi16( ALL_DIGITS );
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+    {
+        __m256i value = _mm256_loadu_si256( reinterpret_cast<const __m256i *>( cells + k*count + p ) );
+        __m256i empty = _mm256_and_si256( _mm256_cmpeq_epi8( value , zero ) , legal_mask );
+        __m256i empty_lanes[2] = { _mm256_unpacklo_epi8( empty , empty ) , _mm256_unpackhi_epi8( empty , empty ) };
+        const auto& unit = cell_units.units[k];
+        __m256i allowed[2];
+        for ( std::size_t half = 0 ; half < 2 ; half++ )
+        {
+            __m256i used = _mm256_or_si256( _mm256_or_si256( units[unit[0]][half] , units[unit[1]][half] ) , units[unit[2]][half] );
+            allowed[half] = _mm256_and_si256( _mm256_andnot_si256( used , all_digits ) , empty_lanes[half] );
+        }
+        //back to puzzle order:0-7 8-15 from the low halves,16-23 24-31 from the high halves
+        candidate_mask_t * target = candidates + k*count + p;
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( target ) , _mm256_permute2x128_si256( allowed[0] , allowed[1] , 0x20 ) );
+        _mm256_storeu_si256( reinterpret_cast<__m256i *>( target + 16 ) , _mm256_permute2x128_si256( allowed[0] , allowed[1] , 0x31 ) );
+    }
+}
+
+#endif
+
+bool grid_kernel_supported( GridKernel kernel ) noexcept( true )
+{
+    switch ( kernel )
+    {
+        case GridKernel::SCALAR:
+            return true;
+        #ifdef GRID_KERNEL_X86
+            case GridKernel::SSSE3:
+                return __builtin_cpu_supports( "ssse3" );
+            case GridKernel::AVX2:
+                return __builtin_cpu_supports( "avx2" );
+        #endif
+        default:
+            return false;
+    }
+}
+
+const char * grid_kernel_to_string( GridKernel kernel ) noexcept( true )
+{
+    switch ( kernel )
+    {
+        case GridKernel::SCALAR:
+            return "scalar";
+        case GridKernel::SSSE3:
+            return "ssse3";
+        case GridKernel::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
+
+GridKernel grid_default_kernel( void ) noexcept( true )
+{
+    static const GridKernel kernel = []()
+    {
+        GridKernel best = GridKernel::SCALAR;
+        for ( GridKernel candidate : { GridKernel::SSSE3 , GridKernel::AVX2 } )
+        {
+            if ( grid_kernel_supported( candidate ) )
+                best = candidate;
+        }
+        const char * limit = std::getenv( "SUDOKU_GRID_KERNEL" );
+        if ( limit == nullptr )
+            return best;
+        for ( GridKernel lower : { GridKernel::SCALAR , GridKernel::SSSE3 } )
+        {
+            if ( ( lower < best ) && ( std::strcmp( limit , grid_kernel_to_string( lower ) ) == 0 ) )
+                return lower;
+        }
+        return best;
+    }();
+    return kernel;
+}
+
+void grid_scan_batch( const cell_t * cells , std::size_t count , std::uint8_t * legal , candidate_mask_t * candidates ,
+                      GridKernel kernel ) noexcept( true )
+{
+    if ( grid_kernel_supported( kernel ) == false )
+        kernel = GridKernel::SCALAR;
+    std::size_t p = 0;
+    #ifdef GRID_KERNEL_X86
+        if ( kernel == GridKernel::AVX2 )
+        {
+            for ( ; p + 32 <= count ; p += 32 )
+                scan_block_avx2( cells , count , p , legal , candidates );
+        }
+        else if ( kernel == GridKernel::SSSE3 )
+        {
+            for ( ; p + 16 <= count ; p += 16 )
+                scan_block_ssse3( cells , count , p , legal , candidates );
+        }
+    #endif
+    scan_scalar( cells , count , p , count , legal , candidates );
+}
+
+void grid_scan_batch( const cell_t * cells , std::size_t count , std::uint8_t * legal , candidate_mask_t * candidates ) noexcept( true )
+{
+    grid_scan_batch( cells , count , legal , candidates , grid_default_kernel() );
+}
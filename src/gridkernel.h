@@ -0,0 +1,63 @@
+#pragma once
+#ifndef GRIDKERNEL_H
+#define GRIDKERNEL_H
+
+#include <cstdint>
+
+#include <array>
+
+#include "sudoku.h"
+
+/*
+* occupancy and candidate masks of whole grids,bit k - 1:digit k.
+* one grid:scalar bit operations,27 unit masks in a single pass over the 81 cells.
+* many grids:structure of arrays,a vector lane is a puzzle,so every cell is one load and
+* a few and/or with no shuffle:
+*   cells[k*count + p]       cell k( x*SUDOKU_SIZE + y ) of puzzle p
+*   candidates[k*count + p]  its candidate mask,0 for a filled cell or an illegal puzzle
+* the batch kernel is picked at run time( avx2,ssse3,scalar ).
+*/
+
+//puzzles a batch call for large corpora:cell rows k*count stay few pages apart,
+//a much larger count turns every vector step into 81 tlb misses
+constexpr std::size_t GRID_BATCH_BLOCK = 1024;
+
+//implementation of the batch kernel
+enum class GridKernel:std::uint8_t
+{
+    SCALAR = 0,
+    //16 puzzles a step
+    SSSE3,
+    //32 puzzles a step
+    AVX2,
+};
+
+//occupancy of one grid
+struct GridMasks
+{
+    std::array< candidate_mask_t , SUDOKU_SIZE > rows;
+    std::array< candidate_mask_t , SUDOKU_SIZE > columns;
+    std::array< candidate_mask_t , SUDOKU_SIZE > boxes;
+    //value above SUDOKU_SIZE or digit repeated in a unit
+    bool illegal;
+
+    //digits still allowed in cell ( x , y ),ignore the cell own value
+    candidate_mask_t get_allowed( std::size_t x , std::size_t y ) const noexcept( true );
+};
+
+GridMasks grid_masks( const puzzle_t& puzzle ) noexcept( true );
+
+//masks[x*SUDOKU_SIZE + y]:candidates of empty cells,0 for filled cells,all 0 and false when illegal
+bool grid_candidates( const puzzle_t& puzzle , std::array< candidate_mask_t , SUDOKU_SIZE*SUDOKU_SIZE >& masks ) noexcept( true );
+
+//legal[p]:1 legal,0 illegal.candidates may be nullptr to only check
+void grid_scan_batch( const cell_t * cells , std::size_t count , std::uint8_t * legal , candidate_mask_t * candidates ,
+                      GridKernel kernel ) noexcept( true );
+void grid_scan_batch( const cell_t * cells , std::size_t count , std::uint8_t * legal , candidate_mask_t * candidates ) noexcept( true );
+
+//fastest kernel the cpu support,$SUDOKU_GRID_KERNEL( scalar,ssse3,avx2 ) lower it for comparison
+GridKernel grid_default_kernel( void ) noexcept( true );
+bool grid_kernel_supported( GridKernel kernel ) noexcept( true );
+const char * grid_kernel_to_string( GridKernel kernel ) noexcept( true );
+
+#endif
@@ -0,0 +1,301 @@
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "history.h"
+
+static constexpr history_record_t INDEX_MASK = 0x7F;
+static constexpr history_record_t KIND_BIT = 7;
+static constexpr history_record_t VALUE_MASK = 0x0F;
+static constexpr history_record_t CANDIDATE_MASK = 0x1FF;
+
+history_record_t pack_digit_record( std::size_t index , cell_t old_value , cell_t new_value , bool old_answer , bool new_answer ) noexcept( true )
+{
+    return ( index & INDEX_MASK ) |
+           ( static_cast<history_record_t>( HistoryRecordKind::DIGIT_RECORD ) << KIND_BIT ) |
+           ( ( old_value & VALUE_MASK ) << 8 ) |
+           ( ( new_value & VALUE_MASK ) << 12 ) |
+           ( static_cast<history_record_t>( old_answer ) << 16 ) |
+           ( static_cast<history_record_t>( new_answer ) << 17 );
+}
+
+history_record_t pack_candidate_record( std::size_t index , std::uint16_t old_mask , std::uint16_t new_mask ) noexcept( true )
+{
+    return ( index & INDEX_MASK ) |
+           ( static_cast<history_record_t>( HistoryRecordKind::CANDIDATE_RECORD ) << KIND_BIT ) |
+           ( ( old_mask & CANDIDATE_MASK ) << 8 ) |
+           ( ( new_mask & CANDIDATE_MASK ) << 17 );
+}
+
+void apply_record( SudokuState& state , history_record_t record , bool backward ) noexcept( true )
+{
+    std::size_t index = record & INDEX_MASK;
+    if ( index >= SUDOKU_SIZE*SUDOKU_SIZE )
+        return ;
+    if ( static_cast<HistoryRecordKind>( ( record >> KIND_BIT ) & 1 ) == HistoryRecordKind::DIGIT_RECORD )
+    {
+        cell_t value = backward ? ( ( record >> 8 ) & VALUE_MASK ) : ( ( record >> 12 ) & VALUE_MASK );
+        bool answer = backward ? ( ( record >> 16 ) & 1 ) : ( ( record >> 17 ) & 1 );
+        state.puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = value;
+        state.answers[index] = answer;
+    }
+    else
+    {
+        state.candidates[index] = backward ? ( ( record >> 8 ) & CANDIDATE_MASK ) : ( ( record >> 17 ) & CANDIDATE_MASK );
+    }
+}
+
+std::vector<history_record_t> diff_state( const SudokuState& before , const SudokuState& after )
+{
+    std::vector<history_record_t> records;
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        cell_t old_value = before.puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE];
+        cell_t new_value = after.puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE];
+        if ( ( old_value != new_value ) || ( before.answers[index] != after.answers[index] ) )
+            records.push_back( pack_digit_record( index , old_value , new_value , before.answers[index] , after.answers[index] ) );
+    }
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        if ( before.candidates[index] != after.candidates[index] )
+            records.push_back( pack_candidate_record( index , before.candidates[index] , after.candidates[index] ) );
+    }
+    return records;
+}
+
+History::History( std::size_t max_steps , std::size_t snapshot_interval ) noexcept( false ):
+    max_steps( max_steps ),
+    snapshot_interval( snapshot_interval ),
+    cursor( 0 ),
+    base()
+{
+    std::string except_message( __func__ );
+    if ( ( snapshot_interval == 0 ) || ( max_steps < snapshot_interval ) )
+    {
+        except_message += ":snapshot interval must in [ 1 , max steps ]";
+        throw std::invalid_argument( except_message );
+    }
+}
+
+void History::reset( const SudokuState& base )
+{
+    this->base = base;
+    this->cursor = 0;
+    this->records.clear();
+    this->step_ends.clear();
+    this->snapshots.clear();
+}
+
+bool History::push( const SudokuState& before , const SudokuState& after )
+{
+    std::vector<history_record_t> step_records = diff_state( before , after );
+    if ( step_records.empty() )
+        return false;
+    this->truncate( this->cursor );
+    this->records.insert( this->records.end() , step_records.begin() , step_records.end() );
+    this->step_ends.push_back( this->records.size() );
+    this->cursor = this->step_ends.size();
+    if ( this->cursor%this->snapshot_interval == 0 )
+        this->snapshots.push_back( after );
+    if ( this->step_ends.size() > this->max_steps )
+        this->drop_oldest();
+    return true;
+}
+
+void History::push_records( const std::vector<history_record_t>& step_records )
+{
+    if ( step_records.empty() )
+        return ;
+    this->truncate( this->cursor );
+    this->records.insert( this->records.end() , step_records.begin() , step_records.end() );
+    this->step_ends.push_back( this->records.size() );
+    this->cursor = this->step_ends.size();
+    if ( this->cursor%this->snapshot_interval == 0 )
+        this->snapshots.push_back( this->get_state( this->cursor ) );
+    if ( this->step_ends.size() > this->max_steps )
+        this->drop_oldest();
+}
+
+bool History::can_undo( void ) const noexcept( true )
+{
+    return this->cursor != 0;
+}
+
+bool History::can_redo( void ) const noexcept( true )
+{
+    return this->cursor < this->step_ends.size();
+}
+
+std::size_t History::get_cursor( void ) const noexcept( true )
+{
+    return this->cursor;
+}
+
+std::size_t History::get_step_count( void ) const noexcept( true )
+{
+    return this->step_ends.size();
+}
+
+std::pair<const history_record_t * , std::size_t> History::get_step( std::size_t step ) const noexcept( false )
+{
+    std::size_t begin = ( step == 0 ) ? 0 : this->step_ends.at( step - 1 );
+    std::size_t end = this->step_ends.at( step );
+    return { this->records.data() + begin , end - begin };
+}
+
+std::size_t History::get_memory_usage( void ) const noexcept( true )
+{
+    return this->records.capacity()*sizeof( history_record_t ) +
+           this->step_ends.capacity()*sizeof( std::uint32_t ) +
+           ( this->snapshots.capacity() + 1 )*sizeof( SudokuState );
+}
+
+bool History::undo( SudokuState& state ) noexcept( true )
+{
+    if ( this->can_undo() == false )
+        return false;
+    auto step = this->get_step( this->cursor - 1 );
+    //reverse order,later record may depend on earlier one
+    for ( std::size_t i = step.second ; i > 0 ; i-- )
+    {
+        apply_record( state , step.first[i - 1] , true );
+    }
+    this->cursor--;
+    return true;
+}
+
+bool History::redo( SudokuState& state ) noexcept( true )
+{
+    if ( this->can_redo() == false )
+        return false;
+    auto step = this->get_step( this->cursor );
+    for ( std::size_t i = 0 ; i < step.second ; i++ )
+    {
+        apply_record( state , step.first[i] );
+    }
+    this->cursor++;
+    return true;
+}
+
+SudokuState History::jump( std::size_t step ) noexcept( false )
+{
+    SudokuState state = this->get_state( step );
+    this->cursor = step;
+    return state;
+}
+
+SudokuState History::get_state( std::size_t step ) const noexcept( false )
+{
+    std::string except_message( __func__ );
+    if ( step > this->step_ends.size() )
+    {
+        except_message += ":step:" + std::to_string( step );
+        except_message += ",out of range [ 0 , " + std::to_string( this->step_ends.size() ) + " ]";
+        throw std::out_of_range( except_message );
+    }
+    //nearest snapshot at or before step
+    std::size_t snapshot = std::min( step/this->snapshot_interval , this->snapshots.size() );
+    SudokuState state = ( snapshot == 0 ) ? this->base : this->snapshots[snapshot - 1];
+    std::size_t begin = ( snapshot*this->snapshot_interval == 0 ) ? 0 : this->step_ends[snapshot*this->snapshot_interval - 1];
+    std::size_t end = ( step == 0 ) ? 0 : this->step_ends[step - 1];
+    for ( std::size_t i = begin ; i < end ; i++ )
+    {
+        apply_record( state , this->records[i] );
+    }
+    return state;
+}
+
+void History::truncate( std::size_t step_count )
+{
+    if ( step_count >= this->step_ends.size() )
+        return ;
+    this->step_ends.resize( step_count );
+    this->records.resize( ( step_count == 0 ) ? 0 : this->step_ends.back() );
+    this->snapshots.resize( std::min( this->snapshots.size() , step_count/this->snapshot_interval ) );
+}
+
+void History::drop_oldest( void )
+{
+    //drop a whole snapshot interval,the first snapshot become the base
+    if ( this->snapshots.empty() || ( this->cursor < this->snapshot_interval ) )
+        return ;
+    std::uint32_t offset = this->step_ends[this->snapshot_interval - 1];
+    this->base = this->snapshots.front();
+    this->snapshots.erase( this->snapshots.begin() );
+    this->records.erase( this->records.begin() , this->records.begin() + offset );
+    this->step_ends.erase( this->step_ends.begin() , this->step_ends.begin() + this->snapshot_interval );
+    for ( auto& step_end : this->step_ends )
+    {
+        step_end -= offset;
+    }
+    this->cursor -= this->snapshot_interval;
+}
+
+GameHistory::GameHistory( Sudoku& game , std::size_t max_steps , std::size_t snapshot_interval ) noexcept( false ):
+    game( game ),
+    history( max_steps , snapshot_interval )
+{
+    this->history.reset( this->game.get_state() );
+}
+
+void GameHistory::reset( void )
+{
+    this->history.reset( this->game.get_state() );
+}
+
+bool GameHistory::execute( const std::function<void( Sudoku& )>& operation )
+{
+    SudokuState before = this->game.get_state();
+    try
+    {
+        operation( this->game );
+    }
+    catch( ... )
+    {
+        //keep history match the board even if operation failed half way
+        this->history.push( before , this->game.get_state() );
+        throw;
+    }
+    return this->history.push( before , this->game.get_state() );
+}
+
+bool GameHistory::undo( void )
+{
+    SudokuState state = this->game.get_state();
+    if ( this->history.undo( state ) == false )
+        return false;
+    this->game.set_state( state );
+    return true;
+}
+
+bool GameHistory::redo( void )
+{
+    SudokuState state = this->game.get_state();
+    if ( this->history.redo( state ) == false )
+        return false;
+    this->game.set_state( state );
+    return true;
+}
+
+bool GameHistory::jump( std::size_t step )
+{
+    if ( step > this->history.get_step_count() )
+        return false;
+    this->game.set_state( this->history.jump( step ) );
+    return true;
+}
+
+const History& GameHistory::get_history( void ) const noexcept( true )
+{
+    return this->history;
+}
+
+History& GameHistory::get_history( void ) noexcept( true )
+{
+    return this->history;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <cstdint>
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "sudoku.h"
+
+//one cell change packed in 32 bit:
+//  bit 0-6 cell index,bit 7 kind
+//  DIGIT_RECORD:bit 8-11 old value,bit 12-15 new value,bit 16 old answer,bit 17 new answer
+//  CANDIDATE_RECORD:bit 8-16 old mask,bit 17-25 new mask
+typedef std::uint32_t history_record_t;
+
+enum class HistoryRecordKind:std::uint32_t
+{
+    DIGIT_RECORD = 0,
+    CANDIDATE_RECORD
+};
+
+history_record_t pack_digit_record( std::size_t index , cell_t old_value , cell_t new_value , bool old_answer , bool new_answer ) noexcept( true );
+
+history_record_t pack_candidate_record( std::size_t index , std::uint16_t old_mask , std::uint16_t new_mask ) noexcept( true );
+
+//apply record to state,backward apply the inverse change
+void apply_record( SudokuState& state , history_record_t record , bool backward = false ) noexcept( true );
+
+//every differ cell of two state,digit before candidate
+std::vector<history_record_t> diff_state( const SudokuState& before , const SudokuState& after );
+
+//undo/redo history of board states.
+//a step is all records of one user operation( fill + autoupdate elimination ),undo/redo as a whole.
+//a full snapshot every snapshot_interval steps,state of any step cost at most snapshot_interval step replay.
+//older steps dropped beyond max_steps
+class History
+{
+    public:
+        History( std::size_t max_steps = 1 << 16 , std::size_t snapshot_interval = 64 ) noexcept( false );
+
+        //forget all step,state become step 0
+        void reset( const SudokuState& base );
+
+        //drop redo steps,append after - before as a new step.no change return false
+        bool push( const SudokuState& before , const SudokuState& after );
+        //append recorded step( journal replay )
+        void push_records( const std::vector<history_record_t>& records );
+
+        bool can_undo( void ) const noexcept( true );
+        bool can_redo( void ) const noexcept( true );
+        //step after cursor - 1 applied to the board
+        std::size_t get_cursor( void ) const noexcept( true );
+        std::size_t get_step_count( void ) const noexcept( true );
+        //step [ 0 , get_step_count() ) records
+        std::pair<const history_record_t * , std::size_t> get_step( std::size_t step ) const noexcept( false );
+        std::size_t get_memory_usage( void ) const noexcept( true );
+
+        //state is the board at cursor,become the board at new cursor
+        bool undo( SudokuState& state ) noexcept( true );
+        bool redo( SudokuState& state ) noexcept( true );
+        //board after step [ 0 , get_step_count() ],cursor move to it
+        SudokuState jump( std::size_t step ) noexcept( false );
+        SudokuState get_state( std::size_t step ) const noexcept( false );
+    private:
+        void truncate( std::size_t step_count );
+        void drop_oldest( void );
+
+        std::size_t max_steps;
+        std::size_t snapshot_interval;
+        std::size_t cursor;
+        //board before first step
+        SudokuState base;
+        std::vector<history_record_t> records;
+        //step i records:[ step_ends[i - 1] , step_ends[i] )
+        std::vector<std::uint32_t> step_ends;
+        //snapshots[k]:board after step ( k + 1 )*snapshot_interval
+        std::vector<SudokuState> snapshots;
+};
+
+//record operations on a Sudoku,shared by the board undo/redo buttons
+class GameHistory
+{
+    public:
+        explicit GameHistory( Sudoku& game , std::size_t max_steps = 1 << 16 , std::size_t snapshot_interval = 64 ) noexcept( false );
+        GameHistory( const GameHistory& ) = delete;
+        GameHistory& operator=( const GameHistory& ) = delete;
+
+        //current board become step 0
+        void reset( void );
+        //run operation,whole effect on the board become one step,false if board unchanged.
+        //exception pass through after recording the partial effect
+        bool execute( const std::function<void( Sudoku& )>& operation );
+        bool undo( void );
+        bool redo( void );
+        bool jump( std::size_t step );
+
+        const History& get_history( void ) const noexcept( true );
+        History& get_history( void ) noexcept( true );
+    private:
+        Sudoku& game;
+        History history;
+};
+
+#endif
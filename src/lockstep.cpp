@@ -0,0 +1,390 @@
+#include <cstdint>
+#include <cstring>
+
+#include <array>
+#include <chrono>
+#include <vector>
+
+#include "lockstep.h"
+#include "metrics.h"
+#include "trace.h"
+
+#if defined( __x86_64__ ) && defined( __GNUC__ )
+    #define LOCKSTEP_X86
+#endif
+
+constexpr std::size_t CELL_NUMBER = SUDOKU_SIZE*SUDOKU_SIZE;
+constexpr std::int16_t ALL_DIGITS = ( 1 << SUDOKU_SIZE ) - 1;
+
+//lane l:puzzle of lane l.lane masks are -1 true,0 false
+typedef std::int16_t lane_vector_t __attribute__(( vector_size( LOCKSTEP_LANES*sizeof( std::int16_t ) ) ));
+//candidate masks of one lane,saved at a guess
+typedef std::array< candidate_mask_t , CELL_NUMBER > lane_grid_t;
+
+//the step is compiled once for every kernel,its helpers must be inlined into each copy.
+//so no vector ever cross a call and the avx argument abi warning is moot
+#define LOCKSTEP_INLINE inline __attribute__(( always_inline ))
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+//unit indexes of every cell:row,column,box
+struct LockstepUnits
+{
+    std::array< std::uint8_t , CELL_NUMBER > rows;
+    std::array< std::uint8_t , CELL_NUMBER > columns;
+    std::array< std::uint8_t , CELL_NUMBER > boxes;
+
+    LockstepUnits()
+    {
+        for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+        {
+            std::size_t x = k/SUDOKU_SIZE;
+            std::size_t y = k%SUDOKU_SIZE;
+            this->rows[k] = static_cast<std::uint8_t>( x );
+            this->columns[k] = static_cast<std::uint8_t>( y );
+            this->boxes[k] = static_cast<std::uint8_t>( ( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + y/SUDOKU_BOX_SIZE );
+        }
+    }
+};
+
+static const LockstepUnits lockstep_units;
+
+//search state of one lane
+struct LockstepLane
+{
+    //false:queue empty,the lane only hold a stable dummy grid
+    bool active = false;
+    std::size_t index = 0;
+    //grid to resume when the current guess fail,the guessed digit already removed
+    std::vector<lane_grid_t> guesses;
+};
+
+//everything a step touch,shared by the kernels
+struct LockstepContext
+{
+    const puzzle_t * puzzles;
+    std::size_t count;
+    BatchSolution * results;
+    std::size_t solution_limit;
+    const SolveLimits * limits;
+    std::vector<puzzle_t> * solutions;
+
+    lane_vector_t cells[CELL_NUMBER];
+    std::array< LockstepLane , LOCKSTEP_LANES > lanes;
+    std::size_t next = 0;
+    std::size_t active_number = 0;
+};
+
+static LOCKSTEP_INLINE lane_vector_t select_lanes( lane_vector_t mask , lane_vector_t if_true , lane_vector_t if_false )
+{
+    return ( mask & if_true ) | ( ~mask & if_false );
+}
+
+//lane masks from the sign bit,not vector compares:without avx gcc turn a 256 bit compare into 16 scalar ones.
+//-x | x is negative unless x is 0
+static LOCKSTEP_INLINE lane_vector_t nonzero_lanes( lane_vector_t values )
+{
+    return ( values | -values ) >> 15;
+}
+
+//small non negative values only
+static LOCKSTEP_INLINE lane_vector_t less_lanes( lane_vector_t lhs , lane_vector_t rhs )
+{
+    return ( lhs - rhs ) >> 15;
+}
+
+//lanes holding exactly one digit
+static LOCKSTEP_INLINE lane_vector_t single_lanes( lane_vector_t masks )
+{
+    return ~nonzero_lanes( masks & ( masks - 1 ) ) & nonzero_lanes( masks );
+}
+
+static LOCKSTEP_INLINE lane_vector_t popcount_lanes( lane_vector_t masks )
+{
+    masks = masks - ( ( masks >> 1 ) & 0x5555 );
+    masks = ( masks & 0x3333 ) + ( ( masks >> 2 ) & 0x3333 );
+    masks = ( masks + ( masks >> 4 ) ) & 0x0F0F;
+    return ( masks + ( masks >> 8 ) ) & 0x001F;
+}
+
+static LOCKSTEP_INLINE bool any_lane( lane_vector_t masks )
+{
+    std::uint64_t words[sizeof( lane_vector_t )/sizeof( std::uint64_t )];
+    std::memcpy( words , &masks , sizeof( words ) );
+    std::uint64_t any = 0;
+    for ( auto word : words )
+        any |= word;
+    return any != 0;
+}
+
+/*
+* one elimination round on every lane,three passes over the cells:
+*   placed digits of each unit,a digit placed twice in a unit kill the lane
+*   placed digits leave their peers( naked single ),count the digits of each unit once/twice
+*   a digit only one cell of a unit can hold is placed there( hidden single ),
+*   two such digits in one cell or a digit no cell of a unit can hold kill the lane
+* masks only lose bits,so repeating it until no live lane change always end.
+* return the lanes changed
+*/
+static LOCKSTEP_INLINE lane_vector_t propagate_round( lane_vector_t * cells , lane_vector_t& dead )
+{
+    const LockstepUnits& units = lockstep_units;
+    lane_vector_t placed[3][SUDOKU_SIZE] = {};
+    lane_vector_t repeated = {};
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+    {
+        lane_vector_t digit = cells[k] & single_lanes( cells[k] );
+        lane_vector_t& row = placed[0][units.rows[k]];
+        lane_vector_t& column = placed[1][units.columns[k]];
+        lane_vector_t& box = placed[2][units.boxes[k]];
+        repeated |= ( row | column | box ) & digit;
+        row |= digit;
+        column |= digit;
+        box |= digit;
+    }
+
+    lane_vector_t changed = {};
+    lane_vector_t once[3][SUDOKU_SIZE] = {};
+    lane_vector_t twice[3][SUDOKU_SIZE] = {};
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+    {
+        std::size_t unit[3] = { units.rows[k] , units.columns[k] , units.boxes[k] };
+        lane_vector_t masks = cells[k];
+        lane_vector_t peers = placed[0][unit[0]] | placed[1][unit[1]] | placed[2][unit[2]];
+        lane_vector_t reduced = select_lanes( single_lanes( masks ) , masks , masks & ~peers );
+        changed |= reduced ^ masks;
+        dead |= ~nonzero_lanes( reduced );
+        cells[k] = reduced;
+        for ( std::size_t u = 0 ; u < 3 ; u++ )
+        {
+            twice[u][unit[u]] |= once[u][unit[u]] & reduced;
+            once[u][unit[u]] |= reduced;
+        }
+    }
+    for ( std::size_t u = 0 ; u < 3 ; u++ )
+    {
+        for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+        {
+            dead |= nonzero_lanes( once[u][i] ^ ALL_DIGITS );
+            //reuse once as the digits held by a single cell of the unit
+            once[u][i] &= ~twice[u][i];
+        }
+    }
+    dead |= nonzero_lanes( repeated );
+
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+    {
+        lane_vector_t masks = cells[k];
+        lane_vector_t hidden = masks & ( once[0][units.rows[k]] | once[1][units.columns[k]] | once[2][units.boxes[k]] );
+        lane_vector_t found = nonzero_lanes( hidden );
+        dead |= found & ~single_lanes( hidden );
+        lane_vector_t placed_masks = select_lanes( found , hidden , masks );
+        changed |= placed_masks ^ masks;
+        cells[k] = placed_masks;
+    }
+    return changed;
+}
+
+static LOCKSTEP_INLINE void write_lane( LockstepContext& context , std::size_t lane , const lane_grid_t& grid )
+{
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+        context.cells[k][lane] = static_cast<std::int16_t>( grid[k] );
+}
+
+static LOCKSTEP_INLINE lane_grid_t read_lane( const LockstepContext& context , std::size_t lane )
+{
+    lane_grid_t grid;
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+        grid[k] = static_cast<candidate_mask_t>( context.cells[k][lane] );
+    return grid;
+}
+
+//next legal queued puzzle into the lane,illegal ones are answered without search
+static LOCKSTEP_INLINE void load_lane( LockstepContext& context , std::size_t lane )
+{
+    LockstepLane& state = context.lanes[lane];
+    state.guesses.clear();
+    while ( context.next < context.count )
+    {
+        std::size_t index = context.next++;
+        const puzzle_t& puzzle = context.puzzles[index];
+        context.results[index] = BatchSolution();
+        lane_grid_t grid;
+        if ( grid_candidates( puzzle , grid ) == false )
+        {
+            context.results[index].legal = false;
+            continue;
+        }
+        for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+        {
+            cell_t value = puzzle[k/SUDOKU_SIZE][k%SUDOKU_SIZE];
+            if ( value != 0 )
+                grid[k] = 1U << ( value - 1 );
+        }
+        write_lane( context , lane , grid );
+        state.active = true;
+        state.index = index;
+        return;
+    }
+    //every digit everywhere is stable under propagation,the idle lane never cost a round
+    lane_grid_t idle;
+    idle.fill( ALL_DIGITS );
+    write_lane( context , lane , idle );
+    state.active = false;
+    context.active_number--;
+}
+
+static LOCKSTEP_INLINE void record_solution( LockstepContext& context , std::size_t lane )
+{
+    LockstepLane& state = context.lanes[lane];
+    BatchSolution& result = context.results[state.index];
+    puzzle_t solution;
+    for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+    {
+        solution[k/SUDOKU_SIZE][k%SUDOKU_SIZE] = static_cast<cell_t>( __builtin_ctz( context.cells[k][lane] ) + 1 );
+    }
+    if ( result.solution_count == 0 )
+        result.solution = solution;
+    if ( context.solutions != nullptr )
+        context.solutions[state.index].push_back( solution );
+    result.solution_count++;
+}
+
+//step until every lane is idle or the limits stop the call
+static LOCKSTEP_INLINE void lockstep_run( LockstepContext& context )
+{
+    const SolveLimits& limits = *context.limits;
+    context.active_number = LOCKSTEP_LANES;
+    for ( std::size_t lane = 0 ; lane < LOCKSTEP_LANES ; lane++ )
+        load_lane( context , lane );
+
+    while ( context.active_number > 0 )
+    {
+        if ( ( limits.stop != nullptr ) && limits.stop->load( std::memory_order_relaxed ) )
+            break;
+        if ( ( limits.deadline != std::chrono::steady_clock::time_point::max() ) && ( std::chrono::steady_clock::now() >= limits.deadline ) )
+            break;
+
+        lane_vector_t dead = {};
+        while ( any_lane( propagate_round( context.cells , dead ) & ~dead ) )
+            ;
+
+        //solved lanes and the fewest candidate cell of the others
+        lane_vector_t solved = ~dead;
+        lane_vector_t best_count = {};
+        best_count += static_cast<std::int16_t>( SUDOKU_SIZE + 1 );
+        lane_vector_t best_cell = {};
+        for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+        {
+            lane_vector_t counts = popcount_lanes( context.cells[k] );
+            solved &= ~nonzero_lanes( counts ^ 1 );
+            lane_vector_t better = less_lanes( lane_vector_t{} + static_cast<std::int16_t>( 1 ) , counts ) & less_lanes( counts , best_count );
+            best_count = select_lanes( better , counts , best_count );
+            best_cell = select_lanes( better , lane_vector_t{} + static_cast<std::int16_t>( k ) , best_cell );
+        }
+
+        for ( std::size_t lane = 0 ; lane < LOCKSTEP_LANES ; lane++ )
+        {
+            LockstepLane& state = context.lanes[lane];
+            if ( state.active == false )
+                continue;
+            BatchSolution& result = context.results[state.index];
+            if ( ( dead[lane] != 0 ) || ( solved[lane] != 0 ) )
+            {
+                if ( solved[lane] != 0 )
+                {
+                    record_solution( context , lane );
+                    if ( ( context.solution_limit != 0 ) && ( result.solution_count >= context.solution_limit ) )
+                    {
+                        load_lane( context , lane );
+                        continue;
+                    }
+                }
+                if ( state.guesses.empty() )
+                {
+                    load_lane( context , lane );
+                    continue;
+                }
+                write_lane( context , lane , state.guesses.back() );
+                state.guesses.pop_back();
+                continue;
+            }
+            if ( ( limits.node_budget != 0 ) && ( result.nodes >= limits.node_budget ) )
+            {
+                result.status = SolveStatus::BUDGET_EXCEEDED;
+                load_lane( context , lane );
+                continue;
+            }
+            result.nodes++;
+            std::size_t cell = static_cast<std::size_t>( best_cell[lane] );
+            std::int16_t masks = context.cells[cell][lane];
+            std::int16_t digit = masks & -masks;
+            lane_grid_t resume = read_lane( context , lane );
+            resume[cell] = static_cast<candidate_mask_t>( masks & ~digit );
+            state.guesses.push_back( resume );
+            context.cells[cell][lane] = digit;
+        }
+    }
+}
+
+#ifdef LOCKSTEP_X86
+__attribute__(( target( "avx2" ) ))
+static void lockstep_run_avx2( LockstepContext& context )
+{
+    lockstep_run( context );
+}
+#endif
+
+static void lockstep_run_portable( LockstepContext& context )
+{
+    lockstep_run( context );
+}
+
+void lockstep_solve( const puzzle_t * puzzles , std::size_t count , BatchSolution * results , std::size_t solution_limit ,
+                     const SolveLimits& limits , std::vector<puzzle_t> * solutions , GridKernel kernel ) noexcept( false )
+{
+    SUDOKU_TRACE_SCOPE( "lockstep_solve" );
+    static MetricCounter& solved = metrics().counter( "solver.lockstep_puzzles" );
+    if ( count == 0 )
+        return ;
+    LockstepContext context;
+    context.puzzles = puzzles;
+    context.count = count;
+    context.results = results;
+    context.solution_limit = solution_limit;
+    context.limits = &limits;
+    context.solutions = solutions;
+    for ( auto& lane : context.lanes )
+        lane.guesses.reserve( SUDOKU_SIZE*SUDOKU_BOX_SIZE );
+
+    #ifdef LOCKSTEP_X86
+        if ( ( kernel == GridKernel::AVX2 ) && grid_kernel_supported( kernel ) )
+            lockstep_run_avx2( context );
+        else
+            lockstep_run_portable( context );
+    #else
+        (void)kernel;
+        lockstep_run_portable( context );
+    #endif
+
+    //stopped by the limits:lanes in flight and the queue keep what they have
+    SolveStatus stopped = ( ( limits.stop != nullptr ) && limits.stop->load( std::memory_order_relaxed ) ) ?
+                          SolveStatus::CANCELLED : SolveStatus::BUDGET_EXCEEDED;
+    for ( const auto& lane : context.lanes )
+    {
+        if ( lane.active )
+            results[lane.index].status = stopped;
+    }
+    for ( std::size_t index = context.next ; index < count ; index++ )
+    {
+        results[index] = BatchSolution();
+        results[index].legal = check_puzzle( puzzles[index] );
+        results[index].status = stopped;
+    }
+    solved.add( context.next );
+}
+
+void lockstep_solve( const puzzle_t * puzzles , std::size_t count , BatchSolution * results , std::size_t solution_limit ,
+                     const SolveLimits& limits , std::vector<puzzle_t> * solutions ) noexcept( false )
+{
+    lockstep_solve( puzzles , count , results , solution_limit , limits , solutions , grid_default_kernel() );
+}
@@ -0,0 +1,37 @@
+#pragma once
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include <cstdint>
+
+#include <vector>
+
+#include "dancinglinks.h"
+#include "gridkernel.h"
+#include "sudoku.h"
+
+/*
+* many independent puzzles searched together,lane l of every vector belongs to one puzzle:
+*   cells[k] lane l   16 bit candidate mask of cell k( x*SUDOKU_SIZE + y ),a single bit is a placed digit
+* a step run the bitwise propagation on every lane at once( naked and hidden singles of the
+* 27 units,repeated until no live lane change ),then every lane on its own:
+*   contradiction  resume its last guess with the next digit,finished when there is none left
+*   solved         count the solution,resume its last guess unless the solution limit is reached
+*   otherwise      guess the lowest digit of its fewest candidate cell
+* a finished lane take the next queued puzzle in the same step,so lanes never wait for each other.
+* search nodes are guesses,not comparable with DancingLinks nodes.
+*/
+
+//puzzles advanced together,one 256 bit vector of 16 bit masks
+constexpr std::size_t LOCKSTEP_LANES = 16;
+
+//results[i] for puzzles[i],node_budget per puzzle,stop and deadline for the whole call:
+//puzzles not finished then keep CANCELLED/BUDGET_EXCEEDED and the solutions so far.
+//solutions may be nullptr,otherwise solutions[i] get every solution found of puzzles[i] appended.
+//kernel:AVX2,anything else the portable lanes( sse2 on x86-64 ),an unsupported one fall back
+void lockstep_solve( const puzzle_t * puzzles , std::size_t count , BatchSolution * results , std::size_t solution_limit ,
+                     const SolveLimits& limits , std::vector<puzzle_t> * solutions , GridKernel kernel ) noexcept( false );
+void lockstep_solve( const puzzle_t * puzzles , std::size_t count , BatchSolution * results , std::size_t solution_limit ,
+                     const SolveLimits& limits , std::vector<puzzle_t> * solutions = nullptr ) noexcept( false );
+
+#endif
@@ -1,13 +1,24 @@
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 
+#include <algorithm>
 #include <array>
+#include <bitset>
 #include <chrono>
 #include <deque>
 #include <exception>
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <sigc++/sigc++.h>
 #include <glibmm/main.h>
@@ -17,6 +28,8 @@
 #include <gtkmm/clipboard.h>
 #include <gtkmm/button.h>
 #include <gtkmm/builder.h>
+#include <gtkmm/box.h>
+#include <gtkmm/checkbutton.h>
 #include <gtkmm/drawingarea.h>
 #include <gtkmm/eventbox.h>
 #include <gtkmm/filechooserdialog.h>
@@ -25,62 +38,119 @@
 #include <gtkmm/label.h>
 #include <gtkmm/menuitem.h>
 #include <gtkmm/popover.h>
+#include <gtkmm/spinbutton.h>
 #include <gtkmm/window.h>
 #include <gtkmm/window.h>
 
+#include "boardrenderer.h"
+#include "booklet.h"
+#include "generator.h"
+#include "history.h"
+#include "metrics.h"
+#include "puzzlefetcher.h"
+#include "puzzleimport.h"
+#include "puzzlepool.h"
+#include "replay.h"
+#include "session.h"
+#include "solutioncache.h"
 #include "sudoku.h"
+#include "taskexecutor.h"
+#include "trace.h"
 
 constexpr SUDOKU_LEVEL NEW_GAME_LEVEL = SUDOKU_LEVEL::MEDIUM;
 static const Glib::ustring UI_FILE( "./resource/sudoku.ui" );
-
-static Gdk::RGBA BOARD_BACKGROUD_RGBA( Glib::ustring( "rgba( 255 , 255 , 255 , 1.0 )" ) );
-static Gdk::RGBA PUZZLE_NUMBER_RGBA  ( Glib::ustring( "rgba(   0 ,   0 ,   0 , 1.0 )" ) );
-static Gdk::RGBA ANSWER_NUMBER_RGBA  ( Glib::ustring( "rgba(  74 , 144 , 226 , 1.0 )" ) );
-static Gdk::RGBA SELECT_ROW_RGBA     ( Glib::ustring( "rgba( 226 , 231 , 237 , 1.0 )" ) );
-static Gdk::RGBA SELECT_CELL_RGBA    ( Glib::ustring( "rgba( 187 , 222 , 251 , 1.0 )" ) );
-static Gdk::RGBA SELECT_NUMBER_RGBA  ( Glib::ustring( "rgba(   1 ,   2 , 255 , 1.0 )" ) );
-static Gdk::RGBA BUTTON_BORDER_RGBA  ( Glib::ustring( "rgba( 190 , 198 , 212 , 1.0 )" ) );
-
-enum class Themes:std::uint32_t
+//journal rewritten when appended records exceed twice the compacted size plus this
+constexpr std::size_t JOURNAL_COMPACT_SLACK = 4096;
+//replay playback wait while the game is paused
+constexpr std::uint32_t REPLAY_POLL_MS = 100;
+//performance hud redraw period,numbers from background work change without a board redraw
+constexpr std::uint32_t METRICS_REFRESH_MS = 500;
+//background solve of a game without known solution,not found in time is refused,under-constrained import can't tie up a worker
+constexpr std::chrono::seconds SOLVE_TIME_LIMIT( 5 );
+//generator pipeline give up the band after it
+constexpr std::chrono::seconds GENERATE_TIME_LIMIT( 10 );
+constexpr std::size_t SOLUTION_CACHE_CAPACITY = 256;
+
+//solutions by clues,reload of a puzzle( import again,resume ) solve nothing
+static SolutionCache solution_cache( SOLUTION_CACHE_CAPACITY );
+
+//SUDOKU_JOURNAL_SYNC=none|interval|always,default interval
+static JournalSync journal_sync_policy( void )
 {
-    LIGHT,
-    DARK
-};
+    const char * policy = std::getenv( "SUDOKU_JOURNAL_SYNC" );
+    if ( policy == nullptr )
+        return JournalSync::INTERVAL;
+    std::string policy_string( policy );
+    if ( policy_string == "none" )
+        return JournalSync::NONE;
+    if ( policy_string == "always" )
+        return JournalSync::ALWAYS;
+    return JournalSync::INTERVAL;
+}
+
+static Themes current_theme = Themes::LIGHT;
 
 static void set_theme( const Themes theme )
 {
-    switch ( theme )
-    {
-        default:
-        case Themes::LIGHT:
-        {
-            BOARD_BACKGROUD_RGBA.set( Glib::ustring( "rgba( 255 , 255 , 255 , 1.0 )" ) );
-            PUZZLE_NUMBER_RGBA.set( Glib::ustring( "rgba(   0 ,   0 ,   0 , 1.0 )" ) );
-            ANSWER_NUMBER_RGBA.set( Glib::ustring( "rgba(  74 , 144 , 226 , 1.0 )" ) );
-            SELECT_ROW_RGBA.set( Glib::ustring( "rgba( 226 , 231 , 237 , 1.0 )" ) );
-            SELECT_CELL_RGBA.set( Glib::ustring( "rgba( 187 , 222 , 251 , 1.0 )" ) );
-            SELECT_NUMBER_RGBA.set( Glib::ustring( "rgba(   1 ,   2 , 255 , 1.0 )" ) );
-            BUTTON_BORDER_RGBA.set( Glib::ustring( "rgba( 190 , 198 , 212 , 1.0 )" ) );
-            break;
-        }
-        case Themes::DARK:
-        {
-            BOARD_BACKGROUD_RGBA.set( Glib::ustring( "rgba( 45 , 45 , 45 , 1.0 )" ) );
-            PUZZLE_NUMBER_RGBA.set( Glib::ustring( "rgba( 171 , 171 , 171 , 1.0 )" ) );
-            ANSWER_NUMBER_RGBA.set( Glib::ustring( "rgba( 255 , 255 , 255 , 1.0 )" ) );
-            SELECT_ROW_RGBA.set( Glib::ustring( "rgba( 141 ,  38 ,  99 , 1.0 )" ) );
-            SELECT_CELL_RGBA.set( Glib::ustring( "rgba(  86 , 187 , 235 , 1.0 )" ) );
-            SELECT_NUMBER_RGBA.set( Glib::ustring( "rgba(  44 , 243 , 151 , 1.0 )" ) );
-            BUTTON_BORDER_RGBA.set( Glib::ustring( "rgba( 241 , 224 ,  10 , 1.0 )" ) );
-            break;
-        }
-    }
+    current_theme = theme;
 }
 
-static void set_rgba( const Cairo::RefPtr<Cairo::Context> & cairo_context , const Gdk::RGBA& rgba )
+//SUDOKU_STARTUP_REPORT=1 print time of every startup phase,relative to static initialization
+static class StartupReport
 {
-    cairo_context->set_source_rgba( rgba.get_red() , rgba.get_green() , rgba.get_blue() , rgba.get_alpha() );
-}
+    public:
+        StartupReport():
+            enabled( std::getenv( "SUDOKU_STARTUP_REPORT" ) != nullptr ),
+            printed( false ),
+            begin( std::chrono::steady_clock::now() )
+        {
+            ;
+        }
+
+        //callable from any thread,a phase only record first time
+        void mark( const std::string& phase )
+        {
+            if ( this->enabled == false )
+                return ;
+            std::lock_guard<std::mutex> lock( this->mutex );
+            if ( this->printed )
+                return ;
+            for ( auto& recorded : this->phases )
+            {
+                if ( recorded.first == phase )
+                    return ;
+            }
+            this->phases.emplace_back( phase , std::chrono::steady_clock::now() );
+
+            //board is interactive:window painted and puzzle playable
+            bool first_frame = false;
+            bool first_puzzle = false;
+            for ( auto& recorded : this->phases )
+            {
+                first_frame = first_frame || ( recorded.first == "first frame" );
+                first_puzzle = first_puzzle || ( recorded.first == "first puzzle ready" );
+            }
+            if ( first_frame && first_puzzle )
+            {
+                this->printed = true;
+                std::string report( "startup phases:" );
+                for ( auto& recorded : this->phases )
+                {
+                    std::chrono::duration<double,std::milli> cost = recorded.second - this->begin;
+                    char line[128];
+                    std::snprintf( line , sizeof( line ) , "\n%10.3f ms %s" , cost.count() , recorded.first.c_str() );
+                    report += line;
+                }
+                g_log( "startup" , G_LOG_LEVEL_MESSAGE , "%s" , report.c_str() );
+            }
+        }
+    private:
+        bool enabled;
+        bool printed;
+        std::chrono::steady_clock::time_point begin;
+        std::mutex mutex;
+        std::vector< std::pair< std::string , std::chrono::steady_clock::time_point > > phases;
+}startup_report;
 
 class SudokuBoard : public Gtk::DrawingArea
 {
@@ -96,7 +166,9 @@ class SudokuBoard : public Gtk::DrawingArea
             PLAYING = 0,
             PAUSE,
             VIEW_SOLUTION,
-            LOADING_NEW_GAME
+            LOADING_NEW_GAME,
+            //board solved,timer stopped,input disabled
+            COMPLETED
         };
 
         enum class PrintType:std::uint32_t
@@ -118,168 +190,163 @@ class SudokuBoard : public Gtk::DrawingArea
         //to support Gtk::Builder::get_widget_derived()
         SudokuBoard( BaseObjectType * cobject , const Glib::RefPtr<Gtk::Builder>& ):
             Gtk::DrawingArea( cobject ),
-            game(),
+            //empty board,real puzzle loaded in background
+            game( puzzle_t() ),
             puzzle( game.get_puzzle() ),
             candidates( game.get_candidates() ),
-            solution( game.get_solution(false)[0] ),
-            candidate_font( "Ubuntu Mono 14" ),
-            solutions_font( "Ubuntu Mono 28" ),
-            state( GameState::PLAYING ),
-            timer()
-        {
-            /*
-            * column_index_size: 5*$(font size)
-            * '  A  '
-            * 
-            * grid size: 6*$(font size)
-            *    '       '
-            *    ' 1 2 3 '
-            *    '       '
-            *    ' 4 5 6 '
-            *    '       '
-            *    ' 7 8 9 '
-            *    '       '
-            *  board size: column_index_size*2 + 9*grid_size
-            */
-
+            solution(),
+            renderer(),
+            state( GameState::LOADING_NEW_GAME ),
+            timer(),
+            history( game )
+        {
             this->add_events( Gdk::EventMask::BUTTON_PRESS_MASK );
-            this->layout = this->create_pango_layout( "strings" );
-            this->layout->set_font_description( this->candidate_font );
-            this->font_size = this->candidate_font.get_size()/Pango::SCALE;
-            this->bold_line_size = this->font_size/2;
-            this->line_size = this->bold_line_size/2;
-            this->grid_size = 6*( this->font_size );
-            this->row_index_size = 5*this->font_size;
-            this->column_index_size = 5*this->font_size;
-            this->board_size = 2*( this->column_index_size ) + 9*( this->grid_size );
+            this->bold_line_size = this->renderer.get_bold_line_size();
+            this->grid_size = this->renderer.get_grid_size();
+            this->row_index_size = this->renderer.get_row_index_size();
+            this->column_index_size = this->renderer.get_column_index_size();
+            this->board_size = this->renderer.get_board_size();
             this->set_size_request( board_size , board_size );
 
-            this->operator_queues = { {} };
-            //undo operator sentinel
-            this->operator_iterator = this->operator_queues.begin();
+            //survive game assignment,redraw only the cells an operation touched
+            this->game.set_change_listener(
+                [ this ]( const CellChange& change )
+                {
+                    this->on_cells_changed( change );
+                }
+            );
+
+            try
+            {
+                this->journal = std::make_unique<SessionJournal>( SessionJournal::default_path() , journal_sync_policy() );
+            }
+            catch( const std::exception& e )
+            {
+                g_log( "SudokuBoard" , G_LOG_LEVEL_WARNING , "session journal disabled:%s" , e.what() );
+            }
+            //resume the last session,nothing to load
+            if ( this->resume_game() )
+                return ;
+
+            //first puzzle from local corpus,window show before it ready
+            this->load_game(
+                []( TaskContext& context ) -> LoadedGame
+                {
+                    LoadedGame loaded = { Sudoku( get_local_puzzle( NEW_GAME_LEVEL ) , NEW_GAME_LEVEL ) , puzzle_t() };
+                    startup_report.mark( "corpus puzzle loaded" );
+                    context.report_progress( 0.5 );
+                    return loaded;
+                }
+            );
         }
         ~SudokuBoard()
         {
-            ;
+            //journal destructor flush it to disk
+            if ( this->journal && ( this->state != GameState::LOADING_NEW_GAME ) )
+                this->journal->append( { this->get_journal_time() , 0 , JournalRecordType::TIME_RECORD , 0 } );
         }
 
         //network puzzle
         void new_game( SUDOKU_LEVEL level )
         {
-            this->set_game_state( SudokuBoard::GameState::LOADING_NEW_GAME );
-            std::shared_future <puzzle_t> puzzle_future = get_network_puzzle( level );
-            Glib::signal_timeout().connect(
-                [ this , puzzle_future , level ]()
+            this->load_game(
+                [ level ]( TaskContext& context ) -> LoadedGame
                 {
-                    std::future_status puzzle_status;
-                    puzzle_status = puzzle_future.wait_for( std::chrono::microseconds( 20 ) );
-                    if ( puzzle_status == std::future_status::ready )
+                    NetworkPuzzle puzzle;
+                    try
                     {
-                        puzzle_t puzzle;
-                        try
+                        //shared with the fetcher,a puzzle arriving after cancel is kept for the next game
+                        auto fetch_cancel = std::make_shared< std::atomic<bool> >( false );
+                        std::shared_future<NetworkPuzzle> puzzle_future = get_network_puzzle( level , fetch_cancel );
+                        while ( puzzle_future.wait_for( std::chrono::milliseconds( 50 ) ) != std::future_status::ready )
                         {
-                            puzzle = puzzle_future.get();
-                        }
-                        catch( const std::exception& e )
-                        {
-                            g_log( __func__ , G_LOG_LEVEL_MESSAGE , e.what() );
-                            //back to using local puzzle play game
-                            puzzle = get_local_puzzle( level );
-                        }
-                        
-                        Sudoku new_sudoku( puzzle , level );
-                        this->game = new_sudoku;
-                        auto auto_answer = game.get_solution( false );
-                        if ( auto_answer.empty() )
-                        {
-                            return false;
+                            if ( context.is_cancelled() )
+                            {
+                                fetch_cancel->store( true );
+                                throw std::runtime_error( "new_game:loading cancelled" );
+                            }
                         }
-                        this->solution = auto_answer[0];
-                        this->operator_queues = { {} };
-                        this->operator_iterator = this->operator_queues.begin();
-                        this->select_cell = false;
-                        this->grid_x = 0;
-                        this->grid_y = 0;
-                        this->prev_time = 0;
-                        this->timer.reset();
-                        this->set_game_state( GameState::PLAYING );
-                        this->queue_draw();
-
-                        return false;
+                        puzzle = puzzle_future.get();
                     }
+                    catch( const std::exception& e )
+                    {
+                        if ( context.is_cancelled() )
+                            throw;
+                        g_log( "new_game" , G_LOG_LEVEL_MESSAGE , "%s" , e.what() );
+                        //back to using local puzzle play game
+                        puzzle.puzzle = get_local_puzzle( level );
+                        puzzle.has_solution = false;
+                    }
+                    context.report_progress( 0.5 );
 
-                    return true;
-                },
-                200
+                    //without server solution solved on first view
+                    LoadedGame loaded = { Sudoku( puzzle.puzzle , level ) , puzzle_t() };
+                    if ( puzzle.has_solution )
+                    {
+                        //server solution already validated,don't solve again
+                        loaded.solution = puzzle.solution;
+                        solution_cache.insert( puzzle.puzzle , puzzle.solution );
+                    }
+                    return loaded;
+                }
             );
         }
 
-        //local generate puzzle
-        void new_game()
+        //local generate puzzle graded at level
+        void new_game_generated( SUDOKU_LEVEL level )
         {
-            try
-            {
-                this->game = Sudoku();
-            }
-            catch( const std::exception& e )
-            {
-                g_log( __func__ , G_LOG_LEVEL_MESSAGE , e.what() );
-                //rollback to old game
-                this->set_game_state( SudokuBoard::GameState::PLAYING );
-                return ;
-            }
-            auto auto_answer = game.get_solution( false );
-            if ( auto_answer.empty() )
-            {
-                //back to empty puzzle
-                this->game = Sudoku();
-                auto_answer = game.get_solution( false );
-                return ;
-            }
-            this->solution = auto_answer[0];
-            this->operator_queues = { {} };
-            this->operator_iterator = this->operator_queues.begin();
-            this->select_cell = false;
-            this->grid_x = 0;
-            this->grid_y = 0;
-            this->prev_time = 0;
-            this->timer.reset();
-            this->set_game_state( GameState::PLAYING );
-            this->queue_draw();
+            this->load_game(
+                [ level ]( TaskContext& context ) -> LoadedGame
+                {
+                    GeneratorOptions options;
+                    options.level = level;
+                    options.limits = SolveLimits::with_timeout( GENERATE_TIME_LIMIT , context.get_cancel_flag() );
+                    GeneratorStats stats;
+                    std::vector<GeneratedPuzzle> generated = generate_puzzles( options , &stats );
+                    if ( context.is_cancelled() )
+                        throw std::runtime_error( "new_game_generated:loading cancelled" );
+                    g_log( "new_game_generated" , G_LOG_LEVEL_DEBUG , "%s:%llu grids,%llu mutations,%.3fs" ,
+                           level_to_string( level ).c_str() , static_cast<unsigned long long>( stats.grids ) ,
+                           static_cast<unsigned long long>( stats.mutations ) , stats.seconds );
+                    if ( generated.empty() )
+                        throw std::runtime_error( "new_game_generated:no " + level_to_string( level ) + " puzzle within the time limit" );
+                    context.report_progress( 0.5 );
+                    solution_cache.insert( generated[0].puzzle , generated[0].solution );
+                    return { Sudoku( generated[0].puzzle , generated[0].level ) , generated[0].solution };
+                }
+            );
         }
 
-        void new_game( Glib::ustring puzzle_string )
+        void auto_update_candidate( bool flags )
         {
-            try
-            {
-                Sudoku new_sudoku( string_to_puzzle( puzzle_string ) );
-                this->game = new_sudoku;
-            }
-            catch( const std::exception& e )
-            {
-                g_log( __func__ , G_LOG_LEVEL_MESSAGE , e.what() );
+            if ( this->replay_active )
                 return ;
-            }
-            this->solution = game.get_solution(false)[0];
-            this->operator_queues = { {} };
-            this->operator_iterator = this->operator_queues.begin();
-            this->select_cell = false;
-            this->grid_x = 0;
-            this->grid_y = 0;
-            this->prev_time = 0;
-            this->timer.reset();
-            this->set_game_state( GameState::PLAYING );
-            this->queue_draw();
+            this->set_autoupdate( flags );
         }
 
-        void auto_update_candidate( bool flags )
+        GameState get_game_state( void )
         {
-            this->game.autoupdate_candidate( flags );
+            return this->state;
         }
 
-        GameState get_game_state( void )
+        //performance hud over the board,refreshed while shown so background numbers stay live
+        void set_show_metrics( bool flags )
         {
-            return this->state;
+            this->show_metrics = flags;
+            this->metrics_refresh.disconnect();
+            this->frame_times.clear();
+            if ( flags )
+            {
+                this->metrics_refresh = Glib::signal_timeout().connect(
+                    [ this ]() -> bool
+                    {
+                        this->queue_draw();
+                        return true;
+                    } ,
+                    METRICS_REFRESH_MS
+                );
+            }
+            this->queue_draw();
         }
         
         void set_game_state( GameState state )
@@ -290,15 +357,32 @@ class SudokuBoard : public Gtk::DrawingArea
                 this->prev_time += this->timer.elapsed();
                 this->timer.start();
             }
-            else if ( state == GameState::PAUSE )
+            else if ( ( state == GameState::PAUSE ) || ( state == GameState::COMPLETED ) )
             {
                 this->timer.stop();
+                if ( this->journal )
+                    this->journal->append( { this->get_journal_time() , 0 , JournalRecordType::TIME_RECORD , 0 } );
             }
 
             this->state = state;
             this->queue_draw();
         }
 
+        //solution of the current game,solved off the gtk thread through the memoized cache.
+        //on_ready( found ) run on the gtk thread:at once when known,else when the solve end.
+        //a newer request replace the pending one,a new game answer it false
+        void prepare_solution( std::function<void( bool )> on_ready )
+        {
+            if ( this->solution != puzzle_t() )
+            {
+                on_ready( true );
+                return ;
+            }
+            this->solution_ready = std::move( on_ready );
+            if ( this->solving == false )
+                this->start_solve();
+        }
+
         std::uint32_t get_play_time( void )
         {
             return this->prev_time + this->timer.elapsed();
@@ -314,130 +398,117 @@ class SudokuBoard : public Gtk::DrawingArea
             this->fill_mode = mode;
         }
 
+        //user input is ignored while a replay is playing
         void do_fill( cell_t value )
         {
-            if ( this->select_cell == false )
+            if ( this->replay_active )
                 return ;
-            if ( this->state != GameState::PLAYING )
+            this->fill_cell( value , this->fill_mode );
+        }
+
+        void undo_fill( void )
+        {
+            if ( this->replay_active )
                 return ;
+            this->step_history( ReplayEventType::UNDO );
+        }
 
-            //keep undo operator sentinel element
-            this->operator_queues.resize( this->operator_iterator - this->operator_queues.begin() + 1 );
+        void redo_fill( void )
+        {
+            if ( this->replay_active )
+                return ;
+            this->step_history( ReplayEventType::REDO );
+        }
 
-            switch ( this->fill_mode )
+        //input events of the current game
+        void save_replay( const std::string& filename )
+        {
+            try
             {
-                case FillMode::ANSWER:
-                {
-                    try
-                    {
-                        cell_t old_value = this->puzzle[this->grid_x][this->grid_y];
-                        if ( value == old_value )
-                        {
-                            this->game.erase_answer( this->grid_x , this->grid_y );
-                            this->operator_queues.push_back( { OperatorType::ERASE_ANSWER , { this->grid_x , this->grid_y , value } } );
-                        }
-                        else
-                        {
-                            this->game.fill_answer( this->grid_x , this->grid_y , value );
-                            this->operator_queues.push_back( { OperatorType::FILL_ANSWER , { this->grid_x , this->grid_y , value } } );
-                        }
-                    }
-                    catch( const std::exception& e )
-                    {
-                        g_log( __func__ , G_LOG_LEVEL_MESSAGE , "%s" , e.what() );
-                    }
-                    break;
-                }
-                case FillMode::CANDIDATE:
-                {
-                    auto const & candidates = this->game.get_candidates()[this->grid_x][this->grid_y];
-                    if ( std::find( candidates.begin() , candidates.end() , value ) == candidates.end() )
-                    {
-                        this->game.fill_candidates( this->grid_x , this->grid_y , { value } );
-                        this->operator_queues.push_back( { OperatorType::FILL_CANDIDATE , { this->grid_x , this->grid_y , value } } );
-                    }
-                    else
-                    {
-                        this->game.erase_candidates( this->grid_x , this->grid_y , { value } );
-                        this->operator_queues.push_back( { OperatorType::ERASE_CANDIDATE , { this->grid_x , this->grid_y , value } } );
-                    }
-                    break;
-                }
-                default:
-                    break;
+                ::save_replay( filename , this->recorder.get_stream() );
             }
+            catch( const std::exception& e )
+            {
+                g_log( __func__ , G_LOG_LEVEL_WARNING , "%s" , e.what() );
+            }
+        }
 
-            this->operator_iterator++;
-            this->queue_draw();
+        //bulk import in background:parse,validate,uniqueness check and grade,valid puzzles queued.
+        //the first one start when nothing was queued
+        void import_text( Glib::ustring text )
+        {
+            std::string raw( text.raw() );
+            this->start_import(
+                [ raw ]() -> std::string
+                {
+                    return raw;
+                } ,
+                "clipboard"
+            );
         }
 
-        void undo_fill( void )
+        void import_file( const std::string& filename )
         {
-            if ( this->operator_queues.begin() == this->operator_iterator )
-                return ;
-            auto operator_queue = *( this->operator_iterator );
-            switch ( operator_queue.first )
-            {
-                case OperatorType::FILL_ANSWER:
+            this->start_import(
+                [ filename ]() -> std::string
                 {
-                    if ( operator_queue.second.value != 0 )
-                        this->game.erase_answer( operator_queue.second.x , operator_queue.second.y );
-                    else
-                        this->game.fill_answer( operator_queue.second.x , operator_queue.second.y , operator_queue.second.value );
-                    break;
-                }
-                case OperatorType::FILL_CANDIDATE:
-                    this->game.erase_candidates( operator_queue.second.x , operator_queue.second.y , { operator_queue.second.value } );
-                    break;
-                case OperatorType::ERASE_ANSWER:
-                    this->game.fill_answer( operator_queue.second.x , operator_queue.second.y , operator_queue.second.value );
-                    break;
-                case OperatorType::ERASE_CANDIDATE:
-                    this->game.fill_candidates( operator_queue.second.x , operator_queue.second.y , { operator_queue.second.value } );
-                    break;
-                default:
-                    break;
-            }
-            
-            this->operator_iterator--;
-            this->queue_draw();
+                    std::ifstream import_file( filename , std::ios::binary );
+                    if ( !import_file )
+                        throw std::runtime_error( "import_file:can't open '" + filename + "'" );
+                    return std::string( ( std::istreambuf_iterator<char>( import_file ) ) , std::istreambuf_iterator<char>() );
+                } ,
+                filename
+            );
         }
 
-        void redo_fill( void )
+        //play the next queued puzzle,false if the playlist is empty
+        bool next_puzzle( void )
         {
-            if ( this->operator_queues.end() == this->operator_iterator )
-                return ;
-            this->operator_iterator++;
-            if ( this->operator_queues.end() == this->operator_iterator )
+            if ( this->playlist.empty() )
+                return false;
+            ImportedPuzzle imported = this->playlist.front();
+            this->playlist.pop_front();
+            LoadedGame loaded = { Sudoku( imported.puzzle , imported.level ) , imported.solution };
+            this->stop_replay();
+            this->loading_task.cancel();
+            this->start_game( loaded );
+            return true;
+        }
+
+        std::size_t get_playlist_size( void ) const noexcept( true )
+        {
+            return this->playlist.size();
+        }
+
+        //[ 0.0 , 1.0 ] while an import is running,else negative
+        double get_import_progress( void ) const noexcept( true )
+        {
+            return this->import_progress;
+        }
+
+        //restart the recorded game and feed its events through the board,
+        //speed 1 is real time,larger is accelerated,0 apply all at once
+        void play_replay( const std::string& filename , double speed )
+        {
+            try
             {
-                this->operator_iterator--;
-                return ;
+                ReplayStream stream = load_replay( filename );
+                LoadedGame loaded = { make_replay_game( stream.header ) , puzzle_t() };
+
+                this->stop_replay();
+                this->loading_task.cancel();
+                this->start_game( loaded );
+                this->replay_events = std::move( stream.events );
+                this->replay_position = 0;
+                this->replay_speed = speed;
+                this->replay_begin = std::chrono::steady_clock::now();
+                this->replay_active = true;
+                this->schedule_replay();
             }
-            auto operator_queue = *( this->operator_iterator );
-            switch ( operator_queue.first )
+            catch( const std::exception& e )
             {
-                case OperatorType::FILL_ANSWER:
-                {
-                    if ( operator_queue.second.value != 0 )
-                        this->game.fill_answer( operator_queue.second.x , operator_queue.second.y , operator_queue.second.value );
-                    else
-                        this->game.erase_answer( operator_queue.second.x , operator_queue.second.y );
-                    break;
-                }
-                case OperatorType::FILL_CANDIDATE:
-                    this->game.fill_candidates( operator_queue.second.x , operator_queue.second.y , { operator_queue.second.value } );
-                    break;
-                case OperatorType::ERASE_ANSWER:
-                    this->game.erase_answer( operator_queue.second.x , operator_queue.second.y );
-                    break;
-                case OperatorType::ERASE_CANDIDATE:
-                    this->game.erase_candidates( operator_queue.second.x , operator_queue.second.y , { operator_queue.second.value } );
-                    break;
-                default:
-                    break;
+                g_log( __func__ , G_LOG_LEVEL_WARNING , "%s" , e.what() );
             }
-
-            this->queue_draw();
         }
 
         Glib::ustring dump_play_time( void )
@@ -463,9 +534,47 @@ class SudokuBoard : public Gtk::DrawingArea
             return ( ( this->puzzle[grid_x][grid_y] == 0 ) || ( this->game.is_answer( grid_x , grid_y ) ) );
         }
 
+        //the board as played,conflicting digits included
         Glib::ustring dump_sudoku( void )
         {
-            return puzzle_to_string( this->puzzle );
+            return grid_to_string( this->puzzle );
+        }
+
+        //count corpus puzzles of current level,rendered off the gtk thread
+        void export_booklet( std::string filename , std::size_t count , bool answer_pages )
+        {
+            BookletOptions options;
+            options.answer_pages = answer_pages;
+            options.theme = current_theme;
+            Glib::ustring extension_string = std::filesystem::path( filename ).extension().string();
+            if ( extension_string.lowercase() == ".png" )
+                options.format = BookletFormat::PNG;
+            SUDOKU_LEVEL level = this->game.get_puzzle_level();
+
+            this->executor.submit<std::size_t>(
+                [ filename , count , options , level ]( TaskContext& context ) -> std::size_t
+                {
+                    auto entries = collect_booklet_puzzles( BookletSource::CORPUS , level , count , options.answer_pages ,
+                                                            options.worker_number , context.get_cancel_flag() );
+                    return ::export_booklet( entries , filename , options , context.get_cancel_flag() );
+                } ,
+                [ filename ]( std::size_t& pages )
+                {
+                    g_log( "export_booklet" , G_LOG_LEVEL_MESSAGE , "%zu pages written to '%s'" , pages , filename.c_str() );
+                } ,
+                [ filename ]( std::exception_ptr error )
+                {
+                    try
+                    {
+                        std::rethrow_exception( error );
+                    }
+                    catch( const std::exception& e )
+                    {
+                        g_log( "export_booklet" , G_LOG_LEVEL_WARNING , "writing booklet:'%s' failure,exception message:'%s'" ,
+                               filename.c_str() , e.what() );
+                    }
+                }
+            );
         }
 
         void print_puzzle( Glib::ustring filename = "puzzle.png" ,  PrintType type = PrintType::PNG )
@@ -500,11 +609,8 @@ class SudokuBoard : public Gtk::DrawingArea
             }
 
             auto cairo_context = Cairo::Context::create( surface );
-            this->draw_background_color( cairo_context );
-            this->draw_index( cairo_context );
-            this->draw_board_box( cairo_context );
-            this->draw_board_line( cairo_context );
-            this->draw_puzzle( cairo_context , this->puzzle );
+            this->renderer.set_theme( current_theme );
+            this->renderer.draw_print( cairo_context , this->puzzle );
 
             //write file may throw exception,but does not affect other functions.
             //so just output warning and return.
@@ -532,10 +638,11 @@ class SudokuBoard : public Gtk::DrawingArea
     protected:
         bool on_draw( const Cairo::RefPtr<Cairo::Context> & cairo_context ) override
         {
-            cairo_context->save();
-            cairo_context->set_line_join( Cairo::LINE_JOIN_MITER );
-
-            this->draw_background_color( cairo_context );
+            SUDOKU_TRACE_SCOPE( "SudokuBoard::on_draw" );
+            static MetricHistogram& draw_us = metrics().histogram( "board.draw_us" );
+            MetricTimer draw_timer( draw_us );
+            this->renderer.set_theme( current_theme );
+            this->renderer.set_device_scale( this->get_scale_factor() );
 
             auto state_to_string = [ this ]() -> std::string
             {
@@ -544,7 +651,12 @@ class SudokuBoard : public Gtk::DrawingArea
                     case GameState::PAUSE:
                         return std::string( "game pause,disable board view" );
                     case GameState::LOADING_NEW_GAME:
-                        return std::string( "loading puzzle,not available board view" );
+                    {
+                        std::string loading_string( "loading puzzle,not available board view" );
+                        if ( this->loading_progress > 0.0 )
+                            loading_string += " " + std::to_string( static_cast<int>( this->loading_progress*100 ) ) + "%";
+                        return loading_string;
+                    }
                     //playing,view solution don't need to string
                     default:
                         return std::string( "unknow state" );
@@ -552,297 +664,629 @@ class SudokuBoard : public Gtk::DrawingArea
             };
             if ( ( this->state == GameState::PAUSE ) || ( this->state == GameState::LOADING_NEW_GAME ) )
             {
-                set_rgba( cairo_context , PUZZLE_NUMBER_RGBA );
-                this->layout->set_text( state_to_string() );
-                int layout_width = 0 , layout_height = 0;
-                this->layout->get_pixel_size( layout_width , layout_height );
-                cairo_context->move_to( this->board_size/2 - layout_width/2 , this->board_size/2 - layout_height/2 );
-                this->layout->show_in_cairo_context( cairo_context );
-                cairo_context->restore();
+                this->renderer.draw_message( cairo_context , state_to_string() );
+                this->draw_metrics( cairo_context );
                 return true;
             }
 
-            this->draw_index( cairo_context );
-            this->draw_board_box( cairo_context );
-
-            //draw select highlight
-            if ( this->select_cell )
+            BoardView view;
+            view.select_cell = this->select_cell;
+            view.select_x = this->grid_x;
+            view.select_y = this->grid_y;
+            if ( this->state == GameState::VIEW_SOLUTION )
             {
-                cell_t column_id = this->grid_x;
-                cell_t row_id = this->grid_y;
-                cell_t box_id = ( this->grid_x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + this->grid_y/SUDOKU_BOX_SIZE;
-
-                set_rgba( cairo_context , SELECT_ROW_RGBA );
-                cairo_context->rectangle( this->row_index_size + this->line_size + row_id*( this->grid_size ) , this->column_index_size + this->line_size , 
-                                ( this->grid_size ) - this->line_size , SUDOKU_SIZE*( this->grid_size ) - 2*this->line_size );
-                cairo_context->stroke_preserve();
-                cairo_context->fill();
-
-                cairo_context->rectangle( this->row_index_size + this->line_size , this->column_index_size + this->line_size + column_id*( this->grid_size ) , 
-                                SUDOKU_SIZE*( this->grid_size ) - 2*this->line_size , ( this->grid_size ) - 2*this->line_size );
-                cairo_context->stroke_preserve();
-                cairo_context->fill();
-
-                cairo_context->rectangle( this->row_index_size + this->line_size + box_id%SUDOKU_BOX_SIZE*SUDOKU_BOX_SIZE*( this->grid_size ) , 
-                                this->column_index_size + this->line_size + box_id/SUDOKU_BOX_SIZE*SUDOKU_BOX_SIZE*( this->grid_size ) , 
-                                SUDOKU_BOX_SIZE*( this->grid_size ) - 2*this->line_size , SUDOKU_BOX_SIZE*( this->grid_size ) - 2*this->line_size );
-                cairo_context->stroke_preserve();
-                cairo_context->fill();
-
-                set_rgba( cairo_context , SELECT_CELL_RGBA );
-                cairo_context->rectangle( this->column_index_size + this->line_size + row_id*( this->grid_size ) , 
-                                    this->row_index_size + this->line_size + column_id*( this->grid_size ) ,
-                                    ( this->grid_size ) - 2*this->line_size , ( this->grid_size ) - 2*this->line_size );
-                cairo_context->stroke_preserve();
-                cairo_context->fill();
+                view.puzzle = &( this->solution );
+                view.highlight_number = false;
             }
-
-            this->draw_board_line( cairo_context );
-
-            if ( this->state == GameState::VIEW_SOLUTION )
+            else
             {
-                this->draw_puzzle( cairo_context , this->solution );
-                //restore on_draw save
-                cairo_context->restore();
-                return true;
+                view.puzzle = &( this->puzzle );
+                view.candidates = &( this->candidates );
+                view.conflicts = this->game.get_conflicts();
+                for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+                {
+                    for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+                    {
+                        if ( this->puzzle[i][j] != 0 )
+                            view.answers[ i*SUDOKU_SIZE + j ] = this->game.is_answer( i , j );
+                    }
+                }
             }
+            this->renderer.draw_frame( cairo_context , this->get_allocated_width() , this->get_allocated_height() , view );
+            this->draw_metrics( cairo_context );
+            return true;
+        }
+
+        //hud show the previous frame draw time,the current one is still running
+        void draw_metrics( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+        {
+            if ( this->show_metrics == false )
+                return ;
+            auto now = std::chrono::steady_clock::now();
+            this->frame_times.push_back( now );
+            while ( now - this->frame_times.front() > std::chrono::seconds( 1 ) )
+                this->frame_times.pop_front();
 
-            //draw puzzle
-            this->layout->set_font_description( solutions_font );
-            //auto size = this->solutions_font.get_size()/Pango::SCALE;
-            for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+            MetricsRegistry& registry = metrics();
+            auto to_ms = []( std::uint64_t value_us ) -> double
             {
-                for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+                return value_us/1000.0;
+            };
+            std::uint64_t hits = registry.counter( "solution_cache.hits" ).get();
+            std::uint64_t lookups = hits + registry.counter( "solution_cache.misses" ).get();
+            char line[128];
+            std::vector<std::string> lines;
+            std::snprintf( line , sizeof( line ) , "draw %.2f ms  %zu fps" ,
+                           to_ms( registry.histogram( "board.draw_us" ).get_last() ) , this->frame_times.size() );
+            lines.push_back( line );
+            std::snprintf( line , sizeof( line ) , "solve %.2f ms  generate %.2f ms" ,
+                           to_ms( registry.histogram( "solver.solve_us" ).get_last() ) ,
+                           to_ms( registry.histogram( "generator.generate_us" ).get_last() ) );
+            lines.push_back( line );
+            if ( lookups == 0 )
+                std::snprintf( line , sizeof( line ) , "solution cache -" );
+            else
+                std::snprintf( line , sizeof( line ) , "solution cache %.0f%% of %llu" , hits*100.0/lookups ,
+                               static_cast<unsigned long long>( lookups ) );
+            lines.push_back( line );
+            std::snprintf( line , sizeof( line ) , "pool queued %lld  running %lld" ,
+                           static_cast<long long>( registry.gauge( "executor.queued" ).get() ) ,
+                           static_cast<long long>( registry.gauge( "executor.running" ).get() ) );
+            lines.push_back( line );
+            std::snprintf( line , sizeof( line ) , "fetch pending %lld" , static_cast<long long>( registry.gauge( "fetch.pending" ).get() ) );
+            lines.push_back( line );
+            this->renderer.draw_overlay( cairo_context , lines );
+        }
+
+        bool on_button_press_event( GdkEventButton * event ) override
+        {
+            //other game state disable button event
+            if ( ( this->state != GameState::PLAYING ) && ( this->state != GameState::VIEW_SOLUTION ) )
+                return false;
+            //ignore double-clicked and three-clicked(left and mid button)
+            if ( event->type == GdkEventType::GDK_2BUTTON_PRESS )
+                return false;
+            if ( event->type == GdkEventType::GDK_3BUTTON_PRESS )
+                return false;
+            if ( ( event->x < this->column_index_size ) || ( event->x > this->column_index_size + 9*( this->grid_size ) ) )
+                return false;
+            if ( ( event->y < this->row_index_size ) || ( event->y > this->row_index_size + 9*( this->grid_size ) ) )
+                return false;
+            std::size_t x = event->x;
+            std::size_t y = event->y;
+            cell_t grid_x = ( y - this->row_index_size )/this->grid_size;
+            cell_t grid_y = ( x - this->column_index_size )/this->grid_size;
+            if ( this->replay_active )
+                return false;
+            this->select( grid_x , grid_y );
+
+            return false;
+        }
+
+    private:
+        //game inteface
+        Sudoku game;
+        const puzzle_t& puzzle;
+        const candidate_t& candidates;
+        puzzle_t solution;
+
+        //ui desc
+        BoardRenderer renderer;
+        std::size_t bold_line_size;
+        std::size_t row_index_size;
+        std::size_t column_index_size;
+        std::size_t grid_size;
+        std::size_t board_size;
+
+        //game status
+        FillMode fill_mode = FillMode::ANSWER;
+        bool select_cell = false;
+        cell_t grid_x = 0;
+        cell_t grid_y = 0;
+        //digit of the selected cell at last damage,for redraw its old highlight
+        cell_t highlight_number = 0;
+
+        GameState state;
+        Glib::Timer timer;
+        //Glib::Timer::stop() -> Glib::Timer::start() reset the timer,not exist Glib::Timer::resume()
+        //save prev timer time to support resume
+        double prev_time = 0;
+
+        //undo/redo steps of the current game
+        GameHistory history;
+        //input events of the current game
+        ReplayRecorder recorder;
+        //replay playback state
+        bool replay_active = false;
+        std::vector<ReplayEvent> replay_events;
+        std::size_t replay_position = 0;
+        double replay_speed = 1.0;
+        std::chrono::steady_clock::time_point replay_begin;
+        sigc::connection replay_timeout;
+        //performance hud state,frame_times:draws in the last second for fps
+        bool show_metrics = false;
+        std::deque<std::chrono::steady_clock::time_point> frame_times;
+        sigc::connection metrics_refresh;
+        //crash-safe record of the current game,nullptr if the journal file is unavailable
+        std::unique_ptr<SessionJournal> journal;
+        //record number of the last journal rewrite
+        std::size_t journal_compact_size = 0;
+
+        //heavy game loading( fetch,generate ) result,computed in executor worker
+        struct LoadedGame
+        {
+            Sudoku game;
+            //all zero:unknown,solved in background once the game start
+            puzzle_t solution;
+        };
+        TaskHandle loading_task;
+        double loading_progress = 0.0;
+        //background solve of the current game,started with the game when its solution is unknown
+        TaskHandle solve_task;
+        bool solving = false;
+        std::function<void( bool )> solution_ready;
+        //imported puzzles waiting to be played,front is next
+        std::deque<ImportedPuzzle> playlist;
+        TaskHandle import_task;
+        double import_progress = -1.0;
+        //keep last member:destroyed first,stop workers before other member gone
+        TaskExecutor executor;
+
+        void start_import( std::function<std::string( void )> read_text , std::string source )
+        {
+            //newer import replace the older one,puzzles already queued stay
+            this->import_task.cancel();
+            this->import_progress = 0.0;
+            this->import_task = this->executor.submit<ImportReport>(
+                [ read_text = std::move( read_text ) ]( TaskContext& context ) -> ImportReport
                 {
-                    cell_t number = this->puzzle[i][j];
-                    if ( number != 0 )
-                    {
-                        if ( this->select_cell && number == this->puzzle[this->grid_x][this->grid_y] )
+                    return ::import_puzzles( read_text() , 0 , context.get_cancel_flag() ,
+                        [ &context ]( double progress )
                         {
-                            set_rgba( cairo_context , SELECT_NUMBER_RGBA );
+                            context.report_progress( progress );
                         }
-                        else if ( this->game.is_answer( i , j ) )
-                        {
-                            set_rgba( cairo_context , ANSWER_NUMBER_RGBA );
-                        }
-                        else
-                        {
-                            set_rgba( cairo_context , PUZZLE_NUMBER_RGBA );
-                        }
-                        this->layout->set_text( std::to_string( number ) );
-                        int layout_width , layout_height;
-                        this->layout->get_pixel_size( layout_width , layout_height );
-                        cairo_context->move_to( this->row_index_size + j*( this->grid_size ) + ( this->grid_size )/2 - layout_width/2
-                                                , this->column_index_size + i*( this->grid_size ) + ( this->grid_size )/2 - layout_height/2 );
-                        this->layout->show_in_cairo_context( cairo_context );
+                    );
+                } ,
+                [ this , source ]( ImportReport& report )
+                {
+                    this->import_progress = -1.0;
+                    g_log( "import_puzzles" , G_LOG_LEVEL_MESSAGE ,
+                           "%s:%zu parsed,%zu queued,%zu illegal,%zu without solution,%zu with multiple solutions,%zu undecided" ,
+                           source.c_str() , report.parsed , report.puzzles.size() , report.illegal ,
+                           report.no_solution , report.multiple_solutions , report.unfinished );
+                    bool start = this->playlist.empty();
+                    for ( auto& imported : report.puzzles )
+                    {
+                        solution_cache.insert( imported.puzzle , imported.solution );
+                        this->playlist.push_back( imported );
+                    }
+                    if ( start )
+                        this->next_puzzle();
+                } ,
+                [ this , source ]( std::exception_ptr error )
+                {
+                    this->import_progress = -1.0;
+                    try
+                    {
+                        std::rethrow_exception( error );
+                    }
+                    catch( const std::exception& e )
+                    {
+                        g_log( "import_puzzles" , G_LOG_LEVEL_WARNING , "%s:%s" , source.c_str() , e.what() );
+                    }
+                } ,
+                [ this ]( double progress )
+                {
+                    this->import_progress = progress;
+                }
+            );
+        }
+
+        void start_solve( void )
+        {
+            this->solving = true;
+            puzzle_t clues = this->game.get_clues();
+            this->solve_task = this->executor.submit<puzzle_t>(
+                [ clues ]( TaskContext& context ) -> puzzle_t
+                {
+                    SUDOKU_TRACE_SCOPE( "SudokuBoard::solve" );
+                    puzzle_t found;
+                    SolveStatus status = solution_cache.solve( clues , found , SolveLimits::with_timeout( SOLVE_TIME_LIMIT , context.get_cancel_flag() ) );
+                    g_log( "SudokuBoard" , G_LOG_LEVEL_DEBUG , "solution cache hit %llu miss %llu" ,
+                           static_cast<unsigned long long>( solution_cache.get_hit_count() ) ,
+                           static_cast<unsigned long long>( solution_cache.get_miss_count() ) );
+                    if ( found == puzzle_t() )
+                    {
+                        g_log( "SudokuBoard" , G_LOG_LEVEL_MESSAGE , "puzzle not solved:%s" ,
+                               ( status == SolveStatus::COMPLETE ) ? "not exist solution" : solve_status_to_string( status ) );
+                    }
+                    return found;
+                } ,
+                [ this ]( puzzle_t& found )
+                {
+                    if ( found != puzzle_t() )
+                    {
+                        this->solution = found;
+                        this->game.set_solution( this->solution );
+                    }
+                    this->finish_solve( found != puzzle_t() );
+                } ,
+                [ this ]( std::exception_ptr )
+                {
+                    this->finish_solve( false );
+                }
+            );
+        }
+
+        void finish_solve( bool found )
+        {
+            this->solving = false;
+            std::function<void( bool )> on_ready;
+            on_ready.swap( this->solution_ready );
+            if ( on_ready )
+                on_ready( found );
+        }
+
+        //the running solve and a pending solution view belong to the old game
+        void restart_solve( void )
+        {
+            this->solve_task.cancel();
+            this->finish_solve( false );
+            if ( this->solution == puzzle_t() )
+                this->start_solve();
+        }
+
+        void load_game( std::function<LoadedGame( TaskContext& )> work )
+        {
+            this->stop_replay();
+            //newer request replace the older one
+            this->loading_task.cancel();
+            this->loading_progress = 0.0;
+            this->set_game_state( GameState::LOADING_NEW_GAME );
+            this->loading_task = this->executor.submit<LoadedGame>(
+                [ work = std::move( work ) ]( TaskContext& context ) -> LoadedGame
+                {
+                    SUDOKU_TRACE_SCOPE( "SudokuBoard::load_game" );
+                    return work( context );
+                } ,
+                [ this ]( LoadedGame& loaded )
+                {
+                    this->start_game( loaded );
+                } ,
+                [ this ]( std::exception_ptr error )
+                {
+                    try
+                    {
+                        std::rethrow_exception( error );
+                    }
+                    catch( const std::exception& e )
+                    {
+                        g_log( "load_game" , G_LOG_LEVEL_MESSAGE , "%s" , e.what() );
                     }
+                    //rollback to old game
+                    this->set_game_state( GameState::PLAYING );
+                    this->check_completed();
+                } ,
+                [ this ]( double progress )
+                {
+                    this->loading_progress = progress;
+                    this->queue_draw();
                 }
+            );
+        }
+
+        void start_game( LoadedGame& loaded )
+        {
+            SUDOKU_TRACE_SCOPE( "SudokuBoard::start_game" );
+            startup_report.mark( "first puzzle ready" );
+            this->game = std::move( loaded.game );
+            this->solution = loaded.solution;
+            //duplicate digits shown in conflict color instead of rejected
+            this->game.allow_conflict( true );
+            this->game.set_solution( this->solution );
+            this->history.reset();
+            this->select_cell = false;
+            this->grid_x = 0;
+            this->grid_y = 0;
+            this->highlight_number = 0;
+            this->prev_time = 0;
+            this->timer.reset();
+            if ( this->journal )
+            {
+                this->journal->start( { this->game.get_puzzle_level() , this->game.get_state() , this->solution , 0 } );
+                this->journal_compact_size = 0;
+            }
+            this->recorder.begin( { this->game.get_puzzle_level() , this->game.is_autoupdate_candidate() , this->game.get_state() } );
+            //whole board changed,set_game_state redraw all
+            this->set_game_state( GameState::PLAYING );
+            this->restart_solve();
+        }
+
+        //restore game,play time and history from the journal of last run
+        bool resume_game( void )
+        {
+            JournalHeader header;
+            std::vector<JournalRecord> records;
+            if ( ( this->journal == nullptr ) || ( read_journal( this->journal->get_path() , header , records ) == false ) )
+                return false;
+            try
+            {
+                std::uint32_t play_time_ms = 0;
+                replay_journal( header , records , this->game , this->history , play_time_ms );
+                this->solution = header.solution;
+                this->game.allow_conflict( true );
+                this->game.set_solution( this->solution );
+                this->prev_time = play_time_ms/1000.0;
+                this->timer.reset();
             }
-
-            //draw candiates
-            set_rgba( cairo_context , PUZZLE_NUMBER_RGBA );
-            this->layout->set_font_description( candidate_font );
-            for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+            catch( const std::exception& e )
             {
-                for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
-                {
-                    auto number = puzzle[i][j];
-                    if ( number == 0 )
-                    {
-                        for ( cell_t k = 0 ; k < SUDOKU_SIZE ; k++ )
-                        {
-                            if ( std::find( this->candidates[i][j].begin() , this->candidates[i][j].end() , k + 1 ) != this->candidates[i][j].end() )
-                            {
-                                this->layout->set_text( std::to_string( k + 1 ) );
-                                cairo_context->move_to( this->row_index_size + j*( this->grid_size ) + ( this->font_size )/2 + k%SUDOKU_BOX_SIZE*2*( this->font_size )
-                                            , this->column_index_size + i*( this->grid_size ) + k/SUDOKU_BOX_SIZE*2*( this->font_size ) );
-                                this->layout->show_in_cairo_context( cairo_context );
-                            }
-                        }
-                    }
-                }
+                g_log( "resume_game" , G_LOG_LEVEL_MESSAGE , "%s" , e.what() );
+                this->game = Sudoku( puzzle_t() );
+                this->history.reset();
+                return false;
             }
-
-            cairo_context->restore();
+            startup_report.mark( "session resumed" );
+            this->recorder.begin( { this->game.get_puzzle_level() , this->game.is_autoupdate_candidate() , this->game.get_state() } );
+            //drop undone branches and time records of last run
+            this->compact_journal();
+            this->set_game_state( GameState::PLAYING );
+            this->check_completed();
+            this->restart_solve();
             return true;
         }
 
-        bool on_button_press_event( GdkEventButton * event ) override
+        void select( cell_t x , cell_t y )
         {
-            //other game state disable button event
-            if ( ( this->state != GameState::PLAYING ) && ( this->state != GameState::VIEW_SOLUTION ) )
-                return false;
-            //ignore double-clicked and three-clicked(left and mid button)
-            if ( event->type == GdkEventType::GDK_2BUTTON_PRESS )
-                return false;
-            if ( event->type == GdkEventType::GDK_3BUTTON_PRESS )
-                return false;
-            if ( ( event->x < this->column_index_size ) || ( event->x > this->column_index_size + 9*( this->grid_size ) ) )
-                return false;
-            if ( ( event->y < this->row_index_size ) || ( event->y > this->row_index_size + 9*( this->grid_size ) ) )
-                return false;
-            std::size_t x = event->x;
-            std::size_t y = event->y;
-            this->grid_x = ( y - this->row_index_size )/this->grid_size;
-            this->grid_y = ( x - this->column_index_size )/this->grid_size;
-            this->select_cell = true;
-            this->queue_draw();
+            if ( this->select_cell && ( x == this->grid_x ) && ( y == this->grid_y ) )
+                return ;
+            this->recorder.record( ReplayEventType::SELECT , x , y );
 
-            return false;
+            //old and new highlight
+            if ( this->select_cell )
+                this->queue_draw_selection();
+            this->grid_x = x;
+            this->grid_y = y;
+            this->select_cell = true;
+            this->highlight_number = this->puzzle[x][y];
+            this->queue_draw_selection();
         }
 
-    private:
-        //game inteface
-        Sudoku game;
-        const puzzle_t& puzzle;
-        const candidate_t& candidates;
-        puzzle_t solution;
-
-        //ui desc
-        Pango::FontDescription candidate_font;
-        Pango::FontDescription solutions_font;
-        Glib::RefPtr<Pango::Layout> layout;
-        std::size_t bold_line_size;
-        std::size_t line_size;
-        std::size_t font_size;
-        std::size_t row_index_size;
-        std::size_t column_index_size;
-        std::size_t grid_size;
-        std::size_t board_size;
+        void set_autoupdate( bool flags )
+        {
+            //a toggle outside play is not a move.replay playback is recorded like every other event,
+            //so SaveReplay after PlayReplay write the played stream again
+            if ( this->state == GameState::PLAYING )
+                this->recorder.record( ReplayEventType::AUTOUPDATE , 0 , 0 , flags ? 1 : 0 );
+            this->game.autoupdate_candidate( flags );
+        }
 
-        //game status
-        FillMode fill_mode = FillMode::ANSWER;
-        bool select_cell = false;
-        cell_t grid_x = 0;
-        cell_t grid_y = 0;
+        void fill_cell( cell_t value , FillMode mode )
+        {
+            if ( this->select_cell == false )
+                return ;
+            if ( this->state != GameState::PLAYING )
+                return ;
 
-        GameState state;
-        Glib::Timer timer;
-        //Glib::Timer::stop() -> Glib::Timer::start() reset the timer,not exist Glib::Timer::resume()
-        //save prev timer time to support resume
-        double prev_time = 0;
+            cell_t x = this->grid_x;
+            cell_t y = this->grid_y;
+            bool candidate = ( mode == FillMode::CANDIDATE );
+            this->recorder.record( candidate ? ReplayEventType::FILL_CANDIDATE : ReplayEventType::FILL_ANSWER , x , y , value );
+            //fill and its autoupdate elimination undo as one step
+            try
+            {
+                SudokuStatus status = SudokuStatus::OK;
+                bool recorded = this->history.execute(
+                    [ x , y , value , candidate , &status ]( Sudoku& game )
+                    {
+                        status = toggle_fill( game , x , y , value , candidate );
+                    }
+                );
+                if ( status != SudokuStatus::OK )
+                    g_log( __func__ , G_LOG_LEVEL_MESSAGE , "cell:( %d , %d ) %s" , x , y , sudoku_status_to_string( status ) );
+                if ( recorded )
+                    this->journal_last_step();
+            }
+            catch( const std::exception& e )
+            {
+                g_log( __func__ , G_LOG_LEVEL_MESSAGE , "%s" , e.what() );
+                //history may hold a partial step,rewrite the journal from it
+                this->compact_journal();
+            }
+            this->check_completed();
+        }
 
-        enum class OperatorType:std::uint32_t
+        //O(1) counter check after every move
+        void check_completed( void )
         {
-            FILL_ANSWER = 0,
-            FILL_CANDIDATE,
-            ERASE_ANSWER,
-            ERASE_CANDIDATE
-        };
-        struct OperatorValue
+            if ( ( this->state != GameState::PLAYING ) || ( this->game.is_solved() == false ) )
+                return ;
+            this->set_game_state( GameState::COMPLETED );
+            g_log( "SudokuBoard" , G_LOG_LEVEL_MESSAGE , "puzzle solved in %s" , this->dump_play_time().c_str() );
+        }
+
+        //type:UNDO or REDO
+        void step_history( ReplayEventType type )
         {
-            cell_t x;
-            cell_t y;
-            cell_t value;
-        };
+            if ( this->state == GameState::COMPLETED )
+                return ;
+            this->recorder.record( type );
+            bool undo = ( type == ReplayEventType::UNDO );
+            if ( ( undo ? this->history.undo() : this->history.redo() ) && this->journal )
+                this->journal->append( { this->get_journal_time() , 0 ,
+                                         undo ? JournalRecordType::UNDO_RECORD : JournalRecordType::REDO_RECORD , 0 } );
+            this->check_completed();
+        }
 
-        typedef std::deque< std::pair< OperatorType , OperatorValue > > operator_t;
-        operator_t operator_queues;
-        operator_t::iterator operator_iterator;
+        void stop_replay( void )
+        {
+            this->replay_active = false;
+            this->replay_timeout.disconnect();
+            this->replay_events.clear();
+        }
 
-        void draw_background_color( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+        void schedule_replay( void )
         {
-            cairo_context->save();
-            //draw background color
-            set_rgba( cairo_context , BOARD_BACKGROUD_RGBA );
-            cairo_context->paint();
-            //cairo_context->rectangle( 0 , 0 , this->board_size , this->board_size );
-            //cairo_context->stroke_preserve();
-            //cairo_context->fill();
-            cairo_context->restore();
+            //events after completion( autoupdate toggles ) have nothing left to drive
+            if ( ( this->replay_position >= this->replay_events.size() ) || ( this->state == GameState::COMPLETED ) )
+            {
+                this->stop_replay();
+                return ;
+            }
+            std::int64_t due = ( this->replay_speed > 0 ) ? this->replay_events[this->replay_position].time_ms/this->replay_speed : 0;
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - this->replay_begin );
+            std::int64_t delay = std::max<std::int64_t>( 0 , due - elapsed.count() );
+            this->replay_timeout = Glib::signal_timeout().connect( sigc::mem_fun( *this , &SudokuBoard::on_replay_timeout ) , delay );
         }
 
-        void draw_index( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+        bool on_replay_timeout( void )
         {
-            cairo_context->save();
-            constexpr const char * row_indexs[] = 
+            if ( this->replay_active == false )
+                return false;
+            if ( this->state != GameState::PLAYING )
             {
-                "A" , "B" , "C" , "D" , "E" , "F" , "G" , "H" , "I"
-            };
-            constexpr const char * column_indexs[] = 
+                //only a pause resume the replay,any other state end it
+                if ( this->state != GameState::PAUSE )
+                {
+                    this->stop_replay();
+                    return false;
+                }
+                //replay clock stop with the game
+                this->replay_begin += std::chrono::milliseconds( REPLAY_POLL_MS );
+                this->replay_timeout = Glib::signal_timeout().connect( sigc::mem_fun( *this , &SudokuBoard::on_replay_timeout ) , REPLAY_POLL_MS );
+                return false;
+            }
+            //accelerated replay:every due event in one tick
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - this->replay_begin );
+            do
             {
-                "1" , "2" , "3" , "4" , "5" , "6" , "7" , "8" , "9"
-            };
+                this->apply_replay_event( this->replay_events[this->replay_position++] );
+            }
+            while ( ( this->replay_position < this->replay_events.size() ) &&
+                    ( ( this->replay_speed <= 0 ) ||
+                      ( this->replay_events[this->replay_position].time_ms/this->replay_speed <= elapsed.count() ) ) );
+            this->schedule_replay();
+            return false;
+        }
 
-            //draw index
-            set_rgba( cairo_context , PUZZLE_NUMBER_RGBA );
-            this->layout->set_font_description( this->candidate_font );
-            cairo_context->set_line_width( this->line_size );
-            for( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+        void apply_replay_event( const ReplayEvent& event )
+        {
+            switch ( event.type )
             {
-                int layout_width , layout_height;
-                this->layout->set_text( row_indexs[i] );
-                this->layout->get_pixel_size( layout_width , layout_height );
-                cairo_context->move_to( this->row_index_size/2 - layout_width/2 , 
-                    this->column_index_size + ( this->grid_size )/2 - ( this->font_size )/2 + i*( ( this->grid_size ) ) - layout_height/2 );
-                this->layout->show_in_cairo_context( cairo_context );
-                this->layout->set_text( column_indexs[i] );
-                this->layout->get_pixel_size( layout_width , layout_height );
-                cairo_context->move_to( this->row_index_size + ( this->grid_size )/2 - ( this->font_size )/2 + i*( ( this->grid_size ) ) - layout_width/2 ,
-                    this->column_index_size/2 - layout_height/2 );
-                this->layout->show_in_cairo_context( cairo_context );
+                case ReplayEventType::SELECT:
+                    if ( ( event.x < SUDOKU_SIZE ) && ( event.y < SUDOKU_SIZE ) )
+                        this->select( event.x , event.y );
+                    break;
+                case ReplayEventType::FILL_ANSWER:
+                    this->fill_cell( event.value , FillMode::ANSWER );
+                    break;
+                case ReplayEventType::FILL_CANDIDATE:
+                    this->fill_cell( event.value , FillMode::CANDIDATE );
+                    break;
+                case ReplayEventType::UNDO:
+                case ReplayEventType::REDO:
+                    this->step_history( event.type );
+                    break;
+                case ReplayEventType::AUTOUPDATE:
+                    this->set_autoupdate( event.value != 0 );
+                    break;
+                default:
+                    break;
             }
-            cairo_context->restore();
         }
 
-        void draw_board_box( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+        std::uint32_t get_journal_time( void )
         {
-            cairo_context->save();
-            //draw board box
-            set_rgba( cairo_context , PUZZLE_NUMBER_RGBA );
-            cairo_context->rectangle( this->row_index_size , this->column_index_size , SUDOKU_SIZE*( this->grid_size ) , SUDOKU_SIZE*( this->grid_size ) );
-            cairo_context->stroke();
-            cairo_context->restore();
+            return static_cast<std::uint32_t>( ( this->prev_time + this->timer.elapsed() )*1000 );
         }
 
-        void draw_board_line( const Cairo::RefPtr<Cairo::Context> & cairo_context )
+        void journal_last_step( void )
         {
-            cairo_context->save();
-            //draw board line
-            set_rgba( cairo_context , PUZZLE_NUMBER_RGBA );
-            for ( cell_t i = 1 ; i < SUDOKU_SIZE ; i++ )
+            if ( this->journal == nullptr )
+                return ;
+            const History& steps = this->history.get_history();
+            auto step = steps.get_step( steps.get_cursor() - 1 );
+            std::uint32_t time_ms = this->get_journal_time();
+            std::vector<JournalRecord> records;
+            for ( std::size_t i = 0 ; i < step.second ; i++ )
             {
-                if ( i%SUDOKU_BOX_SIZE == 0 )
-                    cairo_context->set_line_width( this->bold_line_size );
-                else
-                    cairo_context->set_line_width( this->line_size );
-                cairo_context->move_to( this->row_index_size + i*( this->grid_size ) , this->column_index_size );
-                cairo_context->line_to( this->row_index_size + i*( this->grid_size ) , this->column_index_size + 
-                                        SUDOKU_SIZE*( this->grid_size ) );
-
-                cairo_context->move_to( this->row_index_size , this->column_index_size + i*( this->grid_size ) );
-                cairo_context->line_to( this->row_index_size + SUDOKU_SIZE*( this->grid_size )
-                                        , this->column_index_size + i*( this->grid_size ) );
-                cairo_context->stroke();
+                records.push_back( { time_ms , step.first[i] , JournalRecordType::CELL_RECORD ,
+                                     static_cast<std::uint8_t>( ( i == 0 ) ? JOURNAL_STEP_BEGIN : 0 ) } );
             }
-            cairo_context->restore();
+            this->journal->append( records );
+            if ( this->journal->get_record_count() > 2*this->journal_compact_size + JOURNAL_COMPACT_SLACK )
+                this->compact_journal();
         }
 
-        void draw_puzzle( const Cairo::RefPtr<Cairo::Context> & cairo_context , const puzzle_t& puzzle )
+        void compact_journal( void )
         {
-            cairo_context->save();
-            //draw puzzle
-            set_rgba( cairo_context , PUZZLE_NUMBER_RGBA );
-            this->layout->set_font_description( solutions_font );
-            for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+            if ( this->journal == nullptr )
+                return ;
+            const History& steps = this->history.get_history();
+            std::uint32_t time_ms = this->get_journal_time();
+            std::vector<JournalRecord> records = history_to_journal( steps , time_ms );
+            this->journal_compact_size = records.size();
+            //empty history carry no time record,the header keep the play time
+            this->journal->compact( { this->game.get_puzzle_level() , steps.get_state( 0 ) , this->solution , time_ms } ,
+                                    std::move( records ) );
+        }
+
+        //damage region of cells [ x , x + x_count ) X [ y , y + y_count ),widen by bold line which overlap neighbour
+        void queue_draw_cells( std::size_t x , std::size_t y , std::size_t x_count , std::size_t y_count )
+        {
+            int margin = this->bold_line_size;
+            this->queue_draw_area( this->row_index_size + y*( this->grid_size ) - margin ,
+                                   this->column_index_size + x*( this->grid_size ) - margin ,
+                                   y_count*( this->grid_size ) + 2*margin ,
+                                   x_count*( this->grid_size ) + 2*margin );
+        }
+
+        //row,column,box of the selected cell and every cell show the selected digit
+        void queue_draw_selection( void )
+        {
+            std::size_t box_x = ( this->grid_x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE;
+            std::size_t box_y = ( this->grid_y/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE;
+            this->queue_draw_cells( this->grid_x , 0 , 1 , SUDOKU_SIZE );
+            this->queue_draw_cells( 0 , this->grid_y , SUDOKU_SIZE , 1 );
+            this->queue_draw_cells( box_x , box_y , SUDOKU_BOX_SIZE , SUDOKU_BOX_SIZE );
+            this->queue_draw_digit( this->puzzle[this->grid_x][this->grid_y] );
+        }
+
+        void queue_draw_digit( cell_t number )
+        {
+            if ( number == 0 )
+                return ;
+            for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
             {
-                for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+                for ( std::size_t j = 0 ; j < SUDOKU_SIZE ; j++ )
                 {
-                    cell_t number = puzzle[i][j];
-                    if ( number == 0 )
-                        continue;
-                    this->layout->set_text( std::to_string( number ) );
-                    int layout_width , layout_height;
-                    this->layout->get_pixel_size( layout_width , layout_height );
-                    cairo_context->move_to( this->row_index_size + j*( this->grid_size ) + ( this->grid_size )/2 - layout_width/2
-                                                , this->column_index_size + i*( this->grid_size ) + ( this->grid_size )/2 - layout_height/2 );
-                    this->layout->show_in_cairo_context( cairo_context );
+                    if ( this->puzzle[i][j] == number )
+                        this->queue_draw_cells( i , j , 1 , 1 );
                 }
             }
-
-            cairo_context->restore();
         }
 
+        void on_cells_changed( const CellChange& change )
+        {
+            auto cells = change.get_cells();
+            if ( cells.all() )
+            {
+                this->queue_draw();
+                return ;
+            }
+            for ( std::size_t index = 0 ; index < cells.size() ; index++ )
+            {
+                if ( cells[index] )
+                    this->queue_draw_cells( index/SUDOKU_SIZE , index%SUDOKU_SIZE , 1 , 1 );
+            }
+            //selected digit changed,the highlighted digit of other cells change too
+            if ( this->select_cell && change.digits[ this->grid_x*SUDOKU_SIZE + this->grid_y ] )
+            {
+                this->queue_draw_digit( this->highlight_number );
+                this->queue_draw_digit( this->puzzle[this->grid_x][this->grid_y] );
+            }
+            this->highlight_number = this->select_cell ? this->puzzle[this->grid_x][this->grid_y] : 0;
+        }
 };
 
 class ControlButton : public Gtk::EventBox
@@ -908,23 +1352,25 @@ class ControlButton : public Gtk::EventBox
     protected:
         bool on_draw( const Cairo::RefPtr<Cairo::Context> & cairo_context ) override
         {
+            SUDOKU_TRACE_SCOPE( "ControlButton::on_draw" );
             cairo_context->save();
 
+            const BoardPalette& palette = get_palette( current_theme );
             //draw background color
             if ( pointer_enters )
-                set_rgba( cairo_context , SELECT_NUMBER_RGBA );
+                set_rgba( cairo_context , palette.select_number );
             else
-                set_rgba( cairo_context , BOARD_BACKGROUD_RGBA );
+                set_rgba( cairo_context , palette.background );
             cairo_context->rectangle( 0 , 0 , this->get_allocated_width() , this->get_allocated_height() );
             cairo_context->stroke_preserve();
             cairo_context->fill();
 
-            set_rgba( cairo_context , BUTTON_BORDER_RGBA );
+            set_rgba( cairo_context , palette.button_border );
             cairo_context->rectangle( 0 , 0 , this->get_allocated_width() , this->get_allocated_height() );
             cairo_context->stroke();
             cairo_context->fill();
 
-            set_rgba( cairo_context , PUZZLE_NUMBER_RGBA );
+            set_rgba( cairo_context , palette.puzzle_number );
             this->layout->set_text( this->label );
             int layout_width = 0 , layout_height = 0;
             this->layout->get_pixel_size( layout_width , layout_height );
@@ -957,11 +1403,136 @@ class ControlButton : public Gtk::EventBox
         bool pointer_enters;
 };
 
-int main( void )
+//sudoku --export booklet.pdf|booklet.png [--count N] [--level easy|medium|hard|expert] [--generate]
+//       [--layout COLUMNSxROWS] [--answers] [--threads N]
+//batch export without window,return process exit code
+static int run_export_command( int argc , char * argv[] )
+{
+    std::string filename;
+    std::size_t count = 60;
+    SUDOKU_LEVEL level = NEW_GAME_LEVEL;
+    BookletSource source = BookletSource::CORPUS;
+    BookletOptions options;
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        bool has_value = ( i + 1 < argc );
+        if ( ( option == "--export" ) && has_value )
+            filename = argv[++i];
+        else if ( ( option == "--count" ) && has_value )
+            count = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--level" ) && has_value )
+        {
+            std::string level_string( argv[++i] );
+            level = SUDOKU_LEVEL::_LEVEL_COUNT;
+            for ( std::uint8_t k = 0 ; k < static_cast<std::uint8_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) ; k++ )
+            {
+                if ( level_to_string( static_cast<SUDOKU_LEVEL>( k ) ) == level_string )
+                    level = static_cast<SUDOKU_LEVEL>( k );
+            }
+        }
+        else if ( option == "--generate" )
+            source = BookletSource::GENERATOR;
+        else if ( ( option == "--layout" ) && has_value )
+        {
+            unsigned int columns = 0 , rows = 0;
+            if ( std::sscanf( argv[++i] , "%ux%u" , &columns , &rows ) == 2 )
+            {
+                options.columns = columns;
+                options.rows = rows;
+            }
+        }
+        else if ( option == "--answers" )
+            options.answer_pages = true;
+        else if ( ( option == "--threads" ) && has_value )
+            options.worker_number = std::strtoul( argv[++i] , nullptr , 10 );
+        else
+        {
+            std::fprintf( stderr , "unknown option:%s\n" , option.c_str() );
+            return EXIT_FAILURE;
+        }
+    }
+    Glib::ustring extension_string = std::filesystem::path( filename ).extension().string();
+    if ( extension_string.lowercase() == ".png" )
+        options.format = BookletFormat::PNG;
+
+    try
+    {
+        auto begin = std::chrono::steady_clock::now();
+        auto entries = collect_booklet_puzzles( source , level , count , options.answer_pages , options.worker_number );
+        auto collected = std::chrono::steady_clock::now();
+        std::size_t pages = export_booklet( entries , filename , options );
+        std::chrono::duration<double> collect_cost = collected - begin;
+        std::chrono::duration<double> render_cost = std::chrono::steady_clock::now() - collected;
+        std::printf( "%zu puzzles,%zu pages written to '%s',collect %.3fs,render %.3fs\n" ,
+                     entries.size() , pages , filename.c_str() , collect_cost.count() , render_cost.count() );
+    }
+    catch( const std::exception& e )
+    {
+        std::fprintf( stderr , "export failure:%s\n" , e.what() );
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+//sudoku --replay FILE...
+//apply recorded sessions headless at full speed,print final board and cost of each
+static int run_replay_command( int argc , char * argv[] )
+{
+    int result = EXIT_SUCCESS;
+    std::size_t total_events = 0;
+    std::chrono::duration<double> total_cost( 0 );
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        if ( option == "--replay" )
+            continue;
+        try
+        {
+            ReplayStream stream = load_replay( option );
+            auto begin = std::chrono::steady_clock::now();
+            ReplayEngine engine( std::move( stream ) );
+            std::size_t events = engine.run();
+            std::chrono::duration<double> cost = std::chrono::steady_clock::now() - begin;
+            total_events += events;
+            total_cost += cost;
+            std::printf( "%s:%zu events,%zu rejected,%zu steps,%.3f ms,%s\n" , option.c_str() , events ,
+                         engine.get_rejected_count() , engine.get_history().get_history().get_cursor() ,
+                         cost.count()*1000 , puzzle_to_string( engine.get_game().get_puzzle() ).c_str() );
+        }
+        catch( const std::exception& e )
+        {
+            std::fprintf( stderr , "replay '%s' failure:%s\n" , option.c_str() , e.what() );
+            result = EXIT_FAILURE;
+        }
+    }
+    if ( total_cost.count() > 0 )
+        std::printf( "total %zu events,%.3f ms,%.0f events/s\n" , total_events , total_cost.count()*1000 ,
+                     total_events/total_cost.count() );
+    return result;
+}
+
+int main( int argc , char * argv[] )
 {
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        if ( std::string( argv[i] ) == "--export" )
+            return run_export_command( argc , argv );
+        if ( std::string( argv[i] ) == "--replay" )
+            return run_replay_command( argc , argv );
+    }
+
+    SUDOKU_TRACE_THREAD( "main" );
+    startup_report.mark( "main" );
     auto app = Gtk::Application::create();
+    startup_report.mark( "application created" );
 
-    Glib::RefPtr<Gtk::Builder> builder = Gtk::Builder::create_from_file( UI_FILE );
+    Glib::RefPtr<Gtk::Builder> builder;
+    {
+        SUDOKU_TRACE_SCOPE( "Gtk::Builder::create_from_file" );
+        builder = Gtk::Builder::create_from_file( UI_FILE );
+    }
+    startup_report.mark( "ui file loaded" );
 
     Gtk::Window * window;
     builder->get_widget( "GameWindow" , window );
@@ -972,6 +1543,7 @@ int main( void )
 
     SudokuBoard * sudoku_board;
     builder->get_widget_derived( "SudokuBoard" , sudoku_board );
+    startup_report.mark( "board constructed" );
 
     //bind setting menu buttons signal handler
 
@@ -1002,6 +1574,15 @@ int main( void )
         }
     );
 
+    Gtk::CheckMenuItem * show_metrics;
+    builder->get_widget( "ShowMetrics" , show_metrics );
+    show_metrics->signal_toggled().connect(
+        [ sudoku_board , show_metrics ]()
+        {
+            sudoku_board->set_show_metrics( show_metrics->get_active() );
+        }
+    );
+
     Gtk::MenuItem * light_theme;
     builder->get_widget( "LightTheme" , light_theme );
     light_theme->signal_activate().connect( 
@@ -1032,7 +1613,19 @@ int main( void )
                 return ;
             if ( view_solution->get_active() )
             {
-                sudoku_board->set_game_state( SudokuBoard::GameState::VIEW_SOLUTION );
+                //solved in background,unsolvable puzzle or new game stay in play,toggled again by set_active
+                sudoku_board->prepare_solution(
+                    [ sudoku_board , view_solution ]( bool found )
+                    {
+                        //toggled off while solving
+                        if ( view_solution->get_active() == false )
+                            return ;
+                        if ( found && ( sudoku_board->get_game_state() == SudokuBoard::GameState::PLAYING ) )
+                            sudoku_board->set_game_state( SudokuBoard::GameState::VIEW_SOLUTION );
+                        else
+                            view_solution->set_active( false );
+                    }
+                );
             }
             else
             {
@@ -1047,7 +1640,42 @@ int main( void )
         [ sudoku_board ]()
         {
             auto clipboard = Gtk::Clipboard::get();
-            clipboard->request_text( sigc::mem_fun<Glib::ustring>( sudoku_board , &SudokuBoard::new_game ) );
+            clipboard->request_text( sigc::mem_fun( sudoku_board , &SudokuBoard::import_text ) );
+        }
+    );
+
+    Gtk::MenuItem * import_file;
+    builder->get_widget( "ImportFile" , import_file );
+    import_file->signal_activate().connect(
+        [ sudoku_board ]()
+        {
+            Gtk::FileChooserDialog chooser( "import puzzles" , Gtk::FileChooserAction::FILE_CHOOSER_ACTION_OPEN );
+            auto filter = Gtk::FileFilter::create();
+            filter->add_pattern( "*.[Tt][Xx][Tt]" );
+            filter->add_pattern( "*.[Ss][Dd][Mm]" );
+            filter->add_pattern( "*.[Cc][Ss][Vv]" );
+            filter->set_name( "puzzle text" );
+            chooser.add_filter( filter );
+            auto all_filter = Gtk::FileFilter::create();
+            all_filter->add_pattern( "*" );
+            all_filter->set_name( "all files" );
+            chooser.add_filter( all_filter );
+            chooser.add_button( "OK" , 0 );
+            chooser.run();
+            std::string filename( chooser.get_filename() );
+            if ( filename.empty() )
+                return ;
+            sudoku_board->import_file( filename );
+        }
+    );
+
+    Gtk::MenuItem * next_puzzle;
+    builder->get_widget( "NextPuzzle" , next_puzzle );
+    next_puzzle->signal_activate().connect(
+        [ sudoku_board ]()
+        {
+            if ( sudoku_board->next_puzzle() == false )
+                g_log( "NextPuzzle" , G_LOG_LEVEL_MESSAGE , "playlist is empty,import puzzles first" );
         }
     );
 
@@ -1101,6 +1729,90 @@ int main( void )
         }
     );
 
+    Gtk::MenuItem * export_booklet;
+    builder->get_widget( "ExportBooklet" , export_booklet );
+    export_booklet->signal_activate().connect(
+        [ sudoku_board ]()
+        {
+            Gtk::FileChooserDialog chooser( "export booklet" , Gtk::FileChooserAction::FILE_CHOOSER_ACTION_SAVE );
+            auto filter = Gtk::FileFilter::create();
+            filter->add_pattern( "*.[Pp][Dd][Ff]" );
+            filter->add_pattern( "*.[Pp][Nn][Gg]" );
+            filter->set_name( "pdf/png series" );
+            chooser.add_filter( filter );
+
+            Gtk::Box options_box( Gtk::ORIENTATION_HORIZONTAL , 8 );
+            Gtk::Label count_label( "puzzles" );
+            Gtk::SpinButton count_button;
+            count_button.set_range( 1 , 10000 );
+            count_button.set_increments( 1 , 60 );
+            count_button.set_value( 60 );
+            Gtk::CheckButton answer_button( "answer pages" );
+            options_box.pack_start( count_label , Gtk::PACK_SHRINK );
+            options_box.pack_start( count_button , Gtk::PACK_SHRINK );
+            options_box.pack_start( answer_button , Gtk::PACK_SHRINK );
+            options_box.show_all();
+            chooser.set_extra_widget( options_box );
+
+            chooser.add_button( "OK" , 0 );
+            chooser.run();
+            std::string filename( chooser.get_filename() );
+            if ( filename.empty() )
+                return ;
+            sudoku_board->export_booklet( filename , count_button.get_value_as_int() , answer_button.get_active() );
+        }
+    );
+
+    Gtk::MenuItem * save_replay;
+    builder->get_widget( "SaveReplay" , save_replay );
+    save_replay->signal_activate().connect(
+        [ sudoku_board ]()
+        {
+            Gtk::FileChooserDialog chooser( "save replay" , Gtk::FileChooserAction::FILE_CHOOSER_ACTION_SAVE );
+            auto filter = Gtk::FileFilter::create();
+            filter->add_pattern( "*.[Ss][Dd][Rr]" );
+            filter->set_name( "sudoku replay" );
+            chooser.add_filter( filter );
+            chooser.add_button( "OK" , 0 );
+            chooser.run();
+            std::string filename( chooser.get_filename() );
+            if ( filename.empty() )
+                return ;
+            sudoku_board->save_replay( filename );
+        }
+    );
+
+    Gtk::MenuItem * play_replay;
+    builder->get_widget( "PlayReplay" , play_replay );
+    play_replay->signal_activate().connect(
+        [ sudoku_board ]()
+        {
+            Gtk::FileChooserDialog chooser( "play replay" , Gtk::FileChooserAction::FILE_CHOOSER_ACTION_OPEN );
+            auto filter = Gtk::FileFilter::create();
+            filter->add_pattern( "*.[Ss][Dd][Rr]" );
+            filter->set_name( "sudoku replay" );
+            chooser.add_filter( filter );
+
+            Gtk::Box options_box( Gtk::ORIENTATION_HORIZONTAL , 8 );
+            Gtk::Label speed_label( "speed( 0:instant )" );
+            Gtk::SpinButton speed_button( 0.0 , 2 );
+            speed_button.set_range( 0 , 64 );
+            speed_button.set_increments( 0.25 , 4 );
+            speed_button.set_value( 1 );
+            options_box.pack_start( speed_label , Gtk::PACK_SHRINK );
+            options_box.pack_start( speed_button , Gtk::PACK_SHRINK );
+            options_box.show_all();
+            chooser.set_extra_widget( options_box );
+
+            chooser.add_button( "OK" , 0 );
+            chooser.run();
+            std::string filename( chooser.get_filename() );
+            if ( filename.empty() )
+                return ;
+            sudoku_board->play_replay( filename , speed_button.get_value() );
+        }
+    );
+
     Gtk::MenuItem * exit_game;
     builder->get_widget( "ExitGame" , exit_game );
     exit_game->signal_activate().connect(
@@ -1116,44 +1828,38 @@ int main( void )
     builder->get_widget( "LevelMenu" , level_menu );
     Gtk::Grid * level_grid;
     builder->get_widget( "LevelGrid" , level_grid );
-    std::array< ControlButton , static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) + 1 > level_button_arr;
-    for( cell_t i = 0 ; i < static_cast<cell_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) ; i++ )
+    constexpr int level_count = static_cast<int>( SUDOKU_LEVEL::_LEVEL_COUNT );
+    //fetch buttons,then one local generate button every level
+    std::array< ControlButton , 2*level_count > level_button_arr;
+    for( int i = 0 ; i < 2*level_count ; i++ )
     {
+        SUDOKU_LEVEL level = static_cast<SUDOKU_LEVEL>( i%level_count );
+        bool generate = ( i >= level_count );
         level_button_arr[i].set_font( "Ubuntu Mono 14" );
-        level_button_arr[i].set_label( level_to_string( static_cast<SUDOKU_LEVEL>( i ) ) );
+        level_button_arr[i].set_label( generate ? "generate " + level_to_string( level ) : level_to_string( level ) );
         level_button_arr[i].signal_button_press_event().connect(
-            [ sudoku_board , level_menu , headbar , i ]( GdkEventButton * event )
+            [ sudoku_board , level_menu , headbar , level , generate ]( GdkEventButton * event )
             {
                 //ignore double-clicked and three-clicked 
                 if ( ( event->type == GdkEventType::GDK_2BUTTON_PRESS ) || ( event->type == GdkEventType::GDK_3BUTTON_PRESS ) )
                     return true;
 
                 level_menu->popdown();
-                headbar->set_title( level_to_string( static_cast<SUDOKU_LEVEL>( i ) ) );
-                sudoku_board->new_game( static_cast<SUDOKU_LEVEL>( i ) );
+                if ( generate )
+                {
+                    headbar->set_title( "Automatic Generate " + level_to_string( level ) );
+                    sudoku_board->new_game_generated( level );
+                }
+                else
+                {
+                    headbar->set_title( level_to_string( level ) );
+                    sudoku_board->new_game( level );
+                }
                 return true;
             }
         );
         level_grid->attach( level_button_arr[i] , 0 , i , 1 , 1 );
     }
-
-    int generator_pos = static_cast<int>( SUDOKU_LEVEL::_LEVEL_COUNT );
-    level_button_arr[ generator_pos ].set_font( "Ubuntu Mono 14" );
-    level_button_arr[ generator_pos ].set_label( "Automatic Generate" );
-    level_button_arr[ generator_pos ].signal_button_press_event().connect(
-        [ sudoku_board , level_menu , headbar ]( GdkEventButton * event )
-        {
-            //ignore double-clicked and three-clicked 
-            if ( ( event->type == GdkEventType::GDK_2BUTTON_PRESS ) || ( event->type == GdkEventType::GDK_3BUTTON_PRESS ) )
-                return true;
-
-            level_menu->popdown();
-            headbar->set_title( "Automatic Generate" );
-            sudoku_board->new_game();
-            return true;
-        }
-    );
-    level_grid->attach( level_button_arr[ generator_pos ] , 0 , generator_pos , 1 , 1 );
     level_grid->show_all();
 
     Gtk::Popover * fill_menu;
@@ -1263,12 +1969,31 @@ int main( void )
     Glib::signal_timeout().connect_seconds(
         [ sudoku_board , timer_label ]()
         {
-            timer_label->set_label( sudoku_board->dump_play_time() );
+            Glib::ustring time_string( sudoku_board->dump_play_time() );
+            if ( sudoku_board->get_game_state() == SudokuBoard::GameState::COMPLETED )
+                time_string += " solved";
+            if ( sudoku_board->get_import_progress() >= 0.0 )
+                time_string += " importing " + std::to_string( static_cast<int>( sudoku_board->get_import_progress()*100 ) ) + "%";
+            if ( sudoku_board->get_playlist_size() > 0 )
+                time_string += " " + std::to_string( sudoku_board->get_playlist_size() ) + " queued";
+            timer_label->set_label( time_string );
             return true;
         },
         1 
     );
 
+    auto first_frame = std::make_shared<sigc::connection>();
+    *first_frame = sudoku_board->signal_draw().connect(
+        [ first_frame ]( const Cairo::RefPtr<Cairo::Context>& )
+        {
+            startup_report.mark( "first frame" );
+            first_frame->disconnect();
+            return false;
+        },
+        false
+    );
+
     window->show_all();
+    startup_report.mark( "window shown" );
     return app->run( *window );
 }
@@ -0,0 +1,129 @@
+#include <cstdint>
+#include <cstdio>
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "metrics.h"
+
+static std::size_t bucket_index( std::uint64_t value )
+{
+    if ( value == 0 )
+        return 0;
+    std::size_t index = 64 - __builtin_clzll( value );
+    return std::min( index , MetricHistogram::BUCKET_NUMBER - 1 );
+}
+
+void MetricHistogram::record( std::uint64_t value_us ) noexcept( true )
+{
+    this->buckets[bucket_index( value_us )].fetch_add( 1 , std::memory_order_relaxed );
+    this->sum.fetch_add( value_us , std::memory_order_relaxed );
+    this->last.store( value_us , std::memory_order_relaxed );
+    this->count.fetch_add( 1 , std::memory_order_relaxed );
+}
+
+std::uint64_t MetricHistogram::get_last( void ) const noexcept( true )
+{
+    return this->last.load( std::memory_order_relaxed );
+}
+
+std::uint64_t MetricHistogram::get_count( void ) const noexcept( true )
+{
+    return this->count.load( std::memory_order_relaxed );
+}
+
+double MetricHistogram::get_mean( void ) const noexcept( true )
+{
+    std::uint64_t count = this->get_count();
+    return ( count == 0 ) ? 0.0 : static_cast<double>( this->sum.load( std::memory_order_relaxed ) )/count;
+}
+
+std::uint64_t MetricHistogram::get_percentile( double p ) const noexcept( true )
+{
+    //buckets read one by one,concurrent records may skew the answer by a sample
+    std::array<std::uint64_t , BUCKET_NUMBER> snapshot;
+    std::uint64_t total = 0;
+    for ( std::size_t k = 0 ; k < BUCKET_NUMBER ; k++ )
+    {
+        snapshot[k] = this->buckets[k].load( std::memory_order_relaxed );
+        total += snapshot[k];
+    }
+    if ( total == 0 )
+        return 0;
+    std::uint64_t rank = static_cast<std::uint64_t>( std::clamp( p , 0.0 , 1.0 )*( total - 1 ) ) + 1;
+    std::uint64_t seen = 0;
+    for ( std::size_t k = 0 ; k < BUCKET_NUMBER ; k++ )
+    {
+        seen += snapshot[k];
+        if ( seen >= rank )
+            return ( k == 0 ) ? 0 : ( std::uint64_t( 1 ) << k ) - 1;
+    }
+    return ( std::uint64_t( 1 ) << ( BUCKET_NUMBER - 1 ) ) - 1;
+}
+
+template<typename Metric>
+static Metric& find_or_create( std::map< std::string , std::unique_ptr<Metric> >& metrics , const std::string& name )
+{
+    auto found = metrics.find( name );
+    if ( found == metrics.end() )
+        found = metrics.emplace( name , std::make_unique<Metric>() ).first;
+    return *( found->second );
+}
+
+MetricCounter& MetricsRegistry::counter( const std::string& name ) noexcept( false )
+{
+    std::lock_guard<std::mutex> lock( this->mutex );
+    return find_or_create( this->counters , name );
+}
+
+MetricGauge& MetricsRegistry::gauge( const std::string& name ) noexcept( false )
+{
+    std::lock_guard<std::mutex> lock( this->mutex );
+    return find_or_create( this->gauges , name );
+}
+
+MetricHistogram& MetricsRegistry::histogram( const std::string& name ) noexcept( false )
+{
+    std::lock_guard<std::mutex> lock( this->mutex );
+    return find_or_create( this->histograms , name );
+}
+
+std::string MetricsRegistry::to_string( void ) const noexcept( false )
+{
+    std::string result;
+    char line[256];
+    std::lock_guard<std::mutex> lock( this->mutex );
+    for ( const auto& counter : this->counters )
+    {
+        std::snprintf( line , sizeof( line ) , "%s %llu\n" , counter.first.c_str() ,
+                       static_cast<unsigned long long>( counter.second->get() ) );
+        result += line;
+    }
+    for ( const auto& gauge : this->gauges )
+    {
+        std::snprintf( line , sizeof( line ) , "%s %lld\n" , gauge.first.c_str() , static_cast<long long>( gauge.second->get() ) );
+        result += line;
+    }
+    for ( const auto& histogram : this->histograms )
+    {
+        const MetricHistogram& value = *( histogram.second );
+        std::snprintf( line , sizeof( line ) , "%s count:%llu mean:%.1f p50:%llu p99:%llu last:%llu\n" , histogram.first.c_str() ,
+                       static_cast<unsigned long long>( value.get_count() ) , value.get_mean() ,
+                       static_cast<unsigned long long>( value.get_percentile( 0.50 ) ) ,
+                       static_cast<unsigned long long>( value.get_percentile( 0.99 ) ) ,
+                       static_cast<unsigned long long>( value.get_last() ) );
+        result += line;
+    }
+    return result;
+}
+
+MetricsRegistry& metrics( void ) noexcept( true )
+{
+    //leaked on purpose,metrics stay valid in static destructors and detached threads
+    static MetricsRegistry * registry = new MetricsRegistry();
+    return *registry;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/*
+* in-process metrics,cheap enough to stay on in release builds:
+* an update is one or two relaxed atomic operations,no lock,no allocation.
+* look a metric up once( function static reference ),the registry lock is only taken on first use.
+*   static MetricHistogram& solve_us = metrics().histogram( "solver.solve_us" );
+*   MetricTimer timer( solve_us );
+*/
+
+//monotonic event count
+class MetricCounter
+{
+    public:
+        void add( std::uint64_t value = 1 ) noexcept( true )
+        {
+            this->value.fetch_add( value , std::memory_order_relaxed );
+        }
+        std::uint64_t get( void ) const noexcept( true )
+        {
+            return this->value.load( std::memory_order_relaxed );
+        }
+    private:
+        std::atomic<std::uint64_t> value{ 0 };
+};
+
+//current level( queue depth,requests in flight )
+class MetricGauge
+{
+    public:
+        void set( std::int64_t value ) noexcept( true )
+        {
+            this->value.store( value , std::memory_order_relaxed );
+        }
+        void add( std::int64_t value = 1 ) noexcept( true )
+        {
+            this->value.fetch_add( value , std::memory_order_relaxed );
+        }
+        void sub( std::int64_t value = 1 ) noexcept( true )
+        {
+            this->value.fetch_sub( value , std::memory_order_relaxed );
+        }
+        std::int64_t get( void ) const noexcept( true )
+        {
+            return this->value.load( std::memory_order_relaxed );
+        }
+    private:
+        std::atomic<std::int64_t> value{ 0 };
+};
+
+//microsecond samples in power of two buckets:bucket k hold [ 2^(k-1) , 2^k ),bucket 0 hold 0
+class MetricHistogram
+{
+    public:
+        static constexpr std::size_t BUCKET_NUMBER = 40;
+
+        void record( std::uint64_t value_us ) noexcept( true );
+
+        //latest sample,0 before the first
+        std::uint64_t get_last( void ) const noexcept( true );
+        std::uint64_t get_count( void ) const noexcept( true );
+        double get_mean( void ) const noexcept( true );
+        //upper bound of the bucket holding the p quantile( 0.0-1.0 ),0 when empty
+        std::uint64_t get_percentile( double p ) const noexcept( true );
+    private:
+        std::array< std::atomic<std::uint64_t> , BUCKET_NUMBER > buckets{};
+        std::atomic<std::uint64_t> count{ 0 };
+        std::atomic<std::uint64_t> sum{ 0 };
+        std::atomic<std::uint64_t> last{ 0 };
+};
+
+//elapsed time of a scope into a histogram
+class MetricTimer
+{
+    public:
+        explicit MetricTimer( MetricHistogram& histogram ) noexcept( true ):
+            histogram( histogram ),
+            begin( std::chrono::steady_clock::now() )
+        {
+            ;
+        }
+        ~MetricTimer()
+        {
+            this->histogram.record( std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - this->begin ).count() );
+        }
+        MetricTimer( const MetricTimer& ) = delete;
+        MetricTimer& operator=( const MetricTimer& ) = delete;
+    private:
+        MetricHistogram& histogram;
+        std::chrono::steady_clock::time_point begin;
+};
+
+//gauge raised for the lifetime of a scope( work in flight )
+class MetricGaugeScope
+{
+    public:
+        explicit MetricGaugeScope( MetricGauge& gauge ) noexcept( true ):
+            gauge( gauge )
+        {
+            this->gauge.add();
+        }
+        ~MetricGaugeScope()
+        {
+            this->gauge.sub();
+        }
+        MetricGaugeScope( const MetricGaugeScope& ) = delete;
+        MetricGaugeScope& operator=( const MetricGaugeScope& ) = delete;
+    private:
+        MetricGauge& gauge;
+};
+
+//named metrics,created on first lookup and never destroyed,references stay valid
+class MetricsRegistry
+{
+    public:
+        MetricCounter& counter( const std::string& name ) noexcept( false );
+        MetricGauge& gauge( const std::string& name ) noexcept( false );
+        MetricHistogram& histogram( const std::string& name ) noexcept( false );
+
+        //one line a metric sorted by name,for logs and the tools
+        std::string to_string( void ) const noexcept( false );
+    private:
+        mutable std::mutex mutex;
+        std::map< std::string , std::unique_ptr<MetricCounter> > counters;
+        std::map< std::string , std::unique_ptr<MetricGauge> > gauges;
+        std::map< std::string , std::unique_ptr<MetricHistogram> > histograms;
+};
+
+//process wide registry
+MetricsRegistry& metrics( void ) noexcept( true );
+
+#endif
@@ -0,0 +1,720 @@
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include <curl/curl.h>
+
+#include "metrics.h"
+#include "puzzlefetcher.h"
+#include "trace.h"
+
+static class LibCurlInit
+{
+    public:
+        LibCurlInit()
+        {
+            if ( curl_global_init( CURL_GLOBAL_ALL ) )
+            {
+                throw std::runtime_error( "libcurl global initial failure" );
+            };
+        }
+        ~LibCurlInit()
+        {
+            curl_global_cleanup();
+        }
+}_init_libcurl;
+
+//incremental scanner of getLevel response,fed chunk by chunk from libcurl write callback.
+//{
+//    "answer": "success",
+//    "message": "Level exist",
+//    "desc": [
+//        "008000402000320780702506000003050004009740200006200000000000500900005600620000190",   //puzzle
+//        "368179452591324786742586319213658974859743261476291835187962543934815627625437198",   //solution
+//        310,
+//        7,
+//        false
+//    ]
+//}
+//only the first two strings of top level "desc" array are kept,in fixed size buffers,
+//so parsing never allocate and the whole response size is capped.
+class LevelResponseParser
+{
+    public:
+        //response bigger than this is not a getLevel response
+        static constexpr std::size_t MAX_RESPONSE_SIZE = 64*1024;
+        static constexpr std::size_t MAX_DEPTH = 32;
+        static constexpr std::size_t STRING_SIZE = SUDOKU_SIZE*SUDOKU_SIZE;
+
+        enum class State:std::uint32_t
+        {
+            PARSING = 0,
+            MALFORMED,
+            OVERSIZE
+        };
+
+        LevelResponseParser()
+        {
+            this->reset();
+        }
+
+        void reset( void )
+        {
+            this->state = State::PARSING;
+            this->total_size = 0;
+            this->depth = 0;
+            this->root_closed = false;
+            this->in_string = false;
+            this->escape = false;
+            this->expect_key = false;
+            this->string_role = Role::IGNORE;
+            this->key_size = 0;
+            this->key_is_desc = false;
+            this->desc_depth = 0;
+            this->desc_index = 0;
+            this->string_size.fill( 0 );
+        }
+
+        //return false if stop receiving( malformed or oversize )
+        bool feed( const char * data , std::size_t size )
+        {
+            if ( this->state != State::PARSING )
+                return false;
+            this->total_size += size;
+            if ( this->total_size > MAX_RESPONSE_SIZE )
+            {
+                this->state = State::OVERSIZE;
+                return false;
+            }
+            for ( std::size_t i = 0 ; i < size ; i++ )
+            {
+                if ( this->scan( data[i] ) == false )
+                {
+                    this->state = State::MALFORMED;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        State get_state( void ) const
+        {
+            return this->state;
+        }
+
+        //whole document received and closed
+        bool complete( void ) const
+        {
+            return ( this->state == State::PARSING ) && this->root_closed && ( this->in_string == false );
+        }
+
+        //index 0:puzzle,index 1:solution
+        bool has_string( std::size_t index ) const
+        {
+            return this->string_size[index] == STRING_SIZE;
+        }
+
+        std::string get_string( std::size_t index ) const
+        {
+            return std::string( this->strings[index].data() , this->string_size[index] );
+        }
+    private:
+        enum class Role:std::uint32_t
+        {
+            IGNORE = 0,
+            KEY,
+            DESC_ELEMENT
+        };
+
+        bool scan( char c )
+        {
+            if ( this->in_string )
+            {
+                if ( this->escape )
+                {
+                    this->escape = false;
+                    //puzzle never contains escape,the element is not a puzzle
+                    if ( this->string_role == Role::DESC_ELEMENT )
+                        this->string_size[ this->desc_index ] = STRING_SIZE + 1;
+                    return true;
+                }
+                if ( c == '\\' )
+                {
+                    this->escape = true;
+                    return true;
+                }
+                if ( c == '"' )
+                {
+                    this->in_string = false;
+                    if ( this->string_role == Role::KEY )
+                    {
+                        this->key_is_desc = ( this->key_size == 4 ) && ( std::memcmp( this->key.data() , "desc" , 4 ) == 0 );
+                    }
+                    return true;
+                }
+                if ( this->string_role == Role::KEY )
+                {
+                    if ( this->key_size < this->key.size() )
+                        this->key[ this->key_size ] = c;
+                    this->key_size++;
+                }
+                else if ( this->string_role == Role::DESC_ELEMENT )
+                {
+                    std::size_t& element_size = this->string_size[ this->desc_index ];
+                    if ( element_size < STRING_SIZE )
+                        this->strings[ this->desc_index ][ element_size ] = c;
+                    //overlong element is marked by size > STRING_SIZE
+                    if ( element_size <= STRING_SIZE )
+                        element_size++;
+                }
+                return true;
+            }
+
+            switch ( c )
+            {
+                case ' ':
+                case '\t':
+                case '\r':
+                case '\n':
+                    return true;
+                case '"':
+                {
+                    if ( ( this->depth == 0 ) || this->root_closed )
+                        return false;
+                    this->in_string = true;
+                    this->string_role = Role::IGNORE;
+                    if ( ( this->depth == 1 ) && ( this->stack[0] == '{' ) && this->expect_key )
+                    {
+                        this->string_role = Role::KEY;
+                        this->key_size = 0;
+                    }
+                    else if ( ( this->desc_depth != 0 ) && ( this->depth == this->desc_depth ) && ( this->desc_index < 2 ) )
+                    {
+                        this->string_role = Role::DESC_ELEMENT;
+                        this->string_size[ this->desc_index ] = 0;
+                    }
+                    return true;
+                }
+                case '{':
+                case '[':
+                {
+                    if ( this->root_closed || ( this->depth == MAX_DEPTH ) )
+                        return false;
+                    if ( ( c == '[' ) && ( this->depth == 1 ) && ( this->stack[0] == '{' ) && this->key_is_desc && ( this->expect_key == false ) )
+                    {
+                        this->desc_depth = this->depth + 1;
+                        this->desc_index = 0;
+                    }
+                    this->stack[ this->depth++ ] = c;
+                    this->expect_key = ( c == '{' );
+                    return true;
+                }
+                case '}':
+                case ']':
+                {
+                    if ( this->depth == 0 )
+                        return false;
+                    if ( this->stack[ this->depth - 1 ] != ( ( c == '}' ) ? '{' : '[' ) )
+                        return false;
+                    if ( this->depth == this->desc_depth )
+                        this->desc_depth = 0;
+                    this->depth--;
+                    this->expect_key = false;
+                    if ( this->depth == 0 )
+                        this->root_closed = true;
+                    return true;
+                }
+                case ':':
+                {
+                    if ( ( this->depth == 0 ) || ( this->stack[ this->depth - 1 ] != '{' ) )
+                        return false;
+                    this->expect_key = false;
+                    return true;
+                }
+                case ',':
+                {
+                    if ( this->depth == 0 )
+                        return false;
+                    if ( this->stack[ this->depth - 1 ] == '{' )
+                    {
+                        this->expect_key = true;
+                        if ( this->depth == 1 )
+                            this->key_is_desc = false;
+                    }
+                    else if ( this->depth == this->desc_depth )
+                    {
+                        this->desc_index++;
+                    }
+                    return true;
+                }
+                default:
+                {
+                    //numbers,true,false,null
+                    if ( ( this->depth == 0 ) || this->root_closed )
+                        return false;
+                    return ( ( c >= '0' ) && ( c <= '9' ) ) || ( c == '-' ) || ( c == '+' ) || ( c == '.' ) ||
+                           ( ( c >= 'a' ) && ( c <= 'z' ) ) || ( c == 'E' );
+                }
+            }
+        }
+
+        State state;
+        std::size_t total_size;
+        std::array< char , MAX_DEPTH > stack;
+        std::size_t depth;
+        bool root_closed;
+        bool in_string;
+        bool escape;
+        bool expect_key;
+        Role string_role;
+        std::array< char , 8 > key;
+        std::size_t key_size;
+        bool key_is_desc;
+        std::size_t desc_depth;
+        std::size_t desc_index;
+        std::array< std::array< char , STRING_SIZE > , 2 > strings;
+        std::array< std::size_t , 2 > string_size;
+};
+
+static std::size_t get_json_callback( char * content , std::size_t size , std::size_t element_number , void * save_ptr )
+{
+    std::size_t realsize = size*element_number;
+    LevelResponseParser * parser = static_cast<LevelResponseParser *>( save_ptr );
+    //return short count abort the transfer
+    if ( parser->feed( content , realsize ) == false )
+        return 0;
+    return realsize;
+}
+
+//what may abort one transfer:fetcher shutdown,and the cancel of the request being served
+struct TransferAbort
+{
+    const std::atomic<bool> * stop;
+    std::shared_ptr< const std::atomic<bool> > cancel;
+
+    bool is_set( void ) const noexcept( true )
+    {
+        return this->stop->load( std::memory_order_relaxed ) ||
+               ( this->cancel && this->cancel->load( std::memory_order_relaxed ) );
+    }
+};
+
+//progress callback,non zero abort curl_easy_perform:shutdown and cancel never wait a stalled transfer out
+static int abort_on_stop( void * abort_ptr , curl_off_t , curl_off_t , curl_off_t , curl_off_t )
+{
+    return static_cast<const TransferAbort *>( abort_ptr )->is_set() ? 1 : 0;
+}
+
+//the handle keep alive in fetcher worker,libcurl reuse the connection between call
+static NetworkPuzzle download_puzzle( CURL * curl_handle , const std::string& api_url , SUDOKU_LEVEL level ) noexcept( false )
+{
+    SUDOKU_TRACE_SCOPE( "download_puzzle" );
+    static MetricGauge& pending = metrics().gauge( "fetch.pending" );
+    static MetricHistogram& download_us = metrics().histogram( "fetch.download_us" );
+    MetricGaugeScope in_flight( pending );
+    MetricTimer timer( download_us );
+    std::string except_message( __func__ );
+
+    //API:https://sudoku.com/api/getLevel/$(Level)
+    std::string level_url( api_url + level_to_string( level ) );
+
+    LevelResponseParser parser;
+    char error_buff[CURL_ERROR_SIZE];
+    //c str* safe
+    error_buff[0] = '\0';
+
+    curl_easy_setopt( curl_handle , CURLOPT_URL , level_url.c_str() );
+    curl_easy_setopt( curl_handle , CURLOPT_WRITEDATA , &parser );
+    curl_easy_setopt( curl_handle , CURLOPT_ERRORBUFFER , error_buff );
+    CURLcode res = curl_easy_perform( curl_handle );
+    if ( parser.get_state() == LevelResponseParser::State::OVERSIZE )
+    {
+        except_message += ":network response exceed " + std::to_string( LevelResponseParser::MAX_RESPONSE_SIZE ) + " bytes";
+        throw std::length_error( except_message );
+    }
+    if ( parser.get_state() == LevelResponseParser::State::MALFORMED )
+    {
+        except_message += ":network json format does not meet expectations";
+        throw std::invalid_argument( except_message );
+    }
+    if ( res != CURLE_OK )
+    {
+        except_message += ":get network puzzle failure,libcurl error message:";
+        except_message += ( error_buff[0] != '\0' ) ? error_buff : curl_easy_strerror( res );
+        throw std::runtime_error( except_message );
+    }
+    if ( parser.complete() == false )
+    {
+        except_message += ":network json truncated";
+        throw std::invalid_argument( except_message );
+    }
+    if ( parser.has_string( 0 ) == false )
+    {
+        except_message += ":network json don't exist puzzle";
+        throw std::invalid_argument( except_message );
+    }
+    std::string puzzle_str( parser.get_string( 0 ) );
+
+    NetworkPuzzle result;
+    result.puzzle = string_to_puzzle( puzzle_str );
+    result.has_solution = false;
+    if ( check_puzzle( result.puzzle ) == false )
+    {
+        except_message += ":puzzle:'";
+        except_message += puzzle_str;
+        except_message += "' illegal";
+        throw std::invalid_argument( except_message );
+    }
+
+    //server solution is optional,just ignore it if it's wrong
+    if ( parser.has_string( 1 ) )
+    {
+        result.solution = string_to_puzzle( parser.get_string( 1 ) );
+        result.has_solution = check_solution( result.puzzle , result.solution );
+    }
+
+    return result;
+}
+
+PuzzleFetcher::PuzzleFetcher( std::string api_url , std::filesystem::path cache_dir , std::size_t prefetch_depth ) noexcept( false ):
+    api_url( std::move( api_url ) ),
+    cache_dir( std::move( cache_dir ) ),
+    prefetch_depth( prefetch_depth ),
+    stop( false ),
+    offline_until()
+{
+    this->active_levels.fill( false );
+    this->cache_loaded.fill( false );
+    this->worker = std::thread( &PuzzleFetcher::worker_loop , this );
+}
+
+PuzzleFetcher::~PuzzleFetcher()
+{
+    {
+        std::lock_guard<std::mutex> lock( this->mutex );
+        this->stop = true;
+    }
+    this->condition.notify_all();
+    if ( this->worker.joinable() )
+    {
+        this->worker.join();
+    }
+}
+
+std::shared_future<NetworkPuzzle> PuzzleFetcher::fetch( SUDOKU_LEVEL level , std::shared_ptr< const std::atomic<bool> > cancel ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    if ( level >= SUDOKU_LEVEL::_LEVEL_COUNT )
+    {
+        except_message += ":unknown puzzle level";
+        throw std::out_of_range( except_message );
+    }
+
+    std::size_t index = static_cast<std::size_t>( level );
+    std::promise<NetworkPuzzle> promise;
+    std::shared_future<NetworkPuzzle> puzzle_future = promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock( this->mutex );
+        this->active_levels[index] = true;
+        auto& queue = this->prefetch_queues[index];
+        if ( cancel && cancel->load( std::memory_order_relaxed ) )
+        {
+            //nobody wait the result,keep the prefetched puzzle
+            except_message += ":fetch cancelled";
+            promise.set_exception( std::make_exception_ptr( std::runtime_error( except_message ) ) );
+        }
+        else if ( queue.empty() == false )
+        {
+            //prefetch hit,don't wait network
+            promise.set_value( queue.front() );
+            queue.pop_front();
+        }
+        else
+        {
+            this->requests.push_back( { level , std::move( promise ) , std::move( cancel ) } );
+        }
+    }
+    //wakeup worker,serve request or refill prefetch queue
+    this->condition.notify_all();
+
+    return puzzle_future;
+}
+
+std::filesystem::path PuzzleFetcher::default_cache_dir( void ) noexcept( true )
+{
+    const char * xdg_cache = std::getenv( "XDG_CACHE_HOME" );
+    if ( ( xdg_cache != nullptr ) && ( xdg_cache[0] != '\0' ) )
+    {
+        return std::filesystem::path( xdg_cache ) / "sudoku-gtkmm";
+    }
+    const char * home = std::getenv( "HOME" );
+    if ( ( home != nullptr ) && ( home[0] != '\0' ) )
+    {
+        return std::filesystem::path( home ) / ".cache" / "sudoku-gtkmm";
+    }
+    return std::filesystem::path( ".cache" );
+}
+
+void PuzzleFetcher::worker_loop( void )
+{
+    constexpr long connect_timeout = 10L;
+    constexpr long default_timeout = 30L;
+    constexpr int max_retry = 4;
+    //network failure,pause prefetch
+    constexpr std::chrono::seconds offline_backoff( 60 );
+
+    std::shared_ptr<CURL> curl_handle( curl_easy_init() , curl_easy_cleanup );
+    if ( curl_handle.get() != nullptr )
+    {
+        curl_easy_setopt( curl_handle.get() , CURLOPT_VERBOSE , 0L );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_FOLLOWLOCATION , 1L );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_USE_SSL , 1L );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_NOPROGRESS , 0L );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_XFERINFOFUNCTION , abort_on_stop );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_NOSIGNAL , 1L );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_TCP_KEEPALIVE , 1L );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_CONNECTTIMEOUT , connect_timeout );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_TIMEOUT , default_timeout );
+        curl_easy_setopt( curl_handle.get() , CURLOPT_WRITEFUNCTION , get_json_callback );
+    }
+
+    std::unique_lock<std::mutex> lock( this->mutex );
+    while ( true )
+    {
+        //find work:request first,then the shortest prefetch queue
+        bool is_request = false;
+        std::size_t prefetch_level = LEVEL_COUNT;
+        auto find_work = [ this , &is_request , &prefetch_level ]()
+        {
+            if ( this->stop )
+                return true;
+            //caller gone before the download started
+            while ( ( this->requests.empty() == false ) && this->requests.front().is_cancelled() )
+                this->requests.pop_front();
+            if ( this->requests.empty() == false )
+            {
+                is_request = true;
+                return true;
+            }
+            if ( std::chrono::steady_clock::now() < this->offline_until )
+                return false;
+            std::size_t min_size = this->prefetch_depth;
+            for ( std::size_t i = 0 ; i < LEVEL_COUNT ; i++ )
+            {
+                if ( this->active_levels[i] && ( this->prefetch_queues[i].size() < min_size ) )
+                {
+                    min_size = this->prefetch_queues[i].size();
+                    prefetch_level = i;
+                }
+            }
+            return ( prefetch_level != LEVEL_COUNT );
+        };
+        while ( find_work() == false )
+        {
+            //prefetch resume by itself once the offline backoff end
+            if ( std::chrono::steady_clock::now() < this->offline_until )
+                this->condition.wait_until( lock , this->offline_until );
+            else
+                this->condition.wait( lock );
+        }
+        if ( this->stop )
+            break;
+
+        SUDOKU_LEVEL level = is_request ? this->requests.front().level : static_cast<SUDOKU_LEVEL>( prefetch_level );
+        bool offline = ( std::chrono::steady_clock::now() < this->offline_until );
+        TransferAbort transfer_abort = { &this->stop , is_request ? this->requests.front().cancel : nullptr };
+        lock.unlock();
+        if ( curl_handle.get() != nullptr )
+            curl_easy_setopt( curl_handle.get() , CURLOPT_XFERINFODATA , &transfer_abort );
+
+        NetworkPuzzle puzzle;
+        bool success = false;
+        std::exception_ptr failure;
+        //request retry with backoff,prefetch and request during offline only try once
+        int retry = ( is_request && ( offline == false ) ) ? max_retry : 1;
+        std::chrono::milliseconds backoff( 500 );
+        for ( int i = 0 ; i < retry ; i++ )
+        {
+            try
+            {
+                if ( curl_handle.get() == nullptr )
+                {
+                    throw std::runtime_error( "libcurl easy initial failure" );
+                }
+                puzzle = download_puzzle( curl_handle.get() , this->api_url , level );
+                success = true;
+                break;
+            }
+            catch( const std::exception& )
+            {
+                failure = std::current_exception();
+            }
+            if ( transfer_abort.is_set() )
+                break;
+            if ( i + 1 < retry )
+            {
+                //cancel is not notified,it is seen at the latest when the backoff end
+                std::unique_lock<std::mutex> wait_lock( this->mutex );
+                if ( this->condition.wait_for( wait_lock , backoff , [ &transfer_abort ](){ return transfer_abort.is_set(); } ) )
+                    break;
+                backoff *= 2;
+            }
+        }
+        //aborted by the progress callback,not a network failure
+        bool aborted = ( success == false ) && transfer_abort.is_set();
+
+        if ( success )
+        {
+            this->save_cache( level , puzzle );
+        }
+        else if ( is_request && ( aborted == false ) )
+        {
+            //offline,play cached puzzle
+            try
+            {
+                puzzle = this->take_cached( level );
+                success = true;
+            }
+            catch( const std::exception& )
+            {
+                ;
+            }
+        }
+
+        lock.lock();
+        if ( this->stop )
+            break;
+        if ( ( success == false ) && ( aborted == false ) )
+        {
+            this->offline_until = std::chrono::steady_clock::now() + offline_backoff;
+        }
+        if ( is_request )
+        {
+            FetchRequest request = std::move( this->requests.front() );
+            this->requests.pop_front();
+            //cancelled while downloading:the puzzle serve the next fetch instead
+            if ( request.is_cancelled() )
+                is_request = false;
+            else if ( success )
+                request.promise.set_value( puzzle );
+            else
+                request.promise.set_exception( failure );
+        }
+        if ( ( is_request == false ) && success )
+        {
+            this->prefetch_queues[ static_cast<std::size_t>( level ) ].push_back( puzzle );
+        }
+    }
+}
+
+NetworkPuzzle PuzzleFetcher::take_cached( SUDOKU_LEVEL level ) noexcept( false )
+{
+    std::string except_message( __func__ );
+
+    this->load_cache( level );
+    auto& cache = this->cache_puzzles[ static_cast<std::size_t>( level ) ];
+    if ( cache.empty() )
+    {
+        except_message += ":network unavailable and " + level_to_string( level ) + " puzzle cache is empty";
+        throw std::runtime_error( except_message );
+    }
+
+    std::random_device rand_div;
+    std::mt19937 rand_gen( rand_div() );
+    std::uniform_int_distribution<std::size_t> index_dist( 0 , cache.size() - 1 );
+    return cache[ index_dist( rand_gen ) ];
+}
+
+void PuzzleFetcher::load_cache( SUDOKU_LEVEL level )
+{
+    std::size_t index = static_cast<std::size_t>( level );
+    if ( this->cache_loaded[index] )
+        return ;
+    this->cache_loaded[index] = true;
+
+    //$(level).cache,every line:"$(puzzle) $(solution)"
+    std::ifstream cache_file( this->cache_dir / ( level_to_string( level ) + ".cache" ) );
+    std::string puzzle_string;
+    std::string solution_string;
+    while ( cache_file >> puzzle_string >> solution_string )
+    {
+        NetworkPuzzle puzzle;
+        puzzle.puzzle = string_to_puzzle( puzzle_string );
+        puzzle.solution = string_to_puzzle( solution_string );
+        puzzle.has_solution = check_solution( puzzle.puzzle , puzzle.solution );
+        //cached puzzle always come with a valid solution,drop broken line
+        if ( puzzle.has_solution )
+        {
+            this->cache_puzzles[index].push_back( puzzle );
+        }
+    }
+}
+
+void PuzzleFetcher::save_cache( SUDOKU_LEVEL level , const NetworkPuzzle& puzzle )
+{
+    if ( puzzle.has_solution == false )
+        return ;
+
+    std::size_t index = static_cast<std::size_t>( level );
+    this->load_cache( level );
+    auto& cache = this->cache_puzzles[index];
+    if ( std::find_if( cache.begin() , cache.end() ,
+            [ &puzzle ]( const NetworkPuzzle& cached ){ return cached.puzzle == puzzle.puzzle; } ) != cache.end() )
+    {
+        return ;
+    }
+    cache.push_back( puzzle );
+
+    auto to_line = []( const NetworkPuzzle& cached )
+    {
+        std::string line;
+        for ( auto& row : cached.puzzle )
+            for ( auto cell : row )
+                line += static_cast<char>( '0' + cell );
+        line += ' ';
+        for ( auto& row : cached.solution )
+            for ( auto cell : row )
+                line += static_cast<char>( '0' + cell );
+        line += '\n';
+        return line;
+    };
+
+    //cache directory unwritable is not a error,the puzzle still in memory.
+    std::error_code error;
+    std::filesystem::create_directories( this->cache_dir , error );
+    std::filesystem::path cache_path( this->cache_dir / ( level_to_string( level ) + ".cache" ) );
+    if ( cache.size() > CACHE_CAPACITY )
+    {
+        //drop oldest half,rewrite file
+        cache.erase( cache.begin() , cache.begin() + cache.size() - CACHE_CAPACITY/2 );
+        std::ofstream cache_file( cache_path , std::ios::trunc );
+        for ( auto& cached : cache )
+        {
+            cache_file << to_line( cached );
+        }
+    }
+    else
+    {
+        std::ofstream cache_file( cache_path , std::ios::app );
+        cache_file << to_line( puzzle );
+    }
+}
+
+std::shared_future<NetworkPuzzle> get_network_puzzle( SUDOKU_LEVEL level , std::shared_ptr< const std::atomic<bool> > cancel ) noexcept( false )
+{
+    //api url can be override,e.g. local mirror server
+    static PuzzleFetcher fetcher( ( std::getenv( "SUDOKU_API_URL" ) != nullptr ) ?
+                                  std::string( std::getenv( "SUDOKU_API_URL" ) ) :
+                                  std::string( "https://sudoku.com/api/getLevel/" ) );
+    return fetcher.fetch( level , std::move( cancel ) );
+}
@@ -0,0 +1,96 @@
+#pragma once
+#ifndef PUZZLEFETCHER_H
+#define PUZZLEFETCHER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sudoku.h"
+
+struct NetworkPuzzle
+{
+    puzzle_t puzzle;
+    //server provided solution,only meaningful when has_solution == true
+    puzzle_t solution;
+    bool has_solution;
+};
+
+//long-lived puzzle downloader
+//one worker thread own one curl easy handle,all request reuse the connection(and TLS session).
+//every requested level keep a bounded prefetch queue,
+//every fetched puzzle append to the disk cache,if network unavailable take puzzle from disk cache.
+class PuzzleFetcher
+{
+    public:
+        //api_url + level_to_string( level ) is request url
+        PuzzleFetcher( std::string api_url = "https://sudoku.com/api/getLevel/" ,
+                       std::filesystem::path cache_dir = default_cache_dir() ,
+                       std::size_t prefetch_depth = 2 ) noexcept( false );
+        PuzzleFetcher( const PuzzleFetcher& ) = delete;
+        PuzzleFetcher& operator=( const PuzzleFetcher& ) = delete;
+        ~PuzzleFetcher();
+
+        //cancel set by the caller when it stop waiting:a queued request is dropped,
+        //a download for it is aborted( retries included ),a puzzle already downloaded go to the prefetch queue
+        std::shared_future<NetworkPuzzle> fetch( SUDOKU_LEVEL level , std::shared_ptr< const std::atomic<bool> > cancel = nullptr ) noexcept( false );
+
+        //$XDG_CACHE_HOME/sudoku-gtkmm or $HOME/.cache/sudoku-gtkmm
+        static std::filesystem::path default_cache_dir( void ) noexcept( true );
+    private:
+        static constexpr std::size_t LEVEL_COUNT = static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT );
+        //disk cache entries limits( every level )
+        static constexpr std::size_t CACHE_CAPACITY = 512;
+
+        void worker_loop( void );
+        NetworkPuzzle take_cached( SUDOKU_LEVEL level ) noexcept( false );
+        void load_cache( SUDOKU_LEVEL level );
+        void save_cache( SUDOKU_LEVEL level , const NetworkPuzzle& puzzle );
+
+        std::string api_url;
+        std::filesystem::path cache_dir;
+        std::size_t prefetch_depth;
+
+        struct FetchRequest
+        {
+            SUDOKU_LEVEL level;
+            std::promise<NetworkPuzzle> promise;
+            std::shared_ptr< const std::atomic<bool> > cancel;
+
+            bool is_cancelled( void ) const noexcept( true )
+            {
+                return this->cancel && this->cancel->load( std::memory_order_relaxed );
+            }
+        };
+
+        std::mutex mutex;
+        std::condition_variable condition;
+        //written under mutex,read without it by the curl progress callback to abort a transfer
+        std::atomic<bool> stop;
+        //after network failure don't prefetch until this time
+        std::chrono::steady_clock::time_point offline_until;
+        std::deque<FetchRequest> requests;
+        std::array< std::deque<NetworkPuzzle> , LEVEL_COUNT > prefetch_queues;
+        //level requested at least once,worker keep its prefetch queue full
+        std::array< bool , LEVEL_COUNT > active_levels;
+
+        //disk cache,only access in worker thread
+        std::array< std::vector<NetworkPuzzle> , LEVEL_COUNT > cache_puzzles;
+        std::array< bool , LEVEL_COUNT > cache_loaded;
+
+        std::thread worker;
+};
+
+std::shared_future<NetworkPuzzle> get_network_puzzle( SUDOKU_LEVEL level , std::shared_ptr< const std::atomic<bool> > cancel = nullptr ) noexcept( false );
+
+#endif
@@ -0,0 +1,527 @@
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dancinglinks.h"
+#include "gridkernel.h"
+#include "puzzleimport.h"
+
+static constexpr std::size_t CELL_NUMBER = SUDOKU_SIZE*SUDOKU_SIZE;
+static constexpr std::uint16_t ALL_CANDIDATES = ( 1 << SUDOKU_SIZE ) - 1;
+//caller thread report progress every this many checked puzzle
+static constexpr std::size_t PROGRESS_STEP = 64;
+
+static bool is_cell_char( char c )
+{
+    return ( ( c >= '0' ) && ( c <= '9' ) ) || ( c == '.' );
+}
+
+static cell_t cell_value( char c )
+{
+    return ( c == '.' ) ? 0 : static_cast<cell_t>( c - '0' );
+}
+
+static bool is_token_separator( char c )
+{
+    return ( c == ' ' ) || ( c == '\t' ) || ( c == '\r' ) || ( c == ',' ) || ( c == ';' ) || ( c == ':' );
+}
+
+std::vector<ParsedPuzzle> parse_puzzles( const std::string& text ) noexcept( false )
+{
+    std::vector<ParsedPuzzle> puzzles;
+    //grid layout in progress
+    puzzle_t grid = { { 0 } };
+    std::size_t grid_rows = 0;
+    std::size_t grid_line = 0;
+
+    std::size_t line_number = 0;
+    std::size_t begin = 0;
+    while ( begin <= text.size() )
+    {
+        std::size_t end = text.find( '\n' , begin );
+        if ( end == std::string::npos )
+            end = text.size();
+        line_number++;
+        const char * line = text.data() + begin;
+        std::size_t length = end - begin;
+        begin = end + 1;
+
+        std::size_t first = 0;
+        while ( ( first < length ) && is_token_separator( line[first] ) )
+        {
+            first++;
+        }
+        if ( ( first == length ) || ( line[first] == '#' ) )
+            continue;
+
+        //one line puzzle
+        bool found = false;
+        for ( std::size_t token = first ; ( token < length ) && ( found == false ) ; )
+        {
+            std::size_t token_end = token;
+            while ( ( token_end < length ) && ( is_token_separator( line[token_end] ) == false ) )
+            {
+                token_end++;
+            }
+            if ( ( token_end - token == CELL_NUMBER ) && std::all_of( line + token , line + token_end , is_cell_char ) )
+            {
+                ParsedPuzzle parsed = { { { 0 } } , line_number };
+                for ( std::size_t index = 0 ; index < CELL_NUMBER ; index++ )
+                {
+                    parsed.puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = cell_value( line[token + index] );
+                }
+                puzzles.push_back( parsed );
+                found = true;
+            }
+            token = token_end;
+            while ( ( token < length ) && is_token_separator( line[token] ) )
+            {
+                token++;
+            }
+        }
+        if ( found )
+        {
+            grid_rows = 0;
+            continue;
+        }
+
+        //grid row:exactly SUDOKU_SIZE cells,separator line without cell keep the grid going
+        std::size_t cells = std::count_if( line , line + length , is_cell_char );
+        if ( cells == 0 )
+            continue;
+        if ( cells != SUDOKU_SIZE )
+        {
+            grid_rows = 0;
+            continue;
+        }
+        if ( grid_rows == 0 )
+            grid_line = line_number;
+        std::size_t column = 0;
+        for ( std::size_t i = 0 ; i < length ; i++ )
+        {
+            if ( is_cell_char( line[i] ) )
+                grid[grid_rows][column++] = cell_value( line[i] );
+        }
+        if ( ++grid_rows == SUDOKU_SIZE )
+        {
+            puzzles.push_back( { grid , grid_line } );
+            grid_rows = 0;
+        }
+    }
+    return puzzles;
+}
+
+//units[0-8] row,[9-17] column,[18-26] box;cell index:x*SUDOKU_SIZE + y
+struct GradeTables
+{
+    std::array< std::array< std::uint8_t , SUDOKU_SIZE > , 3*SUDOKU_SIZE > units;
+    std::array< std::array< std::uint8_t , 2*( SUDOKU_SIZE - 1 ) + ( SUDOKU_BOX_SIZE - 1 )*( SUDOKU_BOX_SIZE - 1 ) > , CELL_NUMBER > peers;
+};
+
+static const GradeTables& get_grade_tables( void )
+{
+    static const GradeTables tables = []()
+    {
+        GradeTables built;
+        for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+        {
+            for ( std::size_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+            {
+                std::size_t box = ( i/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + j/SUDOKU_BOX_SIZE;
+                std::size_t box_cell = ( i%SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + j%SUDOKU_BOX_SIZE;
+                built.units[i][j] = i*SUDOKU_SIZE + j;
+                built.units[SUDOKU_SIZE + j][i] = i*SUDOKU_SIZE + j;
+                built.units[2*SUDOKU_SIZE + box][box_cell] = i*SUDOKU_SIZE + j;
+            }
+        }
+        for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+        {
+            std::size_t x = cell/SUDOKU_SIZE;
+            std::size_t y = cell%SUDOKU_SIZE;
+            std::size_t count = 0;
+            for ( std::size_t other = 0 ; other < CELL_NUMBER ; other++ )
+            {
+                std::size_t ox = other/SUDOKU_SIZE;
+                std::size_t oy = other%SUDOKU_SIZE;
+                bool same_box = ( ox/SUDOKU_BOX_SIZE == x/SUDOKU_BOX_SIZE ) && ( oy/SUDOKU_BOX_SIZE == y/SUDOKU_BOX_SIZE );
+                if ( ( other != cell ) && ( ( ox == x ) || ( oy == y ) || same_box ) )
+                    built.peers[cell][count++] = other;
+            }
+        }
+        return built;
+    }();
+    return tables;
+}
+
+namespace
+{
+    //candidate k in bit k - 1
+    class GradeBoard
+    {
+        public:
+            explicit GradeBoard( const puzzle_t& puzzle ):
+                tables( get_grade_tables() ),
+                empty_cells( CELL_NUMBER )
+            {
+                this->values.fill( 0 );
+                this->masks.fill( ALL_CANDIDATES );
+                for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+                {
+                    cell_t value = puzzle[cell/SUDOKU_SIZE][cell%SUDOKU_SIZE];
+                    if ( value != 0 )
+                        this->place( cell , value );
+                }
+            }
+
+            bool is_solved( void ) const
+            {
+                return this->empty_cells == 0;
+            }
+
+            //empty cell without candidate
+            bool is_broken( void ) const
+            {
+                for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+                {
+                    if ( ( this->values[cell] == 0 ) && ( this->masks[cell] == 0 ) )
+                        return true;
+                }
+                return false;
+            }
+
+            bool naked_single( void )
+            {
+                for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+                {
+                    std::uint16_t mask = this->masks[cell];
+                    if ( ( this->values[cell] == 0 ) && ( mask != 0 ) && ( ( mask & ( mask - 1 ) ) == 0 ) )
+                    {
+                        this->place( cell , lowest_digit( mask ) );
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool hidden_single( void )
+            {
+                for ( const auto& unit : this->tables.units )
+                {
+                    for ( cell_t digit = 1 ; digit <= SUDOKU_SIZE ; digit++ )
+                    {
+                        std::uint16_t bit = 1 << ( digit - 1 );
+                        std::size_t count = 0;
+                        std::size_t last = 0;
+                        for ( std::uint8_t cell : unit )
+                        {
+                            if ( ( this->values[cell] == 0 ) && ( this->masks[cell] & bit ) )
+                            {
+                                count++;
+                                last = cell;
+                            }
+                        }
+                        if ( count == 1 )
+                        {
+                            this->place( last , digit );
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+
+            //candidates of a digit in one box all in one row/column( pointing ),
+            //or in one row/column all in one box( claiming ),erase the digit from the rest of the other unit
+            bool locked_candidates( void )
+            {
+                bool eliminated = false;
+                for ( std::size_t unit = 0 ; unit < this->tables.units.size() ; unit++ )
+                {
+                    for ( cell_t digit = 1 ; digit <= SUDOKU_SIZE ; digit++ )
+                    {
+                        std::uint16_t bit = 1 << ( digit - 1 );
+                        std::bitset< 3*SUDOKU_SIZE > shared;
+                        shared.set();
+                        std::size_t count = 0;
+                        for ( std::uint8_t cell : this->tables.units[unit] )
+                        {
+                            if ( ( this->values[cell] == 0 ) && ( this->masks[cell] & bit ) )
+                            {
+                                count++;
+                                shared &= this->unit_bits( cell );
+                            }
+                        }
+                        if ( count < 2 )
+                            continue;
+                        shared.reset( unit );
+                        for ( std::size_t other = 0 ; other < shared.size() ; other++ )
+                        {
+                            if ( shared.test( other ) == false )
+                                continue;
+                            for ( std::uint8_t cell : this->tables.units[other] )
+                            {
+                                if ( ( this->values[cell] == 0 ) && ( this->masks[cell] & bit ) && ( this->unit_bits( cell ).test( unit ) == false ) )
+                                {
+                                    this->masks[cell] &= ~bit;
+                                    eliminated = true;
+                                }
+                            }
+                        }
+                        if ( eliminated )
+                            return true;
+                    }
+                }
+                return false;
+            }
+
+            //two cells of a unit with the same two candidates,erase them from the rest of the unit
+            bool naked_pair( void )
+            {
+                for ( const auto& unit : this->tables.units )
+                {
+                    for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+                    {
+                        std::uint16_t mask = this->masks[unit[i]];
+                        if ( ( this->values[unit[i]] != 0 ) || ( popcount( mask ) != 2 ) )
+                            continue;
+                        for ( std::size_t j = i + 1 ; j < SUDOKU_SIZE ; j++ )
+                        {
+                            if ( ( this->values[unit[j]] != 0 ) || ( this->masks[unit[j]] != mask ) )
+                                continue;
+                            bool eliminated = false;
+                            for ( std::size_t k = 0 ; k < SUDOKU_SIZE ; k++ )
+                            {
+                                std::uint8_t cell = unit[k];
+                                if ( ( k != i ) && ( k != j ) && ( this->values[cell] == 0 ) && ( this->masks[cell] & mask ) )
+                                {
+                                    this->masks[cell] &= ~mask;
+                                    eliminated = true;
+                                }
+                            }
+                            if ( eliminated )
+                                return true;
+                        }
+                    }
+                }
+                return false;
+            }
+        private:
+            void place( std::size_t cell , cell_t value )
+            {
+                std::uint16_t bit = 1 << ( value - 1 );
+                this->values[cell] = value;
+                this->masks[cell] = 0;
+                this->empty_cells--;
+                for ( std::uint8_t peer : this->tables.peers[cell] )
+                {
+                    this->masks[peer] &= ~bit;
+                }
+            }
+
+            std::bitset< 3*SUDOKU_SIZE > unit_bits( std::size_t cell ) const
+            {
+                std::size_t x = cell/SUDOKU_SIZE;
+                std::size_t y = cell%SUDOKU_SIZE;
+                std::bitset< 3*SUDOKU_SIZE > bits;
+                bits.set( x );
+                bits.set( SUDOKU_SIZE + y );
+                bits.set( 2*SUDOKU_SIZE + ( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + y/SUDOKU_BOX_SIZE );
+                return bits;
+            }
+
+            static std::size_t popcount( std::uint16_t mask )
+            {
+                return std::bitset<16>( mask ).count();
+            }
+
+            static cell_t lowest_digit( std::uint16_t mask )
+            {
+                cell_t digit = 1;
+                while ( ( mask & 1 ) == 0 )
+                {
+                    mask >>= 1;
+                    digit++;
+                }
+                return digit;
+            }
+
+            const GradeTables& tables;
+            std::array< cell_t , CELL_NUMBER > values;
+            std::array< std::uint16_t , CELL_NUMBER > masks;
+            std::size_t empty_cells;
+    };
+}
+
+SUDOKU_LEVEL grade_puzzle( const puzzle_t& puzzle ) noexcept( true )
+{
+    GradeBoard board( puzzle );
+    SUDOKU_LEVEL level = SUDOKU_LEVEL::EASY;
+    //easiest technique first,start over after every progress
+    while ( board.is_solved() == false )
+    {
+        if ( board.is_broken() )
+            return SUDOKU_LEVEL::EXPERT;
+        if ( board.naked_single() )
+            continue;
+        if ( board.hidden_single() )
+        {
+            level = std::max( level , SUDOKU_LEVEL::MEDIUM );
+            continue;
+        }
+        if ( board.locked_candidates() || board.naked_pair() )
+        {
+            level = SUDOKU_LEVEL::HARD;
+            continue;
+        }
+        return SUDOKU_LEVEL::EXPERT;
+    }
+    return level;
+}
+
+static std::size_t resolve_worker_number( std::size_t worker_number , std::size_t job_number )
+{
+    if ( worker_number == 0 )
+        worker_number = std::max( 1U , std::thread::hardware_concurrency() );
+    return std::max<std::size_t>( 1 , std::min( worker_number , job_number ) );
+}
+
+static bool is_cancelled( const std::atomic<bool> * cancel )
+{
+    return ( cancel != nullptr ) && cancel->load( std::memory_order_relaxed );
+}
+
+ImportReport import_puzzles( const std::string& text , std::size_t worker_number ,
+                             const std::atomic<bool> * cancel ,
+                             std::function<void( double )> on_progress ) noexcept( false )
+{
+    std::vector<ParsedPuzzle> parsed = parse_puzzles( text );
+    std::size_t count = parsed.size();
+    //legality of the whole corpus by the vector kernel up front,workers only search legal puzzles
+    std::vector<std::uint8_t> legal( count );
+    std::vector<cell_t> cells( GRID_BATCH_BLOCK*SUDOKU_SIZE*SUDOKU_SIZE );
+    for ( std::size_t begin = 0 ; begin < count ; begin += GRID_BATCH_BLOCK )
+    {
+        std::size_t block_count = std::min( GRID_BATCH_BLOCK , count - begin );
+        for ( std::size_t p = 0 ; p < block_count ; p++ )
+        {
+            for ( std::size_t k = 0 ; k < SUDOKU_SIZE*SUDOKU_SIZE ; k++ )
+            {
+                cells[k*block_count + p] = parsed[begin + p].puzzle[k/SUDOKU_SIZE][k%SUDOKU_SIZE];
+            }
+        }
+        grid_scan_batch( cells.data() , block_count , legal.data() + begin , nullptr );
+    }
+    std::vector<ImportVerdict> verdicts( count , ImportVerdict::UNFINISHED );
+    std::vector<ImportedPuzzle> checked( count );
+    std::atomic<std::size_t> next_index( 0 );
+    std::atomic<std::size_t> done( 0 );
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    SolveLimits limits;
+    limits.stop = cancel;
+    limits.node_budget = IMPORT_NODE_BUDGET;
+    auto check = [ & ]( bool report )
+    {
+        std::size_t own_checked = 0;
+        while ( is_cancelled( cancel ) == false )
+        {
+            std::size_t index = next_index++;
+            if ( index >= count )
+                break;
+            try
+            {
+                ImportedPuzzle& imported = checked[index];
+                imported.puzzle = parsed[index].puzzle;
+                imported.line = parsed[index].line;
+                imported.solution = puzzle_t();
+                imported.level = SUDOKU_LEVEL::EXPERT;
+                if ( legal[index] == 0 )
+                {
+                    verdicts[index] = ImportVerdict::ILLEGAL;
+                }
+                else
+                {
+                    //a second solution is enough to refuse it
+                    std::vector<puzzle_t> solutions;
+                    SolveStatus status = Sudoku( imported.puzzle ).get_solution( solutions , 2 , limits );
+                    if ( solutions.size() > 1 )
+                        verdicts[index] = ImportVerdict::MULTIPLE_SOLUTIONS;
+                    else if ( status != SolveStatus::COMPLETE )
+                        verdicts[index] = ImportVerdict::UNFINISHED;
+                    else if ( solutions.empty() )
+                        verdicts[index] = ImportVerdict::NO_SOLUTION;
+                    else
+                    {
+                        verdicts[index] = ImportVerdict::VALID;
+                        imported.solution = solutions[0];
+                        imported.level = grade_puzzle( imported.puzzle );
+                    }
+                }
+            }
+            catch( ... )
+            {
+                std::lock_guard<std::mutex> lock( error_mutex );
+                if ( error == nullptr )
+                    error = std::current_exception();
+                //stop other workers
+                next_index = count;
+                break;
+            }
+            std::size_t finished = ++done;
+            if ( report && on_progress && ( ( ++own_checked%PROGRESS_STEP == 0 ) || ( finished == count ) ) )
+                on_progress( static_cast<double>( finished )/count );
+        }
+    };
+
+    std::vector<std::thread> workers;
+    std::size_t thread_number = resolve_worker_number( worker_number , count );
+    for ( std::size_t i = 1 ; i < thread_number ; i++ )
+    {
+        workers.emplace_back( check , false );
+    }
+    check( true );
+    for ( auto& worker : workers )
+    {
+        worker.join();
+    }
+    if ( error )
+        std::rethrow_exception( error );
+
+    ImportReport report;
+    if ( is_cancelled( cancel ) )
+        return report;
+    report.parsed = count;
+    for ( std::size_t index = 0 ; index < count ; index++ )
+    {
+        switch ( verdicts[index] )
+        {
+            case ImportVerdict::VALID:
+                report.puzzles.push_back( checked[index] );
+                break;
+            case ImportVerdict::ILLEGAL:
+                report.illegal++;
+                break;
+            case ImportVerdict::NO_SOLUTION:
+                report.no_solution++;
+                break;
+            case ImportVerdict::MULTIPLE_SOLUTIONS:
+                report.multiple_solutions++;
+                break;
+            case ImportVerdict::UNFINISHED:
+                report.unfinished++;
+                break;
+        }
+    }
+    return report;
+}
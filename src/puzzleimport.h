@@ -0,0 +1,71 @@
+#pragma once
+#ifndef PUZZLEIMPORT_H
+#define PUZZLEIMPORT_H
+
+#include <cstdint>
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "sudoku.h"
+
+//search node limit of one uniqueness check,pathological input can't stall the import
+constexpr std::uint64_t IMPORT_NODE_BUDGET = 1 << 20;
+
+enum class ImportVerdict:std::uint8_t
+{
+    VALID = 0,
+    //clue repeat in a unit
+    ILLEGAL,
+    NO_SOLUTION,
+    MULTIPLE_SOLUTIONS,
+    //uniqueness not decided within the node budget
+    UNFINISHED
+};
+
+struct ParsedPuzzle
+{
+    puzzle_t puzzle;
+    //1-based line where the puzzle begin
+    std::size_t line;
+};
+
+struct ImportedPuzzle
+{
+    puzzle_t puzzle;
+    puzzle_t solution;
+    //grade_puzzle result
+    SUDOKU_LEVEL level;
+    std::size_t line;
+};
+
+struct ImportReport
+{
+    //valid puzzles in source order
+    std::vector<ImportedPuzzle> puzzles;
+    std::size_t parsed = 0;
+    std::size_t illegal = 0;
+    std::size_t no_solution = 0;
+    std::size_t multiple_solutions = 0;
+    std::size_t unfinished = 0;
+};
+
+//puzzles of text,one of the formats per puzzle:
+//  a line with a whitespace/,/;/: separated 81 character token( puzzle,solution csv take the first )
+//  9 lines of 9 cells,other characters( | - + space ) are separators,lines without cell are skipped
+//cell:1-9,blank:0 or '.',line begin with '#' is a comment
+std::vector<ParsedPuzzle> parse_puzzles( const std::string& text ) noexcept( false );
+
+//hardest technique a logical solver need:naked single EASY,hidden single MEDIUM,
+//locked candidates or naked pair HARD,anything else( guessing ) EXPERT
+SUDOKU_LEVEL grade_puzzle( const puzzle_t& puzzle ) noexcept( true );
+
+//parse,then validate,uniqueness check and grade the puzzles in parallel.
+//on_progress( checked/parsed ) run in the caller thread.cancel return an empty report
+ImportReport import_puzzles( const std::string& text , std::size_t worker_number = 0 ,
+                             const std::atomic<bool> * cancel = nullptr ,
+                             std::function<void( double )> on_progress = nullptr ) noexcept( false );
+
+#endif
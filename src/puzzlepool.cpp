@@ -0,0 +1,82 @@
+#include <array>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <jansson.h>
+
+#include "puzzlepool.h"
+#include "sudoku.h"
+#include "trace.h"
+
+static class LocalPuzzlePool
+{
+public:
+    LocalPuzzlePool() = default;
+    ~LocalPuzzlePool() = default;
+
+    std::string get_puzzle_string( SUDOKU_LEVEL level ) noexcept( true )
+    {
+        std::string result;
+        if ( level >= SUDOKU_LEVEL::_LEVEL_COUNT )
+        {
+            return result;
+        }
+        std::size_t index = static_cast<std::size_t>( level );
+        //parse level file at first use,startup don't pay for the whole corpus
+        std::call_once( this->load_flags[index] , [ this , level , index ]()
+        {
+            std::string file_path( "resource/" + level_to_string( level ) + ".data" );
+            serialization_puzzle( file_path.c_str() , this->puzzle_strings[index] );
+        } );
+
+        const auto& strings = this->puzzle_strings[index];
+        if ( strings.empty() )
+        {
+            return result;
+        }
+        std::random_device rand_div;
+        std::mt19937 rand_gen( rand_div() );
+        std::uniform_int_distribution<std::size_t> index_dist( 0 , strings.size() - 1 );
+        result = strings[ index_dist( rand_gen ) ];
+
+        return result;
+    }
+private:
+    static void serialization_puzzle( const char * file_path , std::vector<std::string>& container_ref )
+    {
+        SUDOKU_TRACE_SCOPE( "LocalPuzzlePool::load" );
+        //level.data:
+        //{
+        //    [
+        //        "006031070437005000010467008029178300000000026300050000805004910003509087790086004",
+        //        ...
+        //    ]
+        //}
+        std::shared_ptr<json_t> root( json_load_file( file_path , 0 , nullptr ) , json_decref );
+        const json_t * rawptr = root.get();
+        if ( ( rawptr != nullptr ) && ( json_is_array( rawptr ) ) )
+        {
+            std::size_t puzzle_size = json_array_size( rawptr );
+            container_ref.reserve( puzzle_size );
+            for ( std::size_t i = 0 ; i < puzzle_size ; i++ )
+            {
+                json_t * puzzle_node = json_array_get( rawptr , i );
+                if ( json_is_string( puzzle_node ) )
+                {
+                    container_ref.push_back( json_string_value( puzzle_node ) );
+                }
+            }
+        }
+    }
+
+    std::array< std::once_flag , static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) > load_flags;
+    std::array< std::vector<std::string> , static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) > puzzle_strings;
+}local_puzzles;
+
+puzzle_t get_local_puzzle( SUDOKU_LEVEL level ) noexcept( true )
+{
+    return string_to_puzzle( local_puzzles.get_puzzle_string( level ) );
+}
@@ -0,0 +1,14 @@
+#pragma once
+#ifndef PUZZLEPOOL_H
+#define PUZZLEPOOL_H
+
+#include "sudoku.h"
+
+#if SUDOKU_SIZE != 9
+    [[deprecated("not implemented")]]
+#endif
+//random puzzle of resource/<level>.data,the level file parsed at first use.
+//empty puzzle when the corpus is missing
+puzzle_t get_local_puzzle( SUDOKU_LEVEL level ) noexcept( true );
+
+#endif
@@ -0,0 +1,322 @@
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "replay.h"
+
+static constexpr char REPLAY_MAGIC[4] = { 'S' , 'D' , 'K' , 'R' };
+static constexpr std::uint32_t REPLAY_VERSION = 1;
+static constexpr std::size_t ANSWER_BYTES = ( SUDOKU_SIZE*SUDOKU_SIZE + 7 )/8;
+
+void save_replay( const std::filesystem::path& path , const ReplayStream& stream ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve( REPLAY_HEADER_SIZE + stream.events.size()*REPLAY_EVENT_SIZE );
+    auto put_bytes = [ &buffer ]( const void * data , std::size_t size )
+    {
+        const std::uint8_t * bytes = static_cast<const std::uint8_t *>( data );
+        buffer.insert( buffer.end() , bytes , bytes + size );
+    };
+
+    const ReplayHeader& header = stream.header;
+    put_bytes( REPLAY_MAGIC , sizeof( REPLAY_MAGIC ) );
+    put_bytes( &REPLAY_VERSION , sizeof( REPLAY_VERSION ) );
+    buffer.push_back( static_cast<std::uint8_t>( header.level ) );
+    buffer.push_back( header.autoupdate ? 1 : 0 );
+    buffer.insert( buffer.end() , 2 , 0 );
+    for ( const auto& row : header.base.puzzle )
+    {
+        put_bytes( row.data() , row.size() );
+    }
+    std::uint8_t answers[ANSWER_BYTES] = { 0 };
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        if ( header.base.answers[index] )
+            answers[index/8] |= 1U << ( index%8 );
+    }
+    put_bytes( answers , ANSWER_BYTES );
+    put_bytes( header.base.candidates.data() , header.base.candidates.size()*sizeof( std::uint16_t ) );
+    for ( const auto& event : stream.events )
+    {
+        put_bytes( &event.time_ms , sizeof( event.time_ms ) );
+        buffer.push_back( static_cast<std::uint8_t>( event.type ) );
+        buffer.push_back( event.x );
+        buffer.push_back( event.y );
+        buffer.push_back( event.value );
+    }
+
+    std::ofstream replay_file( path , std::ios::binary | std::ios::trunc );
+    if ( !replay_file )
+    {
+        except_message += ":can't open '" + path.string() + "'";
+        throw std::runtime_error( except_message );
+    }
+    replay_file.write( reinterpret_cast<const char *>( buffer.data() ) , buffer.size() );
+    replay_file.flush();
+    if ( !replay_file )
+    {
+        except_message += ":writing '" + path.string() + "' failure";
+        throw std::runtime_error( except_message );
+    }
+}
+
+ReplayStream load_replay( const std::filesystem::path& path ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    std::ifstream replay_file( path , std::ios::binary );
+    if ( !replay_file )
+    {
+        except_message += ":can't open '" + path.string() + "'";
+        throw std::runtime_error( except_message );
+    }
+    std::vector<std::uint8_t> buffer( ( std::istreambuf_iterator<char>( replay_file ) ) , std::istreambuf_iterator<char>() );
+    if ( ( buffer.size() < REPLAY_HEADER_SIZE ) || ( std::memcmp( buffer.data() , REPLAY_MAGIC , sizeof( REPLAY_MAGIC ) ) != 0 ) )
+    {
+        except_message += ":'" + path.string() + "' is not a replay file";
+        throw std::invalid_argument( except_message );
+    }
+    std::uint32_t version = 0;
+    std::memcpy( &version , buffer.data() + 4 , sizeof( version ) );
+    if ( version != REPLAY_VERSION )
+    {
+        except_message += ":unsupported replay version " + std::to_string( version );
+        throw std::invalid_argument( except_message );
+    }
+    if ( buffer[8] >= static_cast<std::uint8_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) )
+    {
+        except_message += ":unknown puzzle level";
+        throw std::out_of_range( except_message );
+    }
+
+    ReplayStream stream;
+    ReplayHeader& header = stream.header;
+    header.level = static_cast<SUDOKU_LEVEL>( buffer[8] );
+    header.autoupdate = ( buffer[9] != 0 );
+    const std::uint8_t * cursor = buffer.data() + 12;
+    for ( auto& row : header.base.puzzle )
+    {
+        std::copy( cursor , cursor + SUDOKU_SIZE , row.begin() );
+        cursor += SUDOKU_SIZE;
+    }
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        header.base.answers[index] = ( cursor[index/8] >> ( index%8 ) ) & 1;
+    }
+    cursor += ANSWER_BYTES;
+    std::memcpy( header.base.candidates.data() , cursor , header.base.candidates.size()*sizeof( std::uint16_t ) );
+
+    //trailing partial event ignored( recording interrupted )
+    std::size_t event_number = ( buffer.size() - REPLAY_HEADER_SIZE )/REPLAY_EVENT_SIZE;
+    stream.events.resize( event_number );
+    for ( std::size_t i = 0 ; i < event_number ; i++ )
+    {
+        const std::uint8_t * data = buffer.data() + REPLAY_HEADER_SIZE + i*REPLAY_EVENT_SIZE;
+        ReplayEvent& event = stream.events[i];
+        std::memcpy( &event.time_ms , data , sizeof( event.time_ms ) );
+        event.type = static_cast<ReplayEventType>( data[4] );
+        event.x = data[5];
+        event.y = data[6];
+        event.value = data[7];
+    }
+    return stream;
+}
+
+puzzle_t get_replay_clues( const ReplayHeader& header ) noexcept( true )
+{
+    puzzle_t clues = header.base.puzzle;
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        if ( header.base.answers[index] )
+            clues[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = 0;
+    }
+    return clues;
+}
+
+Sudoku make_replay_game( const ReplayHeader& header ) noexcept( false )
+{
+    Sudoku game( get_replay_clues( header ) , header.level );
+    game.set_state( header.base );
+    game.autoupdate_candidate( header.autoupdate );
+    return game;
+}
+
+SudokuStatus toggle_fill( Sudoku& game , cell_t x , cell_t y , cell_t value , bool candidate ) noexcept( true )
+{
+    if ( ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) )
+        return SudokuStatus::OUT_OF_RANGE;
+    if ( candidate == false )
+    {
+        if ( value == game.get_puzzle()[x][y] )
+            return game.try_erase_answer( x , y );
+        return game.try_fill_answer( x , y , value );
+    }
+    if ( ( value == 0 ) || ( value > SUDOKU_SIZE ) )
+        return SudokuStatus::OUT_OF_RANGE;
+    candidate_mask_t mask = 1U << ( value - 1 );
+    if ( ( game.get_candidate_mask( x , y ) & mask ) == 0 )
+        return game.try_fill_candidates( x , y , mask );
+    return game.try_erase_candidates( x , y , mask );
+}
+
+ReplayRecorder::ReplayRecorder() noexcept( true ):
+    stream(),
+    begin_time( std::chrono::steady_clock::now() )
+{
+    ;
+}
+
+void ReplayRecorder::begin( const ReplayHeader& header )
+{
+    this->stream.header = header;
+    this->stream.events.clear();
+    this->begin_time = std::chrono::steady_clock::now();
+}
+
+void ReplayRecorder::record( ReplayEventType type , cell_t x , cell_t y , cell_t value )
+{
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - this->begin_time );
+    this->stream.events.push_back( { static_cast<std::uint32_t>( time.count() ) , type , x , y , value } );
+}
+
+const ReplayStream& ReplayRecorder::get_stream( void ) const noexcept( true )
+{
+    return this->stream;
+}
+
+ReplayEngine::ReplayEngine( ReplayStream stream ) noexcept( false ):
+    stream( std::move( stream ) ),
+    position( 0 ),
+    rejected( 0 ),
+    select_cell( false ),
+    select_x( 0 ),
+    select_y( 0 ),
+    game( make_replay_game( this->stream.header ) ),
+    history( game )
+{
+    //same rule as the board
+    this->game.allow_conflict( true );
+}
+
+bool ReplayEngine::step( void )
+{
+    if ( this->is_finished() )
+        return false;
+    const ReplayEvent& event = this->stream.events[this->position++];
+    bool accepted = true;
+    try
+    {
+        switch ( event.type )
+        {
+            case ReplayEventType::SELECT:
+                accepted = ( event.x < SUDOKU_SIZE ) && ( event.y < SUDOKU_SIZE );
+                if ( accepted )
+                {
+                    this->select_cell = true;
+                    this->select_x = event.x;
+                    this->select_y = event.y;
+                }
+                break;
+            case ReplayEventType::FILL_ANSWER:
+            case ReplayEventType::FILL_CANDIDATE:
+            {
+                accepted = this->select_cell && ( this->game.is_solved() == false );
+                if ( accepted == false )
+                    break;
+                cell_t x = this->select_x;
+                cell_t y = this->select_y;
+                bool candidate = ( event.type == ReplayEventType::FILL_CANDIDATE );
+                SudokuStatus status = SudokuStatus::OK;
+                this->history.execute(
+                    [ x , y , &event , candidate , &status ]( Sudoku& game )
+                    {
+                        status = toggle_fill( game , x , y , event.value , candidate );
+                    }
+                );
+                accepted = ( status == SudokuStatus::OK );
+                break;
+            }
+            //board stop taking moves once solved
+            case ReplayEventType::UNDO:
+                accepted = ( this->game.is_solved() == false ) && this->history.undo();
+                break;
+            case ReplayEventType::REDO:
+                accepted = ( this->game.is_solved() == false ) && this->history.redo();
+                break;
+            case ReplayEventType::AUTOUPDATE:
+                this->game.autoupdate_candidate( event.value != 0 );
+                break;
+            default:
+                accepted = false;
+                break;
+        }
+    }
+    catch( const std::exception& )
+    {
+        accepted = false;
+    }
+    if ( accepted == false )
+        this->rejected++;
+    return true;
+}
+
+std::size_t ReplayEngine::advance_to( std::uint32_t time_ms )
+{
+    std::size_t applied = 0;
+    while ( ( this->is_finished() == false ) && ( this->stream.events[this->position].time_ms <= time_ms ) )
+    {
+        this->step();
+        applied++;
+    }
+    return applied;
+}
+
+std::size_t ReplayEngine::run( void )
+{
+    std::size_t applied = 0;
+    while ( this->step() )
+    {
+        applied++;
+    }
+    return applied;
+}
+
+bool ReplayEngine::is_finished( void ) const noexcept( true )
+{
+    return this->position >= this->stream.events.size();
+}
+
+std::size_t ReplayEngine::get_position( void ) const noexcept( true )
+{
+    return this->position;
+}
+
+std::size_t ReplayEngine::get_rejected_count( void ) const noexcept( true )
+{
+    return this->rejected;
+}
+
+const ReplayStream& ReplayEngine::get_stream( void ) const noexcept( true )
+{
+    return this->stream;
+}
+
+const Sudoku& ReplayEngine::get_game( void ) const noexcept( true )
+{
+    return this->game;
+}
+
+const GameHistory& ReplayEngine::get_history( void ) const noexcept( true )
+{
+    return this->history;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+#include "history.h"
+#include "sudoku.h"
+
+/*
+* replay file,host byte order:
+*   header( REPLAY_HEADER_SIZE byte ):
+*     "SDKR" | u32 version | u8 level | u8 autoupdate | 2 byte pad |
+*     81 byte base puzzle | 11 byte base answer bits | 81 u16 base candidate masks
+*   event( REPLAY_EVENT_SIZE byte ) repeat:
+*     u32 time ms since recording begin | u8 type | u8 x | u8 y | u8 value
+*/
+constexpr std::size_t REPLAY_HEADER_SIZE = 4 + 4 + 4 + 81 + 11 + 81*2;
+constexpr std::size_t REPLAY_EVENT_SIZE = 8;
+
+enum class ReplayEventType:std::uint8_t
+{
+    //x,y:selected cell
+    SELECT = 1,
+    //value:digit,toggle as SudokuBoard::do_fill in answer/candidate mode
+    FILL_ANSWER,
+    FILL_CANDIDATE,
+    UNDO,
+    REDO,
+    //value:0/1
+    AUTOUPDATE
+};
+
+struct ReplayEvent
+{
+    std::uint32_t time_ms;
+    ReplayEventType type;
+    cell_t x;
+    cell_t y;
+    cell_t value;
+};
+
+struct ReplayHeader
+{
+    SUDOKU_LEVEL level;
+    bool autoupdate;
+    //board when recording began
+    SudokuState base;
+};
+
+struct ReplayStream
+{
+    ReplayHeader header;
+    std::vector<ReplayEvent> events;
+};
+
+void save_replay( const std::filesystem::path& path , const ReplayStream& stream ) noexcept( false );
+ReplayStream load_replay( const std::filesystem::path& path ) noexcept( false );
+
+//base puzzle without answer cells
+puzzle_t get_replay_clues( const ReplayHeader& header ) noexcept( true );
+//game at the base board of header
+Sudoku make_replay_game( const ReplayHeader& header ) noexcept( false );
+
+//fill of the board:answer mode same digit erase the answer,candidate mode toggle the candidate.
+//board unchanged unless OK
+SudokuStatus toggle_fill( Sudoku& game , cell_t x , cell_t y , cell_t value , bool candidate ) noexcept( true );
+
+//collect input events of one game with time since begin()
+class ReplayRecorder
+{
+    public:
+        ReplayRecorder() noexcept( true );
+
+        //drop old events,record a new game from header
+        void begin( const ReplayHeader& header );
+        void record( ReplayEventType type , cell_t x = 0 , cell_t y = 0 , cell_t value = 0 );
+        const ReplayStream& get_stream( void ) const noexcept( true );
+    private:
+        ReplayStream stream;
+        std::chrono::steady_clock::time_point begin_time;
+};
+
+//apply events to a private game without ui,same rules as the board:
+//fill need a selected cell,conflicting digits allowed,no move after solved,
+//rejected operations( clue cell,out of range digit ) only counted
+class ReplayEngine
+{
+    public:
+        explicit ReplayEngine( ReplayStream stream ) noexcept( false );
+        ReplayEngine( const ReplayEngine& ) = delete;
+        ReplayEngine& operator=( const ReplayEngine& ) = delete;
+
+        //apply next event,false if finished
+        bool step( void );
+        //apply events with time <= time_ms,return applied number
+        std::size_t advance_to( std::uint32_t time_ms );
+        //apply all remaining events at full speed
+        std::size_t run( void );
+
+        bool is_finished( void ) const noexcept( true );
+        std::size_t get_position( void ) const noexcept( true );
+        std::size_t get_rejected_count( void ) const noexcept( true );
+        const ReplayStream& get_stream( void ) const noexcept( true );
+        const Sudoku& get_game( void ) const noexcept( true );
+        const GameHistory& get_history( void ) const noexcept( true );
+    private:
+        ReplayStream stream;
+        std::size_t position;
+        std::size_t rejected;
+        bool select_cell;
+        cell_t select_x;
+        cell_t select_y;
+        //history refer to game,keep game first
+        Sudoku game;
+        GameHistory history;
+};
+
+#endif
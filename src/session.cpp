@@ -0,0 +1,517 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "session.h"
+
+static constexpr char JOURNAL_MAGIC[4] = { 'S' , 'D' , 'K' , 'J' };
+static constexpr std::uint32_t JOURNAL_VERSION = 1;
+static constexpr std::size_t ANSWER_BYTES = ( SUDOKU_SIZE*SUDOKU_SIZE + 7 )/8;
+
+template<typename T>
+static void put_value( std::vector<std::uint8_t>& buffer , T value )
+{
+    std::uint8_t bytes[sizeof( T )];
+    std::memcpy( bytes , &value , sizeof( T ) );
+    buffer.insert( buffer.end() , bytes , bytes + sizeof( T ) );
+}
+
+template<typename T>
+static T get_value( const std::uint8_t * data )
+{
+    T value;
+    std::memcpy( &value , data , sizeof( T ) );
+    return value;
+}
+
+//fnv-1a
+static std::uint32_t journal_checksum( const std::uint8_t * data , std::size_t size )
+{
+    std::uint32_t hash = 2166136261U;
+    for ( std::size_t i = 0 ; i < size ; i++ )
+    {
+        hash ^= data[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+//all zero record must fail the check( preallocated/torn tail )
+static std::uint8_t record_check( const std::uint8_t * data )
+{
+    std::uint8_t check = 0xA5;
+    for ( std::size_t i = 0 ; i < 10 ; i++ )
+    {
+        check ^= data[i];
+    }
+    return check;
+}
+
+static void encode_header( std::vector<std::uint8_t>& buffer , const JournalHeader& header )
+{
+    std::size_t begin = buffer.size();
+    buffer.insert( buffer.end() , JOURNAL_MAGIC , JOURNAL_MAGIC + sizeof( JOURNAL_MAGIC ) );
+    put_value<std::uint32_t>( buffer , JOURNAL_VERSION );
+    put_value<std::uint8_t>( buffer , static_cast<std::uint8_t>( header.level ) );
+    buffer.insert( buffer.end() , 3 , 0 );
+    put_value<std::uint32_t>( buffer , header.base_time_ms );
+    for ( const auto& row : header.base.puzzle )
+    {
+        buffer.insert( buffer.end() , row.begin() , row.end() );
+    }
+    std::uint8_t answers[ANSWER_BYTES] = { 0 };
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        if ( header.base.answers[index] )
+            answers[index/8] |= 1U << ( index%8 );
+    }
+    buffer.insert( buffer.end() , answers , answers + ANSWER_BYTES );
+    for ( auto mask : header.base.candidates )
+    {
+        put_value<std::uint16_t>( buffer , mask );
+    }
+    for ( const auto& row : header.solution )
+    {
+        buffer.insert( buffer.end() , row.begin() , row.end() );
+    }
+    put_value<std::uint32_t>( buffer , journal_checksum( buffer.data() + begin , buffer.size() - begin ) );
+}
+
+static bool decode_header( const std::uint8_t * data , JournalHeader& header )
+{
+    if ( std::memcmp( data , JOURNAL_MAGIC , sizeof( JOURNAL_MAGIC ) ) != 0 )
+        return false;
+    if ( get_value<std::uint32_t>( data + 4 ) != JOURNAL_VERSION )
+        return false;
+    if ( get_value<std::uint32_t>( data + JOURNAL_HEADER_SIZE - 4 ) != journal_checksum( data , JOURNAL_HEADER_SIZE - 4 ) )
+        return false;
+    if ( data[8] >= static_cast<std::uint8_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) )
+        return false;
+
+    const std::uint8_t * cursor = data + 16;
+    header.level = static_cast<SUDOKU_LEVEL>( data[8] );
+    header.base_time_ms = get_value<std::uint32_t>( data + 12 );
+    for ( auto& row : header.base.puzzle )
+    {
+        std::copy( cursor , cursor + SUDOKU_SIZE , row.begin() );
+        cursor += SUDOKU_SIZE;
+    }
+    header.base.answers.reset();
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        header.base.answers[index] = ( cursor[index/8] >> ( index%8 ) ) & 1;
+    }
+    cursor += ANSWER_BYTES;
+    for ( auto& mask : header.base.candidates )
+    {
+        mask = get_value<std::uint16_t>( cursor );
+        cursor += sizeof( std::uint16_t );
+    }
+    for ( auto& row : header.solution )
+    {
+        std::copy( cursor , cursor + SUDOKU_SIZE , row.begin() );
+        cursor += SUDOKU_SIZE;
+    }
+    return true;
+}
+
+static void encode_record( std::vector<std::uint8_t>& buffer , const JournalRecord& record )
+{
+    std::size_t begin = buffer.size();
+    put_value<std::uint32_t>( buffer , record.time_ms );
+    put_value<std::uint32_t>( buffer , record.payload );
+    put_value<std::uint8_t>( buffer , static_cast<std::uint8_t>( record.type ) );
+    put_value<std::uint8_t>( buffer , record.flags );
+    put_value<std::uint8_t>( buffer , record_check( buffer.data() + begin ) );
+    put_value<std::uint8_t>( buffer , 0 );
+}
+
+static bool decode_record( const std::uint8_t * data , JournalRecord& record )
+{
+    if ( data[10] != record_check( data ) )
+        return false;
+    if ( ( data[8] < static_cast<std::uint8_t>( JournalRecordType::CELL_RECORD ) ) ||
+         ( data[8] > static_cast<std::uint8_t>( JournalRecordType::TIME_RECORD ) ) )
+        return false;
+    record.time_ms = get_value<std::uint32_t>( data );
+    record.payload = get_value<std::uint32_t>( data + 4 );
+    record.type = static_cast<JournalRecordType>( data[8] );
+    record.flags = data[9];
+    return true;
+}
+
+//write all,retry on interrupt and short write
+static bool write_all( int fd , const std::uint8_t * data , std::size_t size )
+{
+    while ( size != 0 )
+    {
+        ssize_t written = ::write( fd , data , size );
+        if ( written < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool read_journal( const std::filesystem::path& path , JournalHeader& header , std::vector<JournalRecord>& records ) noexcept( true )
+{
+    int fd = ::open( path.c_str() , O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+        return false;
+    std::vector<std::uint8_t> content;
+    std::uint8_t chunk[1 << 16];
+    while ( true )
+    {
+        ssize_t size = ::read( fd , chunk , sizeof( chunk ) );
+        if ( size < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            ::close( fd );
+            return false;
+        }
+        if ( size == 0 )
+            break;
+        try
+        {
+            content.insert( content.end() , chunk , chunk + size );
+        }
+        catch( ... )
+        {
+            ::close( fd );
+            return false;
+        }
+    }
+    ::close( fd );
+
+    if ( ( content.size() < JOURNAL_HEADER_SIZE ) || ( decode_header( content.data() , header ) == false ) )
+        return false;
+    records.clear();
+    try
+    {
+        records.reserve( ( content.size() - JOURNAL_HEADER_SIZE )/JOURNAL_RECORD_SIZE );
+        //partial tail record:crash during append,ignored
+        for ( std::size_t offset = JOURNAL_HEADER_SIZE ; offset + JOURNAL_RECORD_SIZE <= content.size() ; offset += JOURNAL_RECORD_SIZE )
+        {
+            JournalRecord record;
+            if ( decode_record( content.data() + offset , record ) == false )
+                break;
+            records.push_back( record );
+        }
+    }
+    catch( ... )
+    {
+        return false;
+    }
+    return true;
+}
+
+void replay_journal( const JournalHeader& header , const std::vector<JournalRecord>& records ,
+                     Sudoku& game , GameHistory& history , std::uint32_t& play_time_ms ) noexcept( false )
+{
+    //clues:base puzzle without answer cells
+    puzzle_t clues = header.base.puzzle;
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        if ( header.base.answers[index] )
+            clues[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = 0;
+    }
+    Sudoku restored( clues , header.level );
+
+    History& steps = history.get_history();
+    steps.reset( header.base );
+    SudokuState state = header.base;
+    std::uint32_t time_ms = header.base_time_ms;
+    std::vector<history_record_t> step_records;
+    auto flush_step = [ & ]()
+    {
+        steps.push_records( step_records );
+        step_records.clear();
+    };
+    for ( const auto& record : records )
+    {
+        time_ms = std::max( time_ms , record.time_ms );
+        switch ( record.type )
+        {
+            case JournalRecordType::CELL_RECORD:
+                if ( record.flags & JOURNAL_STEP_BEGIN )
+                    flush_step();
+                apply_record( state , record.payload );
+                step_records.push_back( record.payload );
+                break;
+            case JournalRecordType::UNDO_RECORD:
+                flush_step();
+                steps.undo( state );
+                break;
+            case JournalRecordType::REDO_RECORD:
+                flush_step();
+                steps.redo( state );
+                break;
+            case JournalRecordType::TIME_RECORD:
+                break;
+        }
+    }
+    flush_step();
+
+    //assign keep the listener of game
+    restored.set_state( state );
+    game = std::move( restored );
+    play_time_ms = time_ms;
+}
+
+std::vector<JournalRecord> history_to_journal( const History& history , std::uint32_t time_ms )
+{
+    std::vector<JournalRecord> records;
+    for ( std::size_t step = 0 ; step < history.get_step_count() ; step++ )
+    {
+        auto step_records = history.get_step( step );
+        for ( std::size_t i = 0 ; i < step_records.second ; i++ )
+        {
+            records.push_back( { time_ms , step_records.first[i] , JournalRecordType::CELL_RECORD ,
+                                 static_cast<std::uint8_t>( ( i == 0 ) ? JOURNAL_STEP_BEGIN : 0 ) } );
+        }
+    }
+    for ( std::size_t step = history.get_cursor() ; step < history.get_step_count() ; step++ )
+    {
+        records.push_back( { time_ms , 0 , JournalRecordType::UNDO_RECORD , 0 } );
+    }
+    return records;
+}
+
+SessionJournal::SessionJournal( std::filesystem::path path , JournalSync sync , std::chrono::milliseconds sync_interval ) noexcept( false ):
+    path( std::move( path ) ),
+    sync( sync ),
+    sync_interval( sync_interval ),
+    fd( -1 ),
+    dirty( false ),
+    last_sync( std::chrono::steady_clock::now() ),
+    record_count( 0 ),
+    stop( false )
+{
+    std::string except_message( __func__ );
+    if ( this->path.empty() )
+    {
+        except_message += ":journal path is empty";
+        throw std::invalid_argument( except_message );
+    }
+    if ( this->path.has_parent_path() )
+        std::filesystem::create_directories( this->path.parent_path() );
+    this->writer = std::thread( &SessionJournal::writer_loop , this );
+}
+
+SessionJournal::~SessionJournal()
+{
+    {
+        std::lock_guard<std::mutex> lock( this->job_mutex );
+        this->stop = true;
+    }
+    this->job_condition.notify_all();
+    this->writer.join();
+}
+
+void SessionJournal::start( const JournalHeader& header )
+{
+    this->compact( header , {} );
+}
+
+void SessionJournal::append( const JournalRecord& record )
+{
+    this->append( std::vector<JournalRecord>{ record } );
+}
+
+void SessionJournal::append( const std::vector<JournalRecord>& records )
+{
+    if ( records.empty() )
+        return ;
+    {
+        std::lock_guard<std::mutex> lock( this->job_mutex );
+        //merge into the pending append,one write for a burst of moves
+        if ( ( this->jobs.empty() == false ) && ( this->jobs.back().rewrite == false ) )
+            this->jobs.back().records.insert( this->jobs.back().records.end() , records.begin() , records.end() );
+        else
+            this->jobs.push_back( { false , JournalHeader() , records } );
+        this->record_count += records.size();
+    }
+    this->job_condition.notify_one();
+}
+
+void SessionJournal::compact( const JournalHeader& header , std::vector<JournalRecord> records )
+{
+    {
+        std::lock_guard<std::mutex> lock( this->job_mutex );
+        //pending appends are part of the old file,superseded
+        this->jobs.clear();
+        this->record_count = records.size();
+        this->jobs.push_back( { true , header , std::move( records ) } );
+    }
+    this->job_condition.notify_one();
+}
+
+std::size_t SessionJournal::get_record_count( void ) const noexcept( true )
+{
+    std::lock_guard<std::mutex> lock( this->job_mutex );
+    return this->record_count;
+}
+
+const std::filesystem::path& SessionJournal::get_path( void ) const noexcept( true )
+{
+    return this->path;
+}
+
+std::filesystem::path SessionJournal::default_path( void ) noexcept( true )
+{
+    std::filesystem::path directory;
+    const char * state_home = std::getenv( "XDG_STATE_HOME" );
+    const char * home = std::getenv( "HOME" );
+    if ( ( state_home != nullptr ) && ( state_home[0] == '/' ) )
+        directory = state_home;
+    else if ( ( home != nullptr ) && ( home[0] != '\0' ) )
+        directory = std::filesystem::path( home ) / ".local" / "state";
+    else
+        directory = ".";
+    return directory / "sudoku-gtkmm" / "session.journal";
+}
+
+void SessionJournal::writer_loop( void )
+{
+    std::unique_lock<std::mutex> lock( this->job_mutex );
+    while ( true )
+    {
+        if ( this->jobs.empty() )
+        {
+            if ( this->stop )
+                break;
+            if ( this->dirty && ( this->sync == JournalSync::INTERVAL ) )
+            {
+                //idle after a write,sync when the interval is due
+                if ( this->job_condition.wait_until( lock , this->last_sync + this->sync_interval ) == std::cv_status::timeout )
+                {
+                    lock.unlock();
+                    this->sync_file();
+                    lock.lock();
+                }
+            }
+            else
+            {
+                this->job_condition.wait( lock );
+            }
+            continue;
+        }
+
+        std::deque<Job> batch;
+        batch.swap( this->jobs );
+        lock.unlock();
+        for ( const auto& job : batch )
+        {
+            if ( job.rewrite )
+                this->rewrite_file( job );
+            else
+                this->append_file( job.records );
+        }
+        if ( this->dirty )
+        {
+            if ( ( this->sync == JournalSync::ALWAYS ) ||
+                 ( ( this->sync == JournalSync::INTERVAL ) &&
+                   ( std::chrono::steady_clock::now() - this->last_sync >= this->sync_interval ) ) )
+                this->sync_file();
+        }
+        lock.lock();
+    }
+    lock.unlock();
+
+    if ( this->sync != JournalSync::NONE )
+        this->sync_file();
+    if ( this->fd >= 0 )
+        ::close( this->fd );
+    this->fd = -1;
+}
+
+void SessionJournal::rewrite_file( const Job& job )
+{
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve( JOURNAL_HEADER_SIZE + job.records.size()*JOURNAL_RECORD_SIZE );
+    encode_header( buffer , job.header );
+    for ( const auto& record : job.records )
+    {
+        encode_record( buffer , record );
+    }
+
+    if ( this->fd >= 0 )
+        ::close( this->fd );
+    this->fd = -1;
+    this->dirty = false;
+
+    //a crash leave either the old or the new journal,never a mix
+    std::filesystem::path temp_path( this->path );
+    temp_path += ".tmp";
+    int temp_fd = ::open( temp_path.c_str() , O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC , 0644 );
+    if ( temp_fd < 0 )
+        return ;
+    bool success = write_all( temp_fd , buffer.data() , buffer.size() ) && ( ::fsync( temp_fd ) == 0 );
+    ::close( temp_fd );
+    if ( ( success == false ) || ( ::rename( temp_path.c_str() , this->path.c_str() ) != 0 ) )
+    {
+        ::unlink( temp_path.c_str() );
+        return ;
+    }
+    if ( this->path.has_parent_path() )
+    {
+        int directory_fd = ::open( this->path.parent_path().c_str() , O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+        if ( directory_fd >= 0 )
+        {
+            ::fsync( directory_fd );
+            ::close( directory_fd );
+        }
+    }
+    this->fd = ::open( this->path.c_str() , O_WRONLY | O_APPEND | O_CLOEXEC );
+    this->last_sync = std::chrono::steady_clock::now();
+}
+
+void SessionJournal::append_file( const std::vector<JournalRecord>& records )
+{
+    //no journal file( failed rewrite ),records dropped until next start/compact
+    if ( this->fd < 0 )
+        return ;
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve( records.size()*JOURNAL_RECORD_SIZE );
+    for ( const auto& record : records )
+    {
+        encode_record( buffer , record );
+    }
+    if ( write_all( this->fd , buffer.data() , buffer.size() ) == false )
+    {
+        //a short tail is ignored by read_journal,stop appending after it
+        ::close( this->fd );
+        this->fd = -1;
+        return ;
+    }
+    this->dirty = true;
+}
+
+void SessionJournal::sync_file( void )
+{
+    if ( ( this->fd >= 0 ) && this->dirty )
+        ::fdatasync( this->fd );
+    this->dirty = false;
+    this->last_sync = std::chrono::steady_clock::now();
+}
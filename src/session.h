@@ -0,0 +1,136 @@
+#pragma once
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <cstdint>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "history.h"
+#include "sudoku.h"
+
+/*
+* session journal file,host byte order:
+*   header( JOURNAL_HEADER_SIZE byte ):
+*     "SDKJ" | u32 version | u8 level | 3 byte pad | u32 base play time ms |
+*     81 byte base puzzle | 11 byte base answer bits | 81 u16 base candidate masks |
+*     81 byte solution | u32 checksum of preceding bytes
+*   record( JOURNAL_RECORD_SIZE byte ) repeat:
+*     u32 play time ms | u32 payload | u8 type | u8 flags | u8 check | u8 pad
+* a torn or corrupt record end the journal,everything before it is kept.
+*/
+constexpr std::size_t JOURNAL_HEADER_SIZE = 4 + 4 + 4 + 4 + 81 + 11 + 81*2 + 81 + 4;
+constexpr std::size_t JOURNAL_RECORD_SIZE = 12;
+
+enum class JournalSync:std::uint32_t
+{
+    //leave to the os page cache
+    NONE = 0,
+    //fdatasync at most every sync interval
+    INTERVAL,
+    //fdatasync after every written batch
+    ALWAYS
+};
+
+enum class JournalRecordType:std::uint8_t
+{
+    //payload:history_record_t
+    CELL_RECORD = 1,
+    UNDO_RECORD,
+    REDO_RECORD,
+    //only update play time( pause,exit )
+    TIME_RECORD
+};
+
+//CELL_RECORD flags:first record of a history step
+constexpr std::uint8_t JOURNAL_STEP_BEGIN = 0x01;
+
+struct JournalHeader
+{
+    SUDOKU_LEVEL level;
+    //board before the first record
+    SudokuState base;
+    puzzle_t solution;
+    std::uint32_t base_time_ms;
+};
+
+struct JournalRecord
+{
+    std::uint32_t time_ms;
+    std::uint32_t payload;
+    JournalRecordType type;
+    std::uint8_t flags;
+};
+
+//whole journal,false if missing or header invalid
+bool read_journal( const std::filesystem::path& path , JournalHeader& header , std::vector<JournalRecord>& records ) noexcept( true );
+
+//rebuild game,history and play time.history must be bound to game
+void replay_journal( const JournalHeader& header , const std::vector<JournalRecord>& records ,
+                     Sudoku& game , GameHistory& history , std::uint32_t& play_time_ms ) noexcept( false );
+
+//history content as journal records:every step,then undo records back to the cursor
+std::vector<JournalRecord> history_to_journal( const History& history , std::uint32_t time_ms );
+
+//append-only writer,file io and sync run in its own thread,callers never block on disk
+class SessionJournal
+{
+    public:
+        SessionJournal( std::filesystem::path path = default_path() , JournalSync sync = JournalSync::INTERVAL ,
+                        std::chrono::milliseconds sync_interval = std::chrono::milliseconds( 1000 ) ) noexcept( false );
+        SessionJournal( const SessionJournal& ) = delete;
+        SessionJournal& operator=( const SessionJournal& ) = delete;
+        //write all queued records and sync
+        ~SessionJournal();
+
+        //new game:replace the journal with header only
+        void start( const JournalHeader& header );
+        void append( const JournalRecord& record );
+        void append( const std::vector<JournalRecord>& records );
+        //replace the journal with header + records,temp file then atomic rename
+        void compact( const JournalHeader& header , std::vector<JournalRecord> records );
+        //records appended since last start/compact
+        std::size_t get_record_count( void ) const noexcept( true );
+
+        const std::filesystem::path& get_path( void ) const noexcept( true );
+
+        //$XDG_STATE_HOME/sudoku-gtkmm/session.journal or $HOME/.local/state/sudoku-gtkmm/session.journal
+        static std::filesystem::path default_path( void ) noexcept( true );
+    private:
+        struct Job
+        {
+            //rewrite whole file,else append records
+            bool rewrite;
+            JournalHeader header;
+            std::vector<JournalRecord> records;
+        };
+
+        void writer_loop( void );
+        void rewrite_file( const Job& job );
+        void append_file( const std::vector<JournalRecord>& records );
+        void sync_file( void );
+
+        std::filesystem::path path;
+        JournalSync sync;
+        std::chrono::milliseconds sync_interval;
+        int fd;
+        //data written but not synced
+        bool dirty;
+        std::chrono::steady_clock::time_point last_sync;
+
+        mutable std::mutex job_mutex;
+        std::condition_variable job_condition;
+        std::deque<Job> jobs;
+        std::size_t record_count;
+        bool stop;
+        std::thread writer;
+};
+
+#endif
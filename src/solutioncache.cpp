@@ -0,0 +1,151 @@
+#include <cstdint>
+#include <cstring>
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "metrics.h"
+#include "solutioncache.h"
+
+packed_puzzle_t pack_puzzle( const puzzle_t& puzzle ) noexcept( true )
+{
+    packed_puzzle_t packed = { 0 };
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        std::uint8_t value = puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE] & 0x0F;
+        packed[index/2] |= ( index%2 == 0 ) ? value : static_cast<std::uint8_t>( value << 4 );
+    }
+    return packed;
+}
+
+puzzle_t unpack_puzzle( const packed_puzzle_t& packed ) noexcept( true )
+{
+    puzzle_t puzzle;
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        std::uint8_t byte = packed[index/2];
+        puzzle[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = ( index%2 == 0 ) ? ( byte & 0x0F ) : ( byte >> 4 );
+    }
+    return puzzle;
+}
+
+//word at a time multiply-xorshift,the tail byte folded last
+std::size_t PackedPuzzleHash::operator()( const packed_puzzle_t& packed ) const noexcept( true )
+{
+    constexpr std::uint64_t multiplier = 0xFF51AFD7ED558CCDULL;
+    std::uint64_t hash = 0x9E3779B97F4A7C15ULL;
+    std::size_t offset = 0;
+    for ( ; offset + sizeof( std::uint64_t ) <= packed.size() ; offset += sizeof( std::uint64_t ) )
+    {
+        std::uint64_t word;
+        std::memcpy( &word , packed.data() + offset , sizeof( word ) );
+        hash = ( hash ^ word )*multiplier;
+        hash ^= hash >> 32;
+    }
+    for ( ; offset < packed.size() ; offset++ )
+    {
+        hash = ( hash ^ packed[offset] )*multiplier;
+    }
+    hash ^= hash >> 29;
+    return static_cast<std::size_t>( hash );
+}
+
+SolutionCache::SolutionCache( std::size_t capacity , const std::string& metric_prefix ) noexcept( false ):
+    capacity( capacity ),
+    hits( 0 ),
+    misses( 0 ),
+    hit_counter( metrics().counter( metric_prefix + ".hits" ) ),
+    miss_counter( metrics().counter( metric_prefix + ".misses" ) )
+{
+    if ( capacity == 0 )
+    {
+        std::string except_message( __func__ );
+        except_message += ":capacity should be greater than zero";
+        throw std::invalid_argument( except_message );
+    }
+    this->index.reserve( capacity );
+}
+
+SolveStatus SolutionCache::solve( const puzzle_t& clues , puzzle_t& solution , const SolveLimits& limits ) noexcept( false )
+{
+    if ( this->lookup( clues , solution ) )
+        return SolveStatus::COMPLETE;
+
+    //solve outside the lock,other threads keep using the cache
+    std::vector<puzzle_t> solutions;
+    SolveStatus status = Sudoku( clues ).get_solution( solutions , 1 , limits );
+    solution = solutions.empty() ? puzzle_t() : solutions[0];
+    if ( status == SolveStatus::COMPLETE )
+        this->insert( clues , solution );
+    return status;
+}
+
+bool SolutionCache::lookup( const puzzle_t& clues , puzzle_t& solution ) noexcept( true )
+{
+    packed_puzzle_t key = pack_puzzle( clues );
+    std::lock_guard<std::mutex> lock( this->mutex );
+    auto found = this->index.find( key );
+    if ( found == this->index.end() )
+    {
+        this->misses++;
+        this->miss_counter.add();
+        return false;
+    }
+    this->hits++;
+    this->hit_counter.add();
+    this->entries.splice( this->entries.begin() , this->entries , found->second );
+    solution = unpack_puzzle( found->second->second );
+    return true;
+}
+
+void SolutionCache::insert( const puzzle_t& clues , const puzzle_t& solution ) noexcept( false )
+{
+    packed_puzzle_t key = pack_puzzle( clues );
+    std::lock_guard<std::mutex> lock( this->mutex );
+    auto found = this->index.find( key );
+    if ( found != this->index.end() )
+    {
+        found->second->second = pack_puzzle( solution );
+        this->entries.splice( this->entries.begin() , this->entries , found->second );
+        return ;
+    }
+    if ( this->entries.size() >= this->capacity )
+    {
+        this->index.erase( this->entries.back().first );
+        this->entries.pop_back();
+    }
+    this->entries.emplace_front( key , pack_puzzle( solution ) );
+    this->index.emplace( key , this->entries.begin() );
+}
+
+void SolutionCache::clear( void ) noexcept( true )
+{
+    std::lock_guard<std::mutex> lock( this->mutex );
+    this->index.clear();
+    this->entries.clear();
+}
+
+std::size_t SolutionCache::get_size( void ) const noexcept( true )
+{
+    std::lock_guard<std::mutex> lock( this->mutex );
+    return this->entries.size();
+}
+
+std::size_t SolutionCache::get_capacity( void ) const noexcept( true )
+{
+    return this->capacity;
+}
+
+std::uint64_t SolutionCache::get_hit_count( void ) const noexcept( true )
+{
+    std::lock_guard<std::mutex> lock( this->mutex );
+    return this->hits;
+}
+
+std::uint64_t SolutionCache::get_miss_count( void ) const noexcept( true )
+{
+    std::lock_guard<std::mutex> lock( this->mutex );
+    return this->misses;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef SOLUTIONCACHE_H
+#define SOLUTIONCACHE_H
+
+#include <cstdint>
+
+#include <array>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "dancinglinks.h"
+#include "metrics.h"
+#include "sudoku.h"
+
+//4 bit a cell,cell index:x*SUDOKU_SIZE + y,even index in the low nibble of byte index/2
+constexpr std::size_t PACKED_PUZZLE_SIZE = ( SUDOKU_SIZE*SUDOKU_SIZE + 1 )/2;
+typedef std::array< std::uint8_t , PACKED_PUZZLE_SIZE > packed_puzzle_t;
+
+packed_puzzle_t pack_puzzle( const puzzle_t& puzzle ) noexcept( true );
+
+puzzle_t unpack_puzzle( const packed_puzzle_t& packed ) noexcept( true );
+
+struct PackedPuzzleHash
+{
+    std::size_t operator()( const packed_puzzle_t& packed ) const noexcept( true );
+};
+
+//solution of clues,least recently used entry dropped beyond capacity.thread safe
+class SolutionCache
+{
+    public:
+        //metric_prefix:name of this cache in the metrics registry,$(prefix).hits and $(prefix).misses
+        explicit SolutionCache( std::size_t capacity = 1024 , const std::string& metric_prefix = "solution_cache" ) noexcept( false );
+        SolutionCache( const SolutionCache& ) = delete;
+        SolutionCache& operator=( const SolutionCache& ) = delete;
+
+        //cached result or solve the clues under limits.
+        //COMPLETE with all zero solution:the clues have no solution,memoized too.
+        //an unfinished search is not cached
+        SolveStatus solve( const puzzle_t& clues , puzzle_t& solution , const SolveLimits& limits = SolveLimits() ) noexcept( false );
+        //hit move the entry to most recent
+        bool lookup( const puzzle_t& clues , puzzle_t& solution ) noexcept( true );
+        void insert( const puzzle_t& clues , const puzzle_t& solution ) noexcept( false );
+        void clear( void ) noexcept( true );
+
+        std::size_t get_size( void ) const noexcept( true );
+        std::size_t get_capacity( void ) const noexcept( true );
+        std::uint64_t get_hit_count( void ) const noexcept( true );
+        std::uint64_t get_miss_count( void ) const noexcept( true );
+    private:
+        //most recent first:( clues , solution )
+        typedef std::list< std::pair< packed_puzzle_t , packed_puzzle_t > > lru_list_t;
+
+        mutable std::mutex mutex;
+        std::size_t capacity;
+        lru_list_t entries;
+        std::unordered_map< packed_puzzle_t , lru_list_t::iterator , PackedPuzzleHash > index;
+        std::uint64_t hits;
+        std::uint64_t misses;
+        MetricCounter& hit_counter;
+        MetricCounter& miss_counter;
+};
+
+#endif
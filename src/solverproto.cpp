@@ -0,0 +1,199 @@
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "solverproto.h"
+
+std::string default_solver_socket( void ) noexcept( true )
+{
+    const char * runtime_dir = std::getenv( "XDG_RUNTIME_DIR" );
+    if ( ( runtime_dir != nullptr ) && ( runtime_dir[0] != '\0' ) )
+        return std::string( runtime_dir ) + "/sudokud.sock";
+    return "/tmp/sudokud-" + std::to_string( getuid() ) + ".sock";
+}
+
+const char * solver_status_to_string( SolverStatus status ) noexcept( true )
+{
+    switch ( status )
+    {
+        case SolverStatus::OK:
+            return "ok";
+        case SolverStatus::NO_SOLUTION:
+            return "no solution";
+        case SolverStatus::BUDGET_EXCEEDED:
+            return "budget exceeded";
+        case SolverStatus::BAD_REQUEST:
+            return "bad request";
+        case SolverStatus::ILLEGAL_PUZZLE:
+            return "illegal puzzle";
+    }
+    return "unknown";
+}
+
+static void put_u32( std::uint8_t * data , std::uint32_t value )
+{
+    std::memcpy( data , &value , sizeof( value ) );
+}
+
+static std::uint32_t get_u32( const std::uint8_t * data )
+{
+    std::uint32_t value;
+    std::memcpy( &value , data , sizeof( value ) );
+    return value;
+}
+
+std::vector<std::uint8_t> encode_request( const SolverRequest& request )
+{
+    //sized once,header and payload copied in:growing by insert trip -Warray-bounds in g++ 12 -O3
+    std::vector<std::uint8_t> frame( SOLVER_HEADER_SIZE + request.payload.size() , 0 );
+    put_u32( frame.data() , request.payload.size() );
+    put_u32( frame.data() + 4 , request.id );
+    frame[8] = static_cast<std::uint8_t>( request.op );
+    put_u32( frame.data() + 12 , request.budget_ms );
+    if ( request.payload.empty() == false )
+        std::memcpy( frame.data() + SOLVER_HEADER_SIZE , request.payload.data() , request.payload.size() );
+    return frame;
+}
+
+std::vector<std::uint8_t> encode_response( const SolverResponse& response )
+{
+    std::vector<std::uint8_t> frame( SOLVER_HEADER_SIZE + response.payload.size() , 0 );
+    put_u32( frame.data() , response.payload.size() );
+    put_u32( frame.data() + 4 , response.id );
+    frame[8] = static_cast<std::uint8_t>( response.op );
+    frame[9] = static_cast<std::uint8_t>( response.status );
+    put_u32( frame.data() + 12 , response.server_us );
+    if ( response.payload.empty() == false )
+        std::memcpy( frame.data() + SOLVER_HEADER_SIZE , response.payload.data() , response.payload.size() );
+    return frame;
+}
+
+//false:end of stream before the first byte
+static bool read_full( int fd , std::uint8_t * data , std::size_t size )
+{
+    std::size_t done = 0;
+    while ( done < size )
+    {
+        ssize_t got = read( fd , data + done , size - done );
+        if ( got < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            throw std::runtime_error( std::string( "read_full:" ) + std::strerror( errno ) );
+        }
+        if ( got == 0 )
+        {
+            if ( done == 0 )
+                return false;
+            throw std::runtime_error( "read_full:stream end inside a frame" );
+        }
+        done += got;
+    }
+    return true;
+}
+
+//header fields,payload read into payload
+static bool read_frame( int fd , std::uint8_t * header , std::vector<std::uint8_t>& payload )
+{
+    if ( read_full( fd , header , SOLVER_HEADER_SIZE ) == false )
+        return false;
+    std::uint32_t size = get_u32( header );
+    if ( size > SOLVER_MAX_PAYLOAD )
+        throw std::runtime_error( "read_frame:payload size " + std::to_string( size ) + " too large" );
+    payload.resize( size );
+    if ( ( size > 0 ) && ( read_full( fd , payload.data() , size ) == false ) )
+        throw std::runtime_error( "read_frame:stream end inside a frame" );
+    return true;
+}
+
+bool read_request( int fd , SolverRequest& request ) noexcept( false )
+{
+    std::uint8_t header[SOLVER_HEADER_SIZE];
+    if ( read_frame( fd , header , request.payload ) == false )
+        return false;
+    request.id = get_u32( header + 4 );
+    request.op = static_cast<SolverOp>( header[8] );
+    request.budget_ms = get_u32( header + 12 );
+    return true;
+}
+
+bool read_response( int fd , SolverResponse& response ) noexcept( false )
+{
+    std::uint8_t header[SOLVER_HEADER_SIZE];
+    if ( read_frame( fd , header , response.payload ) == false )
+        return false;
+    response.id = get_u32( header + 4 );
+    response.op = static_cast<SolverOp>( header[8] );
+    response.status = static_cast<SolverStatus>( header[9] );
+    response.server_us = get_u32( header + 12 );
+    return true;
+}
+
+void write_frame( int fd , const std::vector<std::uint8_t>& frame ) noexcept( false )
+{
+    std::size_t done = 0;
+    while ( done < frame.size() )
+    {
+        ssize_t sent = send( fd , frame.data() + done , frame.size() - done , MSG_NOSIGNAL );
+        if ( sent < 0 )
+        {
+            if ( errno == EINTR )
+                continue;
+            throw std::runtime_error( std::string( "write_frame:" ) + std::strerror( errno ) );
+        }
+        done += sent;
+    }
+}
+
+int connect_solver( const std::string& path ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    sockaddr_un address;
+    std::memset( &address , 0 , sizeof( address ) );
+    address.sun_family = AF_UNIX;
+    if ( path.size() >= sizeof( address.sun_path ) )
+    {
+        except_message += ":socket path '" + path + "' too long";
+        throw std::runtime_error( except_message );
+    }
+    std::memcpy( address.sun_path , path.c_str() , path.size() + 1 );
+
+    int fd = socket( AF_UNIX , SOCK_STREAM | SOCK_CLOEXEC , 0 );
+    if ( fd < 0 )
+    {
+        except_message += std::string( ":socket:" ) + std::strerror( errno );
+        throw std::runtime_error( except_message );
+    }
+    if ( connect( fd , reinterpret_cast<sockaddr *>( &address ) , sizeof( address ) ) != 0 )
+    {
+        except_message += ":connect '" + path + "':" + std::strerror( errno );
+        close( fd );
+        throw std::runtime_error( except_message );
+    }
+    return fd;
+}
+
+void append_packed( std::vector<std::uint8_t>& payload , const puzzle_t& puzzle )
+{
+    packed_puzzle_t packed = pack_puzzle( puzzle );
+    payload.insert( payload.end() , packed.begin() , packed.end() );
+}
+
+bool take_packed( const std::vector<std::uint8_t>& payload , std::size_t offset , puzzle_t& puzzle ) noexcept( true )
+{
+    if ( payload.size() < offset + PACKED_PUZZLE_SIZE )
+        return false;
+    packed_puzzle_t packed;
+    std::memcpy( packed.data() , payload.data() + offset , PACKED_PUZZLE_SIZE );
+    puzzle = unpack_puzzle( packed );
+    return true;
+}
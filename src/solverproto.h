@@ -0,0 +1,97 @@
+#pragma once
+#ifndef SOLVERPROTO_H
+#define SOLVERPROTO_H
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include "solutioncache.h"
+#include "sudoku.h"
+
+/*
+* sudokud protocol over a unix stream socket,host byte order( same machine ).
+* a client may send any number of requests before reading,responses come back
+* in completion order and are matched by request id.
+*   request:  u32 payload length | u32 request id | u8 op | 3 byte pad | u32 time budget ms( 0 server default ) | payload
+*   response: u32 payload length | u32 request id | u8 op | u8 status | 2 byte pad | u32 server time us | payload
+* payload by op:
+*   SOLVE        request:packed puzzle                 response:packed solution
+*   COUNT        request:packed puzzle | u32 limit     response:u32 solution number( at most limit )
+*   GENERATE     request:empty                         response:packed puzzle | packed solution | u8 level
+*   GRADE        request:packed puzzle                 response:u8 level
+*   CANONICALIZE request:packed puzzle                 response:packed canonical puzzle
+*   STATS        request:empty                         response:u64 requests | u64 cache hits | u64 cache misses
+* a failed request( status != OK ) has an empty payload.
+*/
+constexpr std::size_t SOLVER_HEADER_SIZE = 16;
+//larger request payload close the connection
+constexpr std::uint32_t SOLVER_MAX_PAYLOAD = 4096;
+//COUNT limit upper bound
+constexpr std::uint32_t SOLVER_MAX_COUNT = 1 << 16;
+
+enum class SolverOp:std::uint8_t
+{
+    SOLVE = 1,
+    COUNT,
+    GENERATE,
+    GRADE,
+    CANONICALIZE,
+    STATS
+};
+
+enum class SolverStatus:std::uint8_t
+{
+    OK = 0,
+    //the puzzle has no solution
+    NO_SOLUTION,
+    //time budget used up before the answer,client gone
+    BUDGET_EXCEEDED,
+    //unknown op,payload size mismatch
+    BAD_REQUEST,
+    //clue repeat in a unit,cell value > SUDOKU_SIZE
+    ILLEGAL_PUZZLE
+};
+
+struct SolverRequest
+{
+    std::uint32_t id;
+    SolverOp op;
+    std::uint32_t budget_ms;
+    std::vector<std::uint8_t> payload;
+};
+
+struct SolverResponse
+{
+    std::uint32_t id;
+    SolverOp op;
+    SolverStatus status;
+    std::uint32_t server_us;
+    std::vector<std::uint8_t> payload;
+};
+
+//$XDG_RUNTIME_DIR/sudokud.sock or /tmp/sudokud-$UID.sock
+std::string default_solver_socket( void ) noexcept( true );
+
+const char * solver_status_to_string( SolverStatus status ) noexcept( true );
+
+//header + payload in one buffer
+std::vector<std::uint8_t> encode_request( const SolverRequest& request );
+std::vector<std::uint8_t> encode_response( const SolverResponse& response );
+
+//false on end of stream.throw runtime_error on io error or oversized frame
+bool read_request( int fd , SolverRequest& request ) noexcept( false );
+bool read_response( int fd , SolverResponse& response ) noexcept( false );
+
+//whole buffer,no SIGPIPE.throw runtime_error on io error
+void write_frame( int fd , const std::vector<std::uint8_t>& frame ) noexcept( false );
+
+//connected client socket,throw runtime_error on failure
+int connect_solver( const std::string& path ) noexcept( false );
+
+void append_packed( std::vector<std::uint8_t>& payload , const puzzle_t& puzzle );
+//puzzle at offset,false if payload too short
+bool take_packed( const std::vector<std::uint8_t>& payload , std::size_t offset , puzzle_t& puzzle ) noexcept( true );
+
+#endif
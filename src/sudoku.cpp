@@ -1,260 +1,25 @@
 #include <cstdint>
 #include <cstdlib>
-#include <cstring>
 
 #include <algorithm>
 #include <array>
+#include <bitset>
 #include <exception>
 #include <functional>
-#include <future>
 #include <map>
 #include <memory>
 #include <random>
+#include <stdexcept>
 #include <string>
-#include <thread>
 #include <vector>
 
-#include <curl/curl.h>
-#include <jansson.h>
-
 #include "dancinglinks.h"
+#include "gridkernel.h"
+#include "lockstep.h"
+#include "metrics.h"
+#include "puzzleimport.h"
 #include "sudoku.h"
-
-static class LibCurlInit
-{
-    public:
-        LibCurlInit()
-        {
-            if ( curl_global_init( CURL_GLOBAL_ALL ) )
-            {
-                throw std::runtime_error( "libcurl global initial failure" );
-            };
-        }
-        ~LibCurlInit()
-        {
-            curl_global_cleanup();
-        }
-}_init_libcurl;
-
-static class LocalPuzzlePool
-{
-public:
-    LocalPuzzlePool()
-    {
-        auto serialization_puzzle = []( const char * file_path , std::vector<std::string>& container_ref )
-        {
-            //level.data:
-            //{
-            //    [
-            //        "006031070437005000010467008029178300000000026300050000805004910003509087790086004",
-            //        ...
-            //    ]
-            //}
-            std::shared_ptr<json_t> root( json_load_file( file_path , 0 , nullptr ) , json_decref );
-            const json_t * rawptr = root.get();
-            if ( ( rawptr != nullptr ) && ( json_is_array( rawptr ) ) )
-            {
-                std::size_t puzzle_size = json_array_size( rawptr );
-                for ( std::size_t i = 0 ; i < puzzle_size ; i++ )
-                {
-                    json_t * puzzle_node = json_array_get( rawptr , i );
-                    if ( json_is_string( puzzle_node ) )
-                    {
-                        container_ref.push_back( json_string_value( puzzle_node ) );
-                    }
-                }
-            }
-        };
-
-        serialization_puzzle( "resource/easy.data" , this->easy_strings );
-        serialization_puzzle( "resource/medium.data" , this->medium_strings );
-        serialization_puzzle( "resource/hard.data" , this->hard_strings );
-        serialization_puzzle( "resource/expert.data" , this->expert_strings );
-    }
-    ~LocalPuzzlePool() = default;
-
-    std::string get_puzzle_string( SUDOKU_LEVEL level ) noexcept( true )
-    {
-        std::string result;
-        std::random_device rand_div;
-        std::mt19937 rand_gen( rand_div() );
-
-        switch ( level )
-        {
-            case SUDOKU_LEVEL::EASY:
-            {
-                if ( this->easy_strings.empty() )
-                {
-                    break;
-                }
-                std::uniform_int_distribution index_dist( 0 , int( this->easy_strings.size() ) );
-                int index = index_dist( rand_gen );
-                result = this->easy_strings[index];
-                break;
-            }
-            case SUDOKU_LEVEL::MEDIUM:
-            {
-                if ( this->medium_strings.empty() )
-                {
-                    break;
-                }
-                std::uniform_int_distribution index_dist( 0 , int( this->medium_strings.size() ) );
-                int index = index_dist( rand_gen );
-                result = this->medium_strings[index];
-                break;
-            }
-            case SUDOKU_LEVEL::HARD:
-            {
-                if ( this->hard_strings.empty() )
-                {
-                    break;
-                }
-                std::uniform_int_distribution index_dist( 0 , int( this->hard_strings.size() ) );
-                int index = index_dist( rand_gen );
-                result = this->hard_strings[index];
-                break;
-            }
-            case SUDOKU_LEVEL::EXPERT:
-            {
-                if ( this->hard_strings.empty() )
-                {
-                    break;
-                }
-                std::uniform_int_distribution index_dist( 0 , int( this->expert_strings.size() ) );
-                int index = index_dist( rand_gen );
-                result = this->expert_strings[index];
-                break;
-            }
-            default:
-                break;
-        }
-
-        return result;
-    }
-private:
-    std::vector<std::string> easy_strings;
-    std::vector<std::string> expert_strings;
-    std::vector<std::string> hard_strings;
-    std::vector<std::string> medium_strings;
-}local_puzzles;
-
-typedef struct JsonBuff
-{
-    char * buff;
-    std::size_t current_size;
-}json_buff_t;
-
-static std::size_t get_json_callback( char * content , std::size_t size , std::size_t element_number , void * save_ptr )
-{
-    std::size_t realsize = size*element_number;
-    json_buff_t * ptr = static_cast<json_buff_t *>( save_ptr );
-    char * new_buff = static_cast<char *>( realloc( ptr->buff , ptr->current_size + sizeof( char )*realsize + 1 ) );
-    ptr->buff = new_buff;
-    memccpy( &( ptr->buff[ ptr->current_size ] ) , content , 1 , realsize );
-    ptr->current_size += realsize;
-    ptr->buff[ ptr->current_size ] = '\0';
-    return realsize;
-}
-
-static puzzle_t get_puzzle_callback( SUDOKU_LEVEL level ) noexcept( false )
-{
-    std::string except_message( __func__ );
-
-    //API:https://sudoku.com/api/getLevel/$(Level)
-    std::string api_url( "https://sudoku.com/api/getLevel/" + level_to_string( level ) );
-
-    std::int8_t re_try = 4;
-    long default_timeout = 30L;
-    json_buff_t json_buff = { nullptr , 0 };
-    char error_buff[CURL_ERROR_SIZE];
-    //c str* safe
-    error_buff[0] = '\0';
-
-    CURLcode res = CURLE_OK;
-    std::shared_ptr<CURL> curl_handle( curl_easy_init() , curl_easy_cleanup );
-    if ( curl_handle.get() == nullptr )
-    {
-        except_message += ":libcurl easy initial failure";
-        throw std::runtime_error( except_message );
-    }
-    do
-    {
-        curl_easy_setopt( curl_handle.get() , CURLOPT_URL , api_url.c_str() );
-        curl_easy_setopt( curl_handle.get() , CURLOPT_VERBOSE , 0L );
-        curl_easy_setopt( curl_handle.get() , CURLOPT_FOLLOWLOCATION , 1L );
-        curl_easy_setopt( curl_handle.get() , CURLOPT_USE_SSL , 1L );
-        curl_easy_setopt( curl_handle.get() , CURLOPT_NOPROGRESS , 1L );
-        curl_easy_setopt( curl_handle.get() , CURLOPT_TIMEOUT , default_timeout );
-        curl_easy_setopt( curl_handle.get() , CURLOPT_WRITEFUNCTION , get_json_callback );
-        curl_easy_setopt( curl_handle.get() , CURLOPT_WRITEDATA , &json_buff );
-        curl_easy_setopt( curl_handle.get() , CURLOPT_ERRORBUFFER , error_buff );
-        res = curl_easy_perform( curl_handle.get() );
-        if ( res != CURLE_OK )
-        {
-            if ( re_try == 0 )
-            {
-                except_message += ":get network puzzle failure,libcurl error message:";
-                except_message += error_buff;
-                throw std::runtime_error( except_message );
-            }
-            default_timeout += 10L;
-            re_try--;
-        }
-    }
-    while ( res != CURLE_OK );
-
-    json_error_t error;
-    std::shared_ptr<json_t> root( json_loads( json_buff.buff , 0 , &error ) , json_decref );
-    if ( root.get() == nullptr )
-    {
-        except_message += "network json:'";
-        except_message += json_buff.buff;
-        except_message += "' format does not meet expectations";
-        throw std::invalid_argument( except_message );
-    }
-    //{
-    //    "answer": "success",
-    //    "message": "Level exist",
-    //    "desc": [
-    //        "008000402000320780702506000003050004009740200006200000000000500900005600620000190",   //puzzle
-    //        "368179452591324786742586319213658974859743261476291835187962543934815627625437198",   //solution
-    //        310,
-    //        7,
-    //        false
-    //    ]
-    //}
-    json_t * desc_array = json_object_get( root.get() , "desc" );
-    if ( json_is_array( desc_array ) == false )
-    {
-        except_message += "network json:'";
-        std::shared_ptr<char> jsons( json_dumps( desc_array , JSON_INDENT( 4 ) ) , free );
-        except_message += jsons.get();
-        except_message += "' don't exist puzzle";
-        throw std::invalid_argument( except_message );
-    }
-    json_t * puzzle_node = json_array_get( desc_array , 0 );
-    if ( json_is_string( puzzle_node )  == false )
-    {
-        except_message += "network json:'";
-        std::shared_ptr<char> jsons( json_dumps( puzzle_node , JSON_INDENT( 4 ) ) , free );
-        except_message += jsons.get();
-        except_message += "' don't exist puzzle";
-        throw std::invalid_argument( except_message );
-    }
-    const char * puzzle_str = json_string_value( puzzle_node );
-    if ( strnlen( puzzle_str , SUDOKU_SIZE*SUDOKU_SIZE*2 ) != SUDOKU_SIZE*SUDOKU_SIZE )
-    {
-        except_message += "puzzle:'";
-        except_message += puzzle_str;
-        except_message += "'  size failure";
-        throw std::length_error( except_message );
-    }
-    
-    puzzle_t result = string_to_puzzle( std::string( puzzle_str ) );
-
-    free( json_buff.buff );
-    return result;
-}
+#include "trace.h"
 
 Sudoku::Sudoku( puzzle_t puzzle , SUDOKU_LEVEL level ) noexcept( false )
 {
@@ -271,24 +36,67 @@ Sudoku::Sudoku( puzzle_t puzzle , SUDOKU_LEVEL level ) noexcept( false )
         throw std::invalid_argument( except_message );
     }
     this->autoupdate = false;
+    this->allow_conflicts = false;
     this->level = level;
     this->puzzle = puzzle;
-    //std::map operator[],element unset default value:0(false)
-    //this->answer;
+    this->solution = { { 0 } };
+    this->has_solution = false;
     this->candidates = generate_candidates( this->puzzle );
+    this->rebuild_counters();
 }
 
 //only support 9X9 sudoku(SUDOKU_SIZE == 9)
 Sudoku::Sudoku() noexcept( false )
 {
+    SolveStatus status;
+    this->generate( SolveLimits() , status );
+}
+
+Sudoku::Sudoku( const SolveLimits& limits , SolveStatus& status ) noexcept( false )
+{
+    this->generate( limits , status );
+}
+
+void Sudoku::generate( const SolveLimits& limits , SolveStatus& status ) noexcept( false )
+{
+    SUDOKU_TRACE_SCOPE( "Sudoku::generate" );
+    static MetricHistogram& generate_us = metrics().histogram( "generator.generate_us" );
+    MetricTimer timer( generate_us );
     constexpr cell_t clues_number = 17;
 
     this->autoupdate = false;
-    cell_t range = SUDOKU_SIZE*SUDOKU_SIZE - 17;
-    cell_t level_range = range/static_cast<cell_t>( SUDOKU_LEVEL::_LEVEL_COUNT );
-    this->level = static_cast<SUDOKU_LEVEL>( clues_number/level_range );
+    this->allow_conflicts = false;
+    this->solution = { { 0 } };
+    this->has_solution = false;
+    this->level = SUDOKU_LEVEL::EASY;
     this->puzzle = { { 0 } };
 
+    //node budget shared by every search of the generation
+    SolveLimits search_limits = limits;
+    std::uint64_t nodes = 0;
+    auto solve = [ this , &limits , &search_limits , &nodes ]( std::vector<puzzle_t>& solutions , std::size_t solution_limit ) -> SolveStatus
+    {
+        if ( limits.node_budget != 0 )
+        {
+            if ( nodes >= limits.node_budget )
+                return SolveStatus::BUDGET_EXCEEDED;
+            search_limits.node_budget = limits.node_budget - nodes;
+        }
+        std::uint64_t used = 0;
+        SolveStatus result = solve_puzzle( this->puzzle , solutions , solution_limit , search_limits , used );
+        nodes += used;
+        return result;
+    };
+    auto finish = [ this , &status ]( SolveStatus result )
+    {
+        status = result;
+        //the puzzle as carved,graded like every other puzzle
+        if ( this->puzzle != puzzle_t() )
+            this->level = grade_puzzle( this->puzzle );
+        this->candidates = generate_candidates( this->puzzle );
+        this->rebuild_counters();
+    };
+
     std::random_device rand_div;
     std::mt19937 rand_gen( rand_div() );
     std::uniform_int_distribution int_dist( 0 , SUDOKU_SIZE - 1 );
@@ -296,7 +104,16 @@ Sudoku::Sudoku() noexcept( false )
     cell_t y = int_dist( rand_gen );
     cell_t value = int_dist( rand_gen );
     this->puzzle[x][y] = value + 1;
-    this->puzzle = this->get_solution( false )[0];
+    std::vector<puzzle_t> full_grid;
+    SolveStatus result = solve( full_grid , 1 );
+    if ( full_grid.empty() )
+    {
+        //stopped before any grid,empty board
+        this->puzzle = { { 0 } };
+        finish( result );
+        return ;
+    }
+    this->puzzle = full_grid[0];
 
     //todo if clues > request clues number,but all postion can't remove clues,return 
     for( std::size_t clues = SUDOKU_SIZE*SUDOKU_SIZE ; clues > clues_number ; clues-- )
@@ -319,7 +136,16 @@ Sudoku::Sudoku() noexcept( false )
             }
             cell_t old_value = this->puzzle[x][y];
             this->puzzle[x][y] = 0;
-            auto all_solution = this->get_solution( true );
+            //a second solution is enough to refuse the removal
+            std::vector<puzzle_t> all_solution;
+            result = solve( all_solution , 2 );
+            if ( result != SolveStatus::COMPLETE )
+            {
+                //unique puzzle with the clues removed so far
+                this->puzzle[x][y] = old_value;
+                finish( result );
+                return ;
+            }
             if ( all_solution.size() != 1  )
             {
                 this->puzzle[x][y] = old_value;
@@ -331,20 +157,24 @@ Sudoku::Sudoku() noexcept( false )
         }
         //no clues that can be removed
         if ( can_remove == 0 )
-        {
-            this->candidates = generate_candidates( this->puzzle );
-            return ;
-        }
+            break;
     }
-    this->candidates = generate_candidates( this->puzzle );
+    finish( SolveStatus::COMPLETE );
 }
 
 Sudoku::Sudoku( const Sudoku& sudoku ):
     autoupdate( sudoku.autoupdate ),
+    allow_conflicts( sudoku.allow_conflicts ),
     level( sudoku.level ),
     puzzle( sudoku.puzzle ),
-    answer( sudoku.answer ),
-    candidates( sudoku.candidates )
+    answers( sudoku.answers ),
+    candidates( sudoku.candidates ),
+    unit_counts( sudoku.unit_counts ),
+    filled_cells( sudoku.filled_cells ),
+    conflict_units( sudoku.conflict_units ),
+    solution( sudoku.solution ),
+    has_solution( sudoku.has_solution ),
+    wrong_cells( sudoku.wrong_cells )
 {
     ;
 }
@@ -352,19 +182,39 @@ Sudoku::Sudoku( const Sudoku& sudoku ):
 Sudoku::Sudoku( Sudoku&& sudoku ) noexcept( true )
 {
     this->autoupdate = std::move( sudoku.autoupdate );
+    this->allow_conflicts = sudoku.allow_conflicts;
     this->level = std::move( sudoku.level );
     this->puzzle = std::move( sudoku.puzzle );
-    this->answer = std::move( sudoku.answer );
+    this->answers = sudoku.answers;
     this->candidates = std::move( sudoku.candidates );
+    this->unit_counts = sudoku.unit_counts;
+    this->filled_cells = sudoku.filled_cells;
+    this->conflict_units = sudoku.conflict_units;
+    this->solution = sudoku.solution;
+    this->has_solution = sudoku.has_solution;
+    this->wrong_cells = sudoku.wrong_cells;
 }
 
 Sudoku& Sudoku::operator=( const Sudoku& sudoku )
 {
     this->autoupdate = sudoku.autoupdate;
+    this->allow_conflicts = sudoku.allow_conflicts;
     this->level = sudoku.level;
     this->puzzle = sudoku.puzzle;
-    this->answer = sudoku.answer;
+    this->answers = sudoku.answers;
     this->candidates = sudoku.candidates;
+    this->unit_counts = sudoku.unit_counts;
+    this->filled_cells = sudoku.filled_cells;
+    this->conflict_units = sudoku.conflict_units;
+    this->solution = sudoku.solution;
+    this->has_solution = sudoku.has_solution;
+    this->wrong_cells = sudoku.wrong_cells;
+    CellChange change;
+    change.digits.set();
+    change.candidates.set();
+    change.answers.set();
+    change.conflicts.set();
+    this->notify_change( change );
     return *this;
 }
 
@@ -373,10 +223,23 @@ Sudoku& Sudoku::operator=( Sudoku&& sudoku ) noexcept( true )
     if ( this != &sudoku )
     {
         this->autoupdate = std::move( sudoku.autoupdate );
+        this->allow_conflicts = sudoku.allow_conflicts;
         this->level = std::move( sudoku.level );
         this->puzzle = std::move( sudoku.puzzle );
-        this->answer = std::move( sudoku.answer );
+        this->answers = sudoku.answers;
         this->candidates = std::move( sudoku.candidates );
+        this->unit_counts = sudoku.unit_counts;
+        this->filled_cells = sudoku.filled_cells;
+        this->conflict_units = sudoku.conflict_units;
+        this->solution = sudoku.solution;
+        this->has_solution = sudoku.has_solution;
+        this->wrong_cells = sudoku.wrong_cells;
+        CellChange change;
+        change.digits.set();
+        change.candidates.set();
+        change.answers.set();
+        change.conflicts.set();
+        this->notify_change( change );
     }
     return *this;
 }
@@ -386,152 +249,350 @@ void Sudoku::autoupdate_candidate( bool flags ) noexcept( true )
     this->autoupdate = flags;
 }
 
-void Sudoku::fill_answer( std::size_t x , std::size_t y , std::size_t value ) noexcept( false )
+bool Sudoku::is_autoupdate_candidate( void ) const noexcept( true )
 {
-    std::string except_message( __func__ );
+    return this->autoupdate;
+}
 
-    //std::size_t is unsigned interger the value >= 0;
-    if ( x > SUDOKU_SIZE )
+void Sudoku::allow_conflict( bool flags ) noexcept( true )
+{
+    this->allow_conflicts = flags;
+}
+
+bool Sudoku::is_allow_conflict( void ) const noexcept( true )
+{
+    return this->allow_conflicts;
+}
+
+void Sudoku::set_solution( const puzzle_t& solution ) noexcept( true )
+{
+    this->solution = solution;
+    this->has_solution = ( solution != puzzle_t() );
+    this->wrong_cells = 0;
+    if ( this->has_solution == false )
+        return ;
+    for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
     {
-        except_message += ":argument x value:" + std::to_string( x );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
+        for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            if ( this->puzzle[x][y] != this->solution[x][y] )
+                this->wrong_cells++;
+        }
     }
-    //std::size_t is unsigned interger the value >= 0;
-    if ( y > SUDOKU_SIZE )
+}
+
+static std::array<std::size_t , 3> get_units( std::size_t x , std::size_t y )
+{
+    return { x , SUDOKU_SIZE + y , 2*SUDOKU_SIZE + ( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + y/SUDOKU_BOX_SIZE };
+}
+
+void Sudoku::set_cell( std::size_t x , std::size_t y , cell_t value ) noexcept( true )
+{
+    cell_t old_value = this->puzzle[x][y];
+    if ( old_value == value )
+        return ;
+    auto units = get_units( x , y );
+    //set_state don't check value,out of range digit only stored
+    if ( ( old_value != 0 ) && ( old_value <= SUDOKU_SIZE ) )
     {
-        except_message += ":argument y value:" + std::to_string( y );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
+        this->filled_cells--;
+        for ( auto unit : units )
+        {
+            if ( this->unit_counts[unit][old_value]-- == 2 )
+                this->conflict_units--;
+        }
     }
-
-    postion_t pos = { x , y };
-    if ( ( this->puzzle[x][y] != 0 ) && ( this->answer[pos] == false ) )
+    if ( ( value != 0 ) && ( value <= SUDOKU_SIZE ) )
     {
-        except_message += ":cell:( " + std::to_string( x );
-        except_message += " , " + std::to_string( y ) + " ) is puzzle content,can't be modify";
-        throw std::out_of_range( except_message );
+        this->filled_cells++;
+        for ( auto unit : units )
+        {
+            if ( ++this->unit_counts[unit][value] == 2 )
+                this->conflict_units++;
+        }
     }
-    if ( value > SUDOKU_SIZE )
+    if ( this->has_solution )
     {
-        except_message += ":argument value value:( " + std::to_string( value );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
+        this->wrong_cells -= ( old_value != this->solution[x][y] );
+        this->wrong_cells += ( value != this->solution[x][y] );
     }
-
-    auto temp = this->puzzle[x][y];
     this->puzzle[x][y] = value;
-    if ( fill_check( this->puzzle , x , y ) == false )
+}
+
+void Sudoku::set_cell( std::size_t x , std::size_t y , cell_t value , std::bitset< SUDOKU_SIZE*SUDOKU_SIZE >& conflicts ) noexcept( true )
+{
+    cell_t old_value = this->puzzle[x][y];
+    if ( old_value == value )
+        return ;
+    bool had_conflict = ( this->conflict_units != 0 );
+    //only the counters of old_value and value in the three units of the cell move:
+    //the cell itself and the peers holding one of them are the only cells which may change state
+    std::array<std::size_t , 3*SUDOKU_SIZE> cells;
+    std::array<bool , 3*SUDOKU_SIZE> before;
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > seen;
+    std::size_t cell_number = 0;
+    auto add = [ this , &cells , &before , &seen , &cell_number ]( std::size_t cell_x , std::size_t cell_y )
     {
-        //backup puzzle
-        this->puzzle[x][y] = temp;
-        except_message += ":puzzle illegal";
-        throw std::invalid_argument( except_message );
+        std::size_t index = cell_x*SUDOKU_SIZE + cell_y;
+        if ( seen[index] )
+            return ;
+        seen.set( index );
+        cells[cell_number] = index;
+        before[cell_number++] = this->is_conflict( cell_x , cell_y );
+    };
+    add( x , y );
+    for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        std::size_t box_x = ( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + i/SUDOKU_BOX_SIZE;
+        std::size_t box_y = ( y/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + i%SUDOKU_BOX_SIZE;
+        const std::pair<std::size_t,std::size_t> peers[] = { { x , i } , { i , y } , { box_x , box_y } };
+        for ( auto& peer : peers )
+        {
+            cell_t peer_value = this->puzzle[peer.first][peer.second];
+            if ( ( peer_value != 0 ) && ( ( peer_value == old_value ) || ( peer_value == value ) ) )
+                add( peer.first , peer.second );
+        }
+    }
+    this->set_cell( x , y , value );
+    if ( ( had_conflict == false ) && ( this->conflict_units == 0 ) )
+        return ;
+    for ( std::size_t k = 0 ; k < cell_number ; k++ )
+    {
+        if ( before[k] != this->is_conflict( cells[k]/SUDOKU_SIZE , cells[k]%SUDOKU_SIZE ) )
+            conflicts.flip( cells[k] );
     }
-
-   //value == 0 erase operator set this->answer[pos] = false
-   //value != 0 fill operator set this->answer[pos] = true
-    this->answer[pos] = bool(value);
-    if ( this->autoupdate )
-        update_candidates( this->candidates , this->puzzle , x , y );
 }
 
-void Sudoku::erase_answer( std::size_t x , std::size_t y ) noexcept( false )
+void Sudoku::rebuild_counters( void ) noexcept( true )
 {
-    this->fill_answer( x , y  , 0 );
+    puzzle_t puzzle = this->puzzle;
+    this->puzzle = { { 0 } };
+    for ( auto& unit : this->unit_counts )
+    {
+        unit.fill( 0 );
+    }
+    this->filled_cells = 0;
+    this->conflict_units = 0;
+    //every solution digit differ from empty cell
+    this->wrong_cells = this->has_solution ? SUDOKU_SIZE*SUDOKU_SIZE : 0;
+    for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
+    {
+        for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            this->set_cell( x , y , puzzle[x][y] );
+        }
+    }
 }
 
-bool Sudoku::is_answer( std::size_t x , std::size_t y ) noexcept( false )
+bool Sudoku::is_conflict( std::size_t x , std::size_t y ) const noexcept( true )
 {
-    std::string except_message( __func__ );
-
-    //std::size_t is unsigned interger the value >= 0;
-    if ( x > SUDOKU_SIZE )
+    if ( ( this->conflict_units == 0 ) || ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) )
+        return false;
+    cell_t value = this->puzzle[x][y];
+    if ( ( value == 0 ) || ( value > SUDOKU_SIZE ) )
+        return false;
+    for ( auto unit : get_units( x , y ) )
     {
-        except_message += ":argument x value:" + std::to_string( x );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
+        if ( this->unit_counts[unit][value] > 1 )
+            return true;
     }
-    //std::size_t is unsigned interger the value >= 0;
-    if ( y > SUDOKU_SIZE )
+    return false;
+}
+
+std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > Sudoku::get_conflicts( void ) const noexcept( true )
+{
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > conflicts;
+    if ( this->conflict_units == 0 )
+        return conflicts;
+    for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
     {
-        except_message += ":argument y value:" + std::to_string( y );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
+        for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            conflicts[ x*SUDOKU_SIZE + y ] = this->is_conflict( x , y );
+        }
     }
+    return conflicts;
+}
 
-    postion_t pos = { x , y };
-    return this->answer[pos];
+bool Sudoku::is_complete( void ) const noexcept( true )
+{
+    return ( this->filled_cells == SUDOKU_SIZE*SUDOKU_SIZE ) && ( this->conflict_units == 0 );
 }
 
-void Sudoku::fill_candidates( std::size_t x , std::size_t y , std::vector<cell_t> candidates ) noexcept( false )
+bool Sudoku::is_solved( void ) const noexcept( true )
 {
-    std::string except_message( __func__ );
+    if ( this->has_solution )
+        return this->wrong_cells == 0;
+    return this->is_complete();
+}
 
-    //std::size_t is unsigned interger the value >= 0;
-    if ( x > SUDOKU_SIZE )
-    {
-        except_message += ":argument x value:" + std::to_string( x );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
-    }
-    //std::size_t is unsigned interger the value >= 0;
-    if ( y > SUDOKU_SIZE )
+void Sudoku::set_change_listener( change_listener_t listener ) noexcept( true )
+{
+    this->change_listener = std::move( listener );
+}
+
+void Sudoku::notify_change( const CellChange& change )
+{
+    if ( this->change_listener && change.get_cells().any() )
+        this->change_listener( change );
+}
+
+SudokuStatus Sudoku::try_fill_answer( std::size_t x , std::size_t y , std::size_t value ) noexcept( true )
+{
+    if ( ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) || ( value > SUDOKU_SIZE ) )
+        return SudokuStatus::OUT_OF_RANGE;
+    std::size_t index = x*SUDOKU_SIZE + y;
+    if ( ( this->puzzle[x][y] != 0 ) && ( this->answers[index] == false ) )
+        return SudokuStatus::GIVEN_CELL;
+
+    auto temp = this->puzzle[x][y];
+    if ( ( this->allow_conflicts == false ) && ( value != 0 ) && ( value != temp ) )
     {
-        except_message += ":argument y value:" + std::to_string( y );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
+        //cell itself hold temp,so any count of value is another cell
+        for ( auto unit : get_units( x , y ) )
+        {
+            if ( this->unit_counts[unit][value] != 0 )
+                return SudokuStatus::CONFLICT;
+        }
     }
-    if ( candidates.empty() )
-        return ;
-
-    for ( auto value : candidates )
+    CellChange change;
+    this->set_cell( x , y , value , change.conflicts );
+    change.digits[index] = ( temp != value );
+    //value == 0 erase operator clear the answer flag,value != 0 fill operator set it
+    change.answers[index] = ( this->answers[index] != bool(value) );
+    this->answers[index] = bool(value);
+    if ( this->autoupdate && ( value != 0 ) )
     {
-        if ( value >SUDOKU_SIZE)
+        //peer which still hold value lose it
+        for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
         {
-            continue;
+            std::size_t box_x = ( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + i/SUDOKU_BOX_SIZE;
+            std::size_t box_y = ( y/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + i%SUDOKU_BOX_SIZE;
+            const std::pair<std::size_t,std::size_t> peers[] = { { x , i } , { i , y } , { box_x , box_y } };
+            for ( auto& peer : peers )
+            {
+                auto& cell_candidates = this->candidates[peer.first][peer.second];
+                if ( std::find( cell_candidates.begin() , cell_candidates.end() , value ) != cell_candidates.end() )
+                    change.candidates.set( peer.first*SUDOKU_SIZE + peer.second );
+            }
         }
-        auto value_iter = std::find( this->candidates[x][y].begin() , this->candidates[x][y].end() , value );
-        if ( value_iter == this->candidates[x][y].end() )
-            this->candidates[x][y].push_back( value );
+        update_candidates( this->candidates , this->puzzle , x , y );
     }
+    this->notify_change( change );
+    return SudokuStatus::OK;
+}
 
+SudokuStatus Sudoku::try_erase_answer( std::size_t x , std::size_t y ) noexcept( true )
+{
+    return this->try_fill_answer( x , y , 0 );
 }
 
-void Sudoku::erase_candidates( std::size_t x , std::size_t y , std::vector<cell_t> candidates ) noexcept( false )
+SudokuStatus Sudoku::try_fill_candidates( std::size_t x , std::size_t y , candidate_mask_t mask ) noexcept( true )
 {
-    std::string except_message( __func__ );
+    if ( ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) )
+        return SudokuStatus::OUT_OF_RANGE;
+    auto& cell_candidates = this->candidates[x][y];
+    candidate_mask_t added = mask & ~cell_candidates.get_mask() & ( ( 1U << SUDOKU_SIZE ) - 1 );
+    if ( added == 0 )
+        return SudokuStatus::OK;
+    for ( cell_t value = 1 ; value <= SUDOKU_SIZE ; value++ )
+    {
+        if ( added & ( 1U << ( value - 1 ) ) )
+            cell_candidates.push_back( value );
+    }
+    CellChange change;
+    change.candidates.set( x*SUDOKU_SIZE + y );
+    this->notify_change( change );
+    return SudokuStatus::OK;
+}
 
-    //std::size_t is unsigned interger the value >= 0;
-    if ( x > SUDOKU_SIZE )
+SudokuStatus Sudoku::try_erase_candidates( std::size_t x , std::size_t y , candidate_mask_t mask ) noexcept( true )
+{
+    if ( ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) )
+        return SudokuStatus::OUT_OF_RANGE;
+    auto& cell_candidates = this->candidates[x][y];
+    if ( ( mask & cell_candidates.get_mask() ) == 0 )
+        return SudokuStatus::OK;
+    CandidateList kept;
+    for ( auto value : cell_candidates )
     {
-        except_message += ":argument x value:" + std::to_string( x );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
+        if ( ( mask & ( 1U << ( value - 1 ) ) ) == 0 )
+            kept.push_back( value );
     }
-    //std::size_t is unsigned interger the value >= 0;
-    if ( y > SUDOKU_SIZE )
+    cell_candidates = kept;
+    CellChange change;
+    change.candidates.set( x*SUDOKU_SIZE + y );
+    this->notify_change( change );
+    return SudokuStatus::OK;
+}
+
+SudokuStatus Sudoku::try_is_answer( std::size_t x , std::size_t y , bool& answer ) const noexcept( true )
+{
+    if ( ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) )
+        return SudokuStatus::OUT_OF_RANGE;
+    answer = this->answers[ x*SUDOKU_SIZE + y ];
+    return SudokuStatus::OK;
+}
+
+//message only built on failure,the try_* path never allocate
+static void throw_status( SudokuStatus status , const char * function , std::size_t x , std::size_t y , std::size_t value )
+{
+    std::string except_message( function );
+    switch ( status )
     {
-        except_message += ":argument y value:" + std::to_string( y );
-        except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
-        throw std::out_of_range( except_message );
+        case SudokuStatus::OK:
+            return ;
+        case SudokuStatus::OUT_OF_RANGE:
+            except_message += ":argument ( " + std::to_string( x ) + " , " + std::to_string( y ) + " ) value:" + std::to_string( value );
+            except_message += ",out of range [ 0 , " + std::to_string( SUDOKU_SIZE ) + " ]";
+            throw std::out_of_range( except_message );
+        case SudokuStatus::GIVEN_CELL:
+            except_message += ":cell:( " + std::to_string( x );
+            except_message += " , " + std::to_string( y ) + " ) is puzzle content,can't be modify";
+            throw std::out_of_range( except_message );
+        case SudokuStatus::CONFLICT:
+            except_message += ":puzzle illegal";
+            throw std::invalid_argument( except_message );
     }
-    if ( candidates.empty() )
-        return ;
-    
+}
+
+//digits above SUDOKU_SIZE are skipped,same as before the mask api
+static candidate_mask_t to_candidate_mask( const std::vector<cell_t>& candidates )
+{
+    candidate_mask_t mask = 0;
     for ( auto value : candidates )
     {
-        if ( value >SUDOKU_SIZE)
-        {
-            continue;
-        }
-        auto value_iter = std::find( this->candidates[x][y].begin() , this->candidates[x][y].end() , value );
-
-        if ( value_iter != this->candidates[x][y].end() )
-        {
-            this->candidates[x][y].erase( value_iter );
-        }
+        if ( ( value != 0 ) && ( value <= SUDOKU_SIZE ) )
+            mask |= 1U << ( value - 1 );
     }
+    return mask;
+}
+
+void Sudoku::fill_answer( std::size_t x , std::size_t y , std::size_t value ) noexcept( false )
+{
+    throw_status( this->try_fill_answer( x , y , value ) , __func__ , x , y , value );
+}
+
+void Sudoku::erase_answer( std::size_t x , std::size_t y ) noexcept( false )
+{
+    throw_status( this->try_erase_answer( x , y ) , __func__ , x , y , 0 );
+}
+
+bool Sudoku::is_answer( std::size_t x , std::size_t y ) const noexcept( false )
+{
+    bool answer = false;
+    throw_status( this->try_is_answer( x , y , answer ) , __func__ , x , y , 0 );
+    return answer;
+}
+
+void Sudoku::fill_candidates( std::size_t x , std::size_t y , std::vector<cell_t> candidates ) noexcept( false )
+{
+    throw_status( this->try_fill_candidates( x , y , to_candidate_mask( candidates ) ) , __func__ , x , y , 0 );
+}
+
+void Sudoku::erase_candidates( std::size_t x , std::size_t y , std::vector<cell_t> candidates ) noexcept( false )
+{
+    throw_status( this->try_erase_candidates( x , y , to_candidate_mask( candidates ) ) , __func__ , x , y , 0 );
 }
 
 SUDOKU_LEVEL Sudoku::get_puzzle_level( void ) const noexcept( true )
@@ -544,8 +605,71 @@ const candidate_t& Sudoku::get_candidates( void ) const noexcept( true )
     return this->candidates;
 }
 
+candidate_mask_t Sudoku::get_candidate_mask( std::size_t x , std::size_t y ) const noexcept( true )
+{
+    if ( ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) )
+        return 0;
+    return this->candidates[x][y].get_mask();
+}
+
 std::vector<puzzle_t> Sudoku::get_solution( bool need_all ) noexcept( false )
 {
+    std::vector<puzzle_t> results;
+    std::uint64_t nodes = 0;
+    solve_puzzle( this->puzzle , results , need_all ? 0 : 1 , SolveLimits() , nodes );
+    return results;
+}
+
+SolveStatus Sudoku::get_solution( std::vector<puzzle_t>& solutions , std::size_t solution_limit , const SolveLimits& limits ) noexcept( false )
+{
+    std::uint64_t nodes = 0;
+    return solve_puzzle( this->puzzle , solutions , solution_limit , limits , nodes );
+}
+
+SolveStatus Sudoku::get_solution( std::vector<puzzle_t>& solutions , std::size_t solution_limit , const SolveLimits& limits ,
+                                  SolverEngine engine ) noexcept( false )
+{
+    if ( engine == SolverEngine::DANCING_LINKS )
+        return this->get_solution( solutions , solution_limit , limits );
+    //a single lane,the other lanes idle
+    BatchSolution result;
+    lockstep_solve( &this->puzzle , 1 , &result , solution_limit , limits , &solutions );
+    return result.status;
+}
+
+void Sudoku::solve_batch( const std::vector<puzzle_t>& puzzles , std::vector<BatchSolution>& results , std::size_t solution_limit ,
+                          const SolveLimits& limits , SolverEngine engine ) noexcept( false )
+{
+    SUDOKU_TRACE_SCOPE( "Sudoku::solve_batch" );
+    static MetricHistogram& batch_us = metrics().histogram( "solver.batch_us" );
+    MetricTimer timer( batch_us );
+    results.assign( puzzles.size() , BatchSolution() );
+    if ( engine == SolverEngine::LOCKSTEP )
+    {
+        lockstep_solve( puzzles.data() , puzzles.size() , results.data() , solution_limit , limits );
+        return ;
+    }
+    std::vector<puzzle_t> solutions;
+    for ( std::size_t i = 0 ; i < puzzles.size() ; i++ )
+    {
+        BatchSolution& result = results[i];
+        result.legal = check_puzzle( puzzles[i] );
+        if ( result.legal == false )
+            continue;
+        solutions.clear();
+        result.status = solve_puzzle( puzzles[i] , solutions , solution_limit , limits , result.nodes );
+        result.solution_count = solutions.size();
+        if ( solutions.empty() == false )
+            result.solution = solutions[0];
+    }
+}
+
+SolveStatus Sudoku::solve_puzzle( const puzzle_t& puzzle , std::vector<puzzle_t>& solutions , std::size_t solution_limit ,
+                                  const SolveLimits& limits , std::uint64_t& nodes ) noexcept( false )
+{
+    SUDOKU_TRACE_SCOPE( "Sudoku::solve_puzzle" );
+    static MetricHistogram& solve_us = metrics().histogram( "solver.solve_us" );
+    MetricTimer timer( solve_us );
     //every placement of a number in a position is a subset --> 9*9*9
     constexpr std::size_t rows = SUDOKU_SIZE*SUDOKU_SIZE*SUDOKU_SIZE;
     //a cell can have only 1 number : 9*9 constraints
@@ -564,27 +688,27 @@ std::vector<puzzle_t> Sudoku::get_solution( bool need_all ) noexcept( false )
         for ( std::size_t j = 0 ; j < SUDOKU_SIZE ; j++ )
         {
             //allowed cell
-            if ( this->puzzle[i][j] == 0 )
+            if ( puzzle[i][j] == 0 )
                 continue;
             for ( std::size_t k = 0 ; k < SUDOKU_SIZE ; k++ )
             {
                 //other numbers can't in the same cell
                 disallow_row[ i*SUDOKU_SIZE*SUDOKU_SIZE + j*SUDOKU_SIZE + k ] = 0;
-                //this->puzzle[i][j] can't appear in another column in the same row
-                disallow_row[ i*SUDOKU_SIZE*SUDOKU_SIZE + k*SUDOKU_SIZE + this->puzzle[i][j] - 1 ] = 0;
-                //this->puzzle[i][j] can't appear in another row in the same column
-                disallow_row[ k*SUDOKU_SIZE*SUDOKU_SIZE + j*SUDOKU_SIZE + this->puzzle[i][j] - 1 ] = 0;
-                //this->puzzle[i][j] can't appear in another cell in the same box
-                disallow_row[ get_box_index( i , k )*SUDOKU_SIZE*SUDOKU_SIZE + get_box_index( j , k )*SUDOKU_SIZE + this->puzzle[i][j] - 1 ] = 0;
+                //puzzle[i][j] can't appear in another column in the same row
+                disallow_row[ i*SUDOKU_SIZE*SUDOKU_SIZE + k*SUDOKU_SIZE + puzzle[i][j] - 1 ] = 0;
+                //puzzle[i][j] can't appear in another row in the same column
+                disallow_row[ k*SUDOKU_SIZE*SUDOKU_SIZE + j*SUDOKU_SIZE + puzzle[i][j] - 1 ] = 0;
+                //puzzle[i][j] can't appear in another cell in the same box
+                disallow_row[ get_box_index( i , k )*SUDOKU_SIZE*SUDOKU_SIZE + get_box_index( j , k )*SUDOKU_SIZE + puzzle[i][j] - 1 ] = 0;
             }
             //cell constraint satisfied
             disallow_column[ i*SUDOKU_SIZE + j ] = 0;
             //row constraint satisfied
-            disallow_column[ 1*SUDOKU_SIZE*SUDOKU_SIZE + i*SUDOKU_SIZE + this->puzzle[i][j] - 1 ] = 0;
+            disallow_column[ 1*SUDOKU_SIZE*SUDOKU_SIZE + i*SUDOKU_SIZE + puzzle[i][j] - 1 ] = 0;
             //colum constraint satisfied
-            disallow_column[ 2*SUDOKU_SIZE*SUDOKU_SIZE + j*SUDOKU_SIZE + this->puzzle[i][j] - 1 ] = 0;
+            disallow_column[ 2*SUDOKU_SIZE*SUDOKU_SIZE + j*SUDOKU_SIZE + puzzle[i][j] - 1 ] = 0;
             //box constraint satisfied
-            disallow_column[ 3*SUDOKU_SIZE*SUDOKU_SIZE + get_box_index( i , j )*SUDOKU_SIZE + this->puzzle[i][j] - 1 ] = 0;
+            disallow_column[ 3*SUDOKU_SIZE*SUDOKU_SIZE + get_box_index( i , j )*SUDOKU_SIZE + puzzle[i][j] - 1 ] = 0;
         }
     }
 
@@ -642,20 +766,19 @@ std::vector<puzzle_t> Sudoku::get_solution( bool need_all ) noexcept( false )
     DancingLinks N;
     N.create( R , C , matrix.get() );
     std::vector< std::vector<std::int32_t> > all_solution;
-    std::vector<std::int32_t> current_solution;
-    N.solve( all_solution , current_solution , need_all );
-    std::vector< puzzle_t > results = {};
+    SolveStatus status = N.solve( all_solution , solution_limit , limits );
+    nodes = N.get_node_count();
     for ( auto& solution : all_solution )
     {
-        puzzle_t result = this->puzzle;
+        puzzle_t result = puzzle;
         for ( std::size_t i = 0; i < solution.size() ; i++ )
         {
             std::size_t x = inverse_disallow_column[ solution[i] ];
             result[ x/( SUDOKU_SIZE*SUDOKU_SIZE ) ][ (x/SUDOKU_SIZE)%SUDOKU_SIZE ] = x%9 + 1;
         }
-        results.push_back( result );
+        solutions.push_back( result );
     }    
-    return results;
+    return status;
 }
 
 const puzzle_t& Sudoku::get_puzzle( void ) const noexcept( true )
@@ -663,6 +786,82 @@ const puzzle_t& Sudoku::get_puzzle( void ) const noexcept( true )
     return this->puzzle;
 }
 
+puzzle_t Sudoku::get_clues( void ) const noexcept( true )
+{
+    puzzle_t clues = this->puzzle;
+    for ( std::size_t index = 0 ; index < SUDOKU_SIZE*SUDOKU_SIZE ; index++ )
+    {
+        if ( this->answers[index] )
+            clues[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = 0;
+    }
+    return clues;
+}
+
+SudokuState Sudoku::get_state( void ) const noexcept( true )
+{
+    SudokuState state;
+    state.puzzle = this->puzzle;
+    state.answers = this->answers;
+    for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
+    {
+        for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            state.candidates[ x*SUDOKU_SIZE + y ] = this->candidates[x][y].get_mask();
+        }
+    }
+    return state;
+}
+
+void Sudoku::set_state( const SudokuState& state ) noexcept( false )
+{
+    CellChange change;
+    SudokuState current = this->get_state();
+    for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
+    {
+        for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            std::size_t index = x*SUDOKU_SIZE + y;
+            if ( this->puzzle[x][y] != state.puzzle[x][y] )
+            {
+                this->set_cell( x , y , state.puzzle[x][y] , change.conflicts );
+                change.digits.set( index );
+            }
+            if ( current.answers[index] != state.answers[index] )
+            {
+                this->answers[index] = state.answers[index];
+                change.answers.set( index );
+            }
+            if ( current.candidates[index] != state.candidates[index] )
+            {
+                this->candidates[x][y].clear();
+                for ( cell_t value = 1 ; value <= SUDOKU_SIZE ; value++ )
+                {
+                    if ( state.candidates[index] & ( 1U << ( value - 1 ) ) )
+                        this->candidates[x][y].push_back( value );
+                }
+                change.candidates.set( index );
+            }
+        }
+    }
+    this->notify_change( change );
+}
+
+const char * sudoku_status_to_string( SudokuStatus status ) noexcept( true )
+{
+    switch ( status )
+    {
+        case SudokuStatus::OK:
+            return "ok";
+        case SudokuStatus::OUT_OF_RANGE:
+            return "out of range";
+        case SudokuStatus::GIVEN_CELL:
+            return "puzzle content,can't be modify";
+        case SudokuStatus::CONFLICT:
+            return "puzzle illegal";
+    }
+    return "unknown";
+}
+
 std::string level_to_string( SUDOKU_LEVEL level ) noexcept( true )
 {
     std::string result;
@@ -689,48 +888,29 @@ std::string level_to_string( SUDOKU_LEVEL level ) noexcept( true )
 
 bool fill_check( const puzzle_t& puzzle , std::size_t x , std::size_t y ) noexcept( true )
 {
-    if ( puzzle.empty() )
-    {
+    if ( ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) || ( puzzle[x][y] > SUDOKU_SIZE ) )
         return false;
-    }
-    //std::size_t is unsigned interger the value >= 0;
-    if ( x > SUDOKU_SIZE )
+    //the three units of ( x , y ) only,a value above SUDOKU_SIZE in them is illegal too
+    for ( std::size_t unit = 0 ; unit < 3 ; unit++ )
     {
-        return false;
-    }
-    //std::size_t is unsigned interger the value >= 0;
-    if ( y > SUDOKU_SIZE )
-    {
-        return false;
-    }
-    //cell_t is unsigned interger the value >= 0;
-    if ( puzzle[x][y] > SUDOKU_SIZE )
-    {
-        return false;
-    }
-
-    std::map<cell_t , cell_t> columns_map;
-    std::map<cell_t , cell_t> row_map;
-    std::map<cell_t , cell_t> box_map;
-    for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
-    {
-        cell_t row_number = puzzle[x][i];
-        cell_t column_number = puzzle[i][y];
-        cell_t box_number = puzzle[( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + i/SUDOKU_BOX_SIZE ][ ( y/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + i%SUDOKU_BOX_SIZE ];
-        columns_map[row_number]++;
-        row_map[column_number]++;
-        box_map[box_number]++;
-        if ( ( columns_map[row_number] > 1 ) && ( row_number != 0 ) )
-        {
-            return false;
-        }
-        if ( ( row_map[column_number] > 1 ) && ( column_number != 0 ) )
+        candidate_mask_t seen = 0;
+        for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
         {
-            return false;
-        }
-        if ( ( box_map[box_number] > 1 ) && ( box_number != 0 ) )
-        {
-            return false;
+            cell_t value;
+            if ( unit == 0 )
+                value = puzzle[x][i];
+            else if ( unit == 1 )
+                value = puzzle[i][y];
+            else
+                value = puzzle[( x/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + i/SUDOKU_BOX_SIZE ][ ( y/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + i%SUDOKU_BOX_SIZE ];
+            if ( value == 0 )
+                continue;
+            if ( value > SUDOKU_SIZE )
+                return false;
+            candidate_mask_t bit = 1U << ( value - 1 );
+            if ( seen & bit )
+                return false;
+            seen |= bit;
         }
     }
     return true;
@@ -738,28 +918,40 @@ bool fill_check( const puzzle_t& puzzle , std::size_t x , std::size_t y ) noexce
 
 bool check_puzzle( const puzzle_t& puzzle ) noexcept( true )
 {
-    std::array< std::map< cell_t , cell_t > , SUDOKU_SIZE > columns_map;
-    std::array< std::map< cell_t , cell_t > , SUDOKU_SIZE > row_map;
-    std::array< std::map< cell_t , cell_t > , SUDOKU_SIZE > box_map;
-    for( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    return grid_masks( puzzle ).illegal == false;
+}
+
+bool check_solution( const puzzle_t& puzzle , const puzzle_t& solution ) noexcept( true )
+{
+    constexpr std::uint32_t full_mark = ( 1U << SUDOKU_SIZE ) - 1;
+    std::array< std::uint32_t , SUDOKU_SIZE > row_mark = {};
+    std::array< std::uint32_t , SUDOKU_SIZE > column_mark = {};
+    std::array< std::uint32_t , SUDOKU_SIZE > box_mark = {};
+    for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
     {
         for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
         {
-            int8_t number = puzzle[i][j];
-            if ( number < 0 || number > SUDOKU_SIZE )
+            cell_t number = solution[i][j];
+            if ( ( number == 0 ) || ( number > SUDOKU_SIZE ) )
             {
                 return false;
             }
-            cell_t box_index = ( i/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + j/SUDOKU_BOX_SIZE;
-            if ( number == 0 )
-                continue;
-            columns_map[i][number]++;
-            row_map[j][number]++;
-            box_map[box_index][number]++;
-            if ( columns_map[i][number] > 1 || row_map[j][number] > 1 || box_map[box_index][number] > 1 )
+            if ( ( puzzle[i][j] != 0 ) && ( puzzle[i][j] != number ) )
             {
                 return false;
             }
+            std::uint32_t bit = 1U << ( number - 1 );
+            row_mark[i] |= bit;
+            column_mark[j] |= bit;
+            box_mark[ ( i/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + j/SUDOKU_BOX_SIZE ] |= bit;
+        }
+    }
+    //81 digits and every unit contains all digits,so no duplicate
+    for ( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        if ( ( row_mark[i] != full_mark ) || ( column_mark[i] != full_mark ) || ( box_mark[i] != full_mark ) )
+        {
+            return false;
         }
     }
     return true;
@@ -771,6 +963,11 @@ std::string puzzle_to_string( const puzzle_t& puzzle ) noexcept( true )
     {
         return "failure puzzle can not convert to string";
     }
+    return grid_to_string( puzzle );
+}
+
+std::string grid_to_string( const puzzle_t& puzzle ) noexcept( true )
+{
     std::string result;
     for( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
     {
@@ -802,18 +999,100 @@ puzzle_t string_to_puzzle( std::string puzzle_string ) noexcept( true )
     return puzzle;
 }
 
-std::shared_future <puzzle_t> get_network_puzzle( SUDOKU_LEVEL level ) noexcept( false )
-{
-    std::packaged_task<puzzle_t()> task( std::bind( get_puzzle_callback , level ) );
-    std::shared_future <puzzle_t> puzzle_future = task.get_future();
-    std::thread( std::move(task) ).detach();
+//row( column ) orders:band( stack ) permutation then row( column ) permutation inside every band
+typedef std::array< cell_t , SUDOKU_SIZE > line_order_t;
+constexpr std::size_t LINE_ORDER_NUMBER = 6*6*6*6;
 
-    return puzzle_future;
+static const std::array< line_order_t , LINE_ORDER_NUMBER >& get_line_orders( void )
+{
+    static const std::array< line_order_t , LINE_ORDER_NUMBER > orders = []()
+    {
+        std::array< std::array< cell_t , SUDOKU_BOX_SIZE > , 6 > permutations;
+        std::array< cell_t , SUDOKU_BOX_SIZE > permutation = { 0 , 1 , 2 };
+        std::size_t count = 0;
+        do
+        {
+            permutations[count++] = permutation;
+        } while ( std::next_permutation( permutation.begin() , permutation.end() ) );
+
+        std::array< line_order_t , LINE_ORDER_NUMBER > built;
+        count = 0;
+        for ( const auto& bands : permutations )
+            for ( const auto& first : permutations )
+                for ( const auto& second : permutations )
+                    for ( const auto& third : permutations )
+                    {
+                        const std::array< cell_t , SUDOKU_BOX_SIZE > * inner[SUDOKU_BOX_SIZE] = { &first , &second , &third };
+                        for ( std::size_t band = 0 ; band < SUDOKU_BOX_SIZE ; band++ )
+                        {
+                            for ( std::size_t line = 0 ; line < SUDOKU_BOX_SIZE ; line++ )
+                                built[count][band*SUDOKU_BOX_SIZE + line] = bands[band]*SUDOKU_BOX_SIZE + ( *inner[band] )[line];
+                        }
+                        count++;
+                    }
+        return built;
+    }();
+    return orders;
 }
 
-puzzle_t get_local_puzzle( SUDOKU_LEVEL level ) noexcept( true )
+puzzle_t canonicalize_puzzle( const puzzle_t& puzzle ) noexcept( true )
 {
-    return string_to_puzzle( local_puzzles.get_puzzle_string( level ) );
+    const auto& orders = get_line_orders();
+    std::array< cell_t , SUDOKU_SIZE*SUDOKU_SIZE > best;
+    bool has_best = false;
+    for ( std::size_t transpose = 0 ; transpose < 2 ; transpose++ )
+    {
+        puzzle_t grid = puzzle;
+        if ( transpose != 0 )
+        {
+            for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+                for ( std::size_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+                    grid[i][j] = puzzle[j][i];
+        }
+        for ( const auto& rows : orders )
+        {
+            for ( const auto& columns : orders )
+            {
+                //first digit met become 1,compare with best while building,abort once greater
+                std::array< cell_t , SUDOKU_SIZE + 1 > relabel = { 0 };
+                cell_t next_label = 1;
+                bool less = ( has_best == false );
+                bool greater = false;
+                std::array< cell_t , SUDOKU_SIZE*SUDOKU_SIZE > form;
+                for ( std::size_t index = 0 ; index < form.size() ; index++ )
+                {
+                    cell_t value = grid[rows[index/SUDOKU_SIZE]][columns[index%SUDOKU_SIZE]];
+                    if ( value != 0 )
+                    {
+                        if ( relabel[value] == 0 )
+                            relabel[value] = next_label++;
+                        value = relabel[value];
+                    }
+                    if ( less == false )
+                    {
+                        if ( value > best[index] )
+                        {
+                            greater = true;
+                            break;
+                        }
+                        less = ( value < best[index] );
+                    }
+                    form[index] = value;
+                }
+                if ( ( greater == false ) && less )
+                {
+                    best = form;
+                    has_best = true;
+                }
+            }
+        }
+    }
+    puzzle_t result;
+    for ( std::size_t index = 0 ; index < best.size() ; index++ )
+    {
+        result[index/SUDOKU_SIZE][index%SUDOKU_SIZE] = best[index];
+    }
+    return result;
 }
 
 std::string candidates_to_string( const candidate_t& candidates ) noexcept( true )
@@ -864,25 +1143,21 @@ std::string candidates_to_string( const candidate_t& candidates ) noexcept( true
     return result;
 }
 
-//modify puzzle (x,y) to value update candidate map 
+//modify puzzle (x,y) to value update candidate map.
+//only the row,column and box of (x,y):a conflict elsewhere( allow_conflict ) never stop the elimination
 void update_candidates( candidate_t& candidates , const puzzle_t& puzzle , std::size_t x , std::size_t y ) noexcept( true )
 {
-    if ( check_puzzle( puzzle ) == false )
-    {
-        return ;
-    }
     //std::size_t is unsigned interger the value >= 0;
-    if ( x > SUDOKU_SIZE )
+    if ( ( x >= SUDOKU_SIZE ) || ( y >= SUDOKU_SIZE ) )
     {
         return ;
     }
-    //std::size_t is unsigned interger the value >= 0;
-    if ( y > SUDOKU_SIZE )
+
+    cell_t number = puzzle[x][y];
+    if ( ( number == 0 ) || ( number > SUDOKU_SIZE ) )
     {
         return ;
     }
-
-    cell_t number = puzzle[x][y];
     auto remove_condidate = [ &number ]( decltype( candidates[0][0] ) condidates ) -> void 
     {
         auto condidate_iterator = std::find( condidates.begin() , condidates.end() , number );
@@ -901,56 +1176,26 @@ void update_candidates( candidate_t& candidates , const puzzle_t& puzzle , std::
 
 candidate_t generate_candidates( const puzzle_t& puzzle ) noexcept( true )
 {
-    if ( check_puzzle( puzzle ) == false )
-    {
-        return candidate_t();
-    }
-    //if SUDOKU_SIZE == 9 : 0 - SUDOKU_SIZE element , 0X(ignore bit)111111111 disallow [1-9]
-    std::array< std::uint64_t , SUDOKU_SIZE > disallow_columns;
-    std::array< std::uint64_t , SUDOKU_SIZE > disallow_row;
-    std::array< std::uint64_t , SUDOKU_SIZE > disallow_box;
-    disallow_columns.fill( 0 );
-    disallow_row.fill( 0 );
-    disallow_box.fill( 0 );
-
-    for( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
-    {
-        for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
-        {
-            cell_t number = puzzle[i][j];
-            if ( number == 0 )
-                continue;
-            cell_t box_index = ( i/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + j/SUDOKU_BOX_SIZE;
-            disallow_columns[i] |= ( static_cast<std::uint64_t>(1) << ( number - 1 ) );
-            disallow_row[j] |= ( static_cast<std::uint64_t>(1) << ( number - 1 ) );
-            disallow_box[box_index] |= ( static_cast<std::uint64_t>(1) << ( number - 1 ) );
-        }
-    }
+    std::array< candidate_mask_t , SUDOKU_SIZE*SUDOKU_SIZE > masks;
     candidate_t result;
-    for( cell_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    if ( grid_candidates( puzzle , masks ) == false )
+        return result;
+    for ( std::size_t k = 0 ; k < SUDOKU_SIZE*SUDOKU_SIZE ; k++ )
     {
-        for ( cell_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+        for ( cell_t number = 1 ; number <= SUDOKU_SIZE ; number++ )
         {
-            cell_t number = puzzle[i][j];
-            if ( number != 0 )
-            {
-                continue;
-            }
-            cell_t box_index = ( i/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + j/SUDOKU_BOX_SIZE;
-            std::uint64_t allow_mark = ( ~( ( disallow_columns[i] | disallow_row[j] ) | disallow_box[box_index] ) );
-            for ( cell_t number = 0 ; number < SUDOKU_SIZE ; number++ )
-            {
-                if ( ( allow_mark & ( static_cast<std::uint64_t>(1) << number ) ) != 0 )
-                {
-                    result[i][j].push_back( number + 1 );
-                }
-                
-            }
+            if ( masks[k] & ( 1U << ( number - 1 ) ) )
+                result[k/SUDOKU_SIZE][k%SUDOKU_SIZE].push_back( number );
         }
     }
     return result;
 }
 
+bool operator==( const SudokuState& lhs , const SudokuState& rhs ) noexcept( true )
+{
+    return ( lhs.puzzle == rhs.puzzle ) && ( lhs.answers == rhs.answers ) && ( lhs.candidates == rhs.candidates );
+}
+
 bool operator==( const Sudoku& lhs , const Sudoku& rhs ) noexcept( true )
 {
     return ( lhs.get_puzzle() == rhs.get_puzzle() );
@@ -4,11 +4,17 @@
 
 #include <cstdint>
 
-#include <future>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <functional>
+#include <initializer_list>
 #include <map>
 #include <string>
 #include <vector>
 
+#include "dancinglinks.h"
+
 #ifdef SUDOKU_SIZE
 #undef SUDOKU_SIZE
 #endif
@@ -23,7 +29,102 @@ typedef std::uint8_t cell_t;
 typedef std::pair<cell_t , cell_t> postion_t;
 typedef std::array< std::array< cell_t , SUDOKU_SIZE > , SUDOKU_SIZE > puzzle_t;
 typedef std::map<postion_t , bool> answer_t;
-typedef std::array< std::array< std::vector< cell_t > , SUDOKU_SIZE > , SUDOKU_SIZE > candidate_t;
+//candidate k store in bit k - 1
+typedef std::uint16_t candidate_mask_t;
+
+//candidates of one cell in insertion order,fixed capacity:no allocation,copy is a plain copy
+class CandidateList
+{
+    public:
+        typedef cell_t * iterator;
+        typedef const cell_t * const_iterator;
+
+        CandidateList() noexcept( true ) = default;
+        CandidateList( std::initializer_list<cell_t> values ) noexcept( true )
+        {
+            for ( auto value : values )
+                this->push_back( value );
+        }
+
+        iterator begin( void ) noexcept( true ) { return this->values.data(); }
+        iterator end( void ) noexcept( true ) { return this->values.data() + this->count; }
+        const_iterator begin( void ) const noexcept( true ) { return this->values.data(); }
+        const_iterator end( void ) const noexcept( true ) { return this->values.data() + this->count; }
+        std::size_t size( void ) const noexcept( true ) { return this->count; }
+        bool empty( void ) const noexcept( true ) { return this->count == 0; }
+
+        //full list ignore the value
+        void push_back( cell_t value ) noexcept( true )
+        {
+            if ( this->count < SUDOKU_SIZE )
+                this->values[this->count++] = value;
+        }
+        iterator erase( const_iterator position ) noexcept( true )
+        {
+            iterator target = this->begin() + ( position - this->begin() );
+            std::copy( target + 1 , this->end() , target );
+            this->count--;
+            return target;
+        }
+        void clear( void ) noexcept( true ) { this->count = 0; }
+
+        candidate_mask_t get_mask( void ) const noexcept( true )
+        {
+            candidate_mask_t mask = 0;
+            for ( auto value : *this )
+                mask |= 1U << ( value - 1 );
+            return mask;
+        }
+    private:
+        std::array< cell_t , SUDOKU_SIZE > values{};
+        std::uint8_t count = 0;
+};
+
+typedef std::array< std::array< CandidateList , SUDOKU_SIZE > , SUDOKU_SIZE > candidate_t;
+
+//result of the non-throwing board operations( Sudoku::try_* )
+enum class SudokuStatus:std::uint8_t
+{
+    OK = 0,
+    //x,y or value out of range
+    OUT_OF_RANGE,
+    //cell is a puzzle clue
+    GIVEN_CELL,
+    //digit already in the row,column or box( allow_conflict off )
+    CONFLICT,
+};
+
+const char * sudoku_status_to_string( SudokuStatus status ) noexcept( true );
+
+//cells modified by one Sudoku operation,bit index:x*SUDOKU_SIZE + y
+struct CellChange
+{
+    //puzzle value changed
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > digits;
+    //candidate list changed,include autoupdate elimination
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > candidates;
+    //answer flag changed
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > answers;
+    //conflict state changed( peers of the modified cell too )
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > conflicts;
+
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > get_cells( void ) const noexcept( true )
+    {
+        return this->digits | this->candidates | this->answers | this->conflicts;
+    }
+};
+
+typedef std::function<void( const CellChange& )> change_listener_t;
+
+//plain value of the mutable board,index:x*SUDOKU_SIZE + y,candidate k store in bit k - 1
+struct SudokuState
+{
+    puzzle_t puzzle;
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > answers;
+    std::array< std::uint16_t , SUDOKU_SIZE*SUDOKU_SIZE > candidates;
+};
+
+bool operator==( const SudokuState& lhs , const SudokuState& rhs ) noexcept( true );
 
 enum class SUDOKU_LEVEL:std::uint8_t
 {
@@ -34,6 +135,29 @@ enum class SUDOKU_LEVEL:std::uint8_t
     _LEVEL_COUNT,
 };
 
+//search engine of the Sudoku solving calls
+enum class SolverEngine:std::uint8_t
+{
+    //exact cover,one puzzle at a time
+    DANCING_LINKS = 0,
+    //bitmask propagation,LOCKSTEP_LANES puzzles advanced together( src/lockstep.h ),for batches
+    LOCKSTEP,
+};
+
+//one puzzle of Sudoku::solve_batch
+struct BatchSolution
+{
+    SolveStatus status = SolveStatus::COMPLETE;
+    //false:clue repeated or out of range,not searched
+    bool legal = true;
+    //solutions found,stop at the solution limit
+    std::size_t solution_count = 0;
+    //first solution found,all zero without one
+    puzzle_t solution{};
+    //search node number used,engine specific
+    std::uint64_t nodes = 0;
+};
+
 class Sudoku
 {
     public:
@@ -42,8 +166,14 @@ class Sudoku
             [[deprecated("not implemented")]]
         #endif
         //only implemented limits:9X9 sudoku minimum clue number == 17
-        //try generate a puzzle,the clue number is 17
+        //try generate a puzzle,the clue number is 17,level is the grade_puzzle result
         Sudoku() noexcept( false );
+        #if SUDOKU_SIZE != 9
+            [[deprecated("not implemented")]]
+        #endif
+        //generator under limits,not COMPLETE:the unique puzzle reached so far( more clues ),
+        //all zero puzzle when stopped before the first full grid
+        Sudoku( const SolveLimits& limits , SolveStatus& status ) noexcept( false );
 
         Sudoku( const Sudoku& sudoku );
         Sudoku( Sudoku&& sudoku ) noexcept( true );
@@ -52,6 +182,26 @@ class Sudoku
         ~Sudoku() = default;
 
         void autoupdate_candidate( bool flags ) noexcept( true );
+        bool is_autoupdate_candidate( void ) const noexcept( true );
+        //fill_answer keep a conflicting digit on the board instead of throwing invalid_argument
+        void allow_conflict( bool flags ) noexcept( true );
+        bool is_allow_conflict( void ) const noexcept( true );
+        //known solution,is_solved compare with it.all zero puzzle forget it
+        void set_solution( const puzzle_t& solution ) noexcept( true );
+
+        //called synchronously after every operation which modify the board,
+        //the listener belong to this object,copy/move never transfer it
+        //whole board assignment report every cell
+        void set_change_listener( change_listener_t listener ) noexcept( true );
+
+        //board operations without exception or allocation,the board is unchanged unless OK.
+        //for replays,solvers and batch work;the throwing versions below wrap them
+        SudokuStatus try_fill_answer( std::size_t x , std::size_t y , std::size_t value ) noexcept( true );
+        SudokuStatus try_erase_answer( std::size_t x , std::size_t y ) noexcept( true );
+        //digits of mask add to/remove from the cell,bits above SUDOKU_SIZE ignored
+        SudokuStatus try_fill_candidates( std::size_t x , std::size_t y , candidate_mask_t mask ) noexcept( true );
+        SudokuStatus try_erase_candidates( std::size_t x , std::size_t y , candidate_mask_t mask ) noexcept( true );
+        SudokuStatus try_is_answer( std::size_t x , std::size_t y , bool& answer ) const noexcept( true );
 
         void fill_answer( std::size_t x , std::size_t y , std::size_t value ) noexcept( false );
 
@@ -61,23 +211,74 @@ class Sudoku
 
         void erase_candidates( std::size_t x , std::size_t y , std::vector<cell_t> candidates ) noexcept( false );
 
-        bool is_answer( std::size_t x , std::size_t y ) noexcept( false );
+        bool is_answer( std::size_t x , std::size_t y ) const noexcept( false );
+
+        //digit of cell repeat in its row,column or box,O(1)
+        bool is_conflict( std::size_t x , std::size_t y ) const noexcept( true );
+        //bit index:x*SUDOKU_SIZE + y,O(1) when there is no conflict
+        std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > get_conflicts( void ) const noexcept( true );
+        //every cell filled,no conflict,O(1)
+        bool is_complete( void ) const noexcept( true );
+        //board equal the solution of set_solution,without it same as is_complete(),O(1)
+        bool is_solved( void ) const noexcept( true );
 
         SUDOKU_LEVEL get_puzzle_level( void ) const noexcept( true );
 
         const candidate_t& get_candidates( void ) const noexcept( true );
+        //0 when x or y out of range
+        candidate_mask_t get_candidate_mask( std::size_t x , std::size_t y ) const noexcept( true );
 
         std::vector<puzzle_t> get_solution( bool need_all = false ) noexcept( false );
+        //append at most solution_limit( 0 all ) solutions,partial result when not COMPLETE
+        SolveStatus get_solution( std::vector<puzzle_t>& solutions , std::size_t solution_limit , const SolveLimits& limits ) noexcept( false );
+        SolveStatus get_solution( std::vector<puzzle_t>& solutions , std::size_t solution_limit , const SolveLimits& limits ,
+                                  SolverEngine engine ) noexcept( false );
+        //results[i] for puzzles[i] on the calling thread,node_budget per puzzle,stop and deadline for the whole batch.
+        //LOCKSTEP:several times the puzzles per second of DANCING_LINKS,same solution count,
+        //the first solution of a multi solution puzzle may differ
+        static void solve_batch( const std::vector<puzzle_t>& puzzles , std::vector<BatchSolution>& results , std::size_t solution_limit ,
+                                 const SolveLimits& limits , SolverEngine engine = SolverEngine::LOCKSTEP ) noexcept( false );
 
         const puzzle_t& get_puzzle( void ) const noexcept( true );
 
+        SudokuState get_state( void ) const noexcept( true );
+
+        //puzzle without answer cells
+        puzzle_t get_clues( void ) const noexcept( true );
+
+        //replace the board without legality check( undo/restore ),report only the cells really changed
+        void set_state( const SudokuState& state ) noexcept( false );
+
     private:
+        void generate( const SolveLimits& limits , SolveStatus& status ) noexcept( false );
+        //nodes:search node number used
+        static SolveStatus solve_puzzle( const puzzle_t& puzzle , std::vector<puzzle_t>& solutions , std::size_t solution_limit ,
+                                         const SolveLimits& limits , std::uint64_t& nodes ) noexcept( false );
+        void notify_change( const CellChange& change );
+        //every puzzle write go through it,keep unit counters up to date
+        void set_cell( std::size_t x , std::size_t y , cell_t value ) noexcept( true );
+        //set_cell,then flip the conflicts bit of every cell whose conflict state changed
+        void set_cell( std::size_t x , std::size_t y , cell_t value , std::bitset< SUDOKU_SIZE*SUDOKU_SIZE >& conflicts ) noexcept( true );
+        //counters from scratch after puzzle replaced
+        void rebuild_counters( void ) noexcept( true );
+
         bool autoupdate;
+        bool allow_conflicts;
         SUDOKU_LEVEL level;
         puzzle_t puzzle;
-        answer_t answer;
+        //cells filled by the player,bit index:x*SUDOKU_SIZE + y
+        std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > answers;
         candidate_t candidates;
-        //std::vector<puzzle_t> solution;
+        change_listener_t change_listener;
+        //digit count of every unit:row 0-8,column 9-17,box 18-26,slot 0 unused
+        std::array< std::array< cell_t , SUDOKU_SIZE + 1 > , 3*SUDOKU_SIZE > unit_counts;
+        std::size_t filled_cells;
+        //( unit , digit ) pairs which appear more than once
+        std::size_t conflict_units;
+        puzzle_t solution;
+        bool has_solution;
+        //cells differ from solution
+        std::size_t wrong_cells;
 };
 
 std::string level_to_string( SUDOKU_LEVEL level ) noexcept( true );
@@ -87,6 +288,9 @@ bool fill_check( const puzzle_t& puzzle , std::size_t x , std::size_t y ) noexce
 //not usage solution check
 bool check_puzzle( const puzzle_t& puzzle ) noexcept( true );
 
+//solution is complete,legal and keep all puzzle clues,O(SUDOKU_SIZE*SUDOKU_SIZE)
+bool check_solution( const puzzle_t& puzzle , const puzzle_t& solution ) noexcept( true );
+
 #if SUDOKU_SIZE != 9
     [[deprecated("not implemented")]]
 #endif
@@ -95,13 +299,16 @@ bool check_puzzle( const puzzle_t& puzzle ) noexcept( true );
 puzzle_t string_to_puzzle( std::string puzzle_string ) noexcept( true );
 
 std::string puzzle_to_string( const puzzle_t& puzzle ) noexcept( true );
-
-std::shared_future <puzzle_t> get_network_puzzle( SUDOKU_LEVEL level ) noexcept( false );
+//puzzle_to_string without the legality check,a board with conflicts( allow_conflict ) keep its digits
+std::string grid_to_string( const puzzle_t& puzzle ) noexcept( true );
 
 #if SUDOKU_SIZE != 9
     [[deprecated("not implemented")]]
 #endif
-puzzle_t get_local_puzzle( SUDOKU_LEVEL level ) noexcept( true );
+//representative of the equivalence class under transpose,band/stack and row/column in band permutation,
+//digit relabel:the lexicographic least form,digits relabelled in reading order.
+//equivalent puzzles give the same result,2*1296*1296 transforms with early abort
+puzzle_t canonicalize_puzzle( const puzzle_t& puzzle ) noexcept( true );
 
 std::string candidates_to_string( const candidate_t& candidates ) noexcept( true );
 
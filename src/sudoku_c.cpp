@@ -0,0 +1,281 @@
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "dancinglinks.h"
+#include "gridkernel.h"
+#include "solutioncache.h"
+#include "sudoku.h"
+#include "sudoku_c.h"
+
+static_assert( SUDOKU_PACKED_SIZE == PACKED_PUZZLE_SIZE , "sudoku_c.h packed size out of date" );
+static_assert( SUDOKU_CELL_NUMBER == SUDOKU_SIZE*SUDOKU_SIZE , "sudoku_c.h cell number out of date" );
+
+static std::size_t resolve_worker_number( std::size_t worker_number , std::size_t job_number )
+{
+    if ( worker_number == 0 )
+        worker_number = std::max( 1U , std::thread::hardware_concurrency() );
+    return std::max<std::size_t>( 1 , std::min( worker_number , job_number ) );
+}
+
+static puzzle_t read_puzzle( const std::uint8_t * puzzles , std::size_t index )
+{
+    packed_puzzle_t packed;
+    std::memcpy( packed.data() , puzzles + index*SUDOKU_PACKED_SIZE , SUDOKU_PACKED_SIZE );
+    return unpack_puzzle( packed );
+}
+
+static void write_puzzle( std::uint8_t * puzzles , std::size_t index , const puzzle_t& puzzle )
+{
+    packed_puzzle_t packed = pack_puzzle( puzzle );
+    std::memcpy( puzzles + index*SUDOKU_PACKED_SIZE , packed.data() , SUDOKU_PACKED_SIZE );
+}
+
+static SolveLimits make_limits( const sudoku_batch_options * options )
+{
+    SolveLimits limits;
+    if ( options == nullptr )
+        return limits;
+    limits.node_budget = options->node_budget;
+    return limits;
+}
+
+//unpack puzzles [ begin , end ) into structure of arrays,cells[k*( end - begin ) + p]
+static std::vector<cell_t> read_grid_block( const std::uint8_t * puzzles , std::size_t begin , std::size_t end )
+{
+    std::size_t count = end - begin;
+    std::vector<cell_t> cells( count*SUDOKU_CELL_NUMBER );
+    for ( std::size_t p = 0 ; p < count ; p++ )
+    {
+        const std::uint8_t * packed = puzzles + ( begin + p )*SUDOKU_PACKED_SIZE;
+        for ( std::size_t k = 0 ; k < SUDOKU_CELL_NUMBER ; k++ )
+        {
+            std::uint8_t byte = packed[k/2];
+            cells[k*count + p] = ( k%2 == 0 ) ? ( byte & 0x0F ) : ( byte >> 4 );
+        }
+    }
+    return cells;
+}
+
+//job( index ) for every index in [ 0 , count ),exceptions never cross the C boundary
+static int run_batch( std::size_t count , const sudoku_batch_options * options , std::function<void( std::size_t )> job )
+{
+    std::atomic<std::size_t> next_index( 0 );
+    std::mutex error_mutex;
+    std::exception_ptr error;
+    auto work = [ & ]()
+    {
+        while ( true )
+        {
+            std::size_t index = next_index++;
+            if ( index >= count )
+                break;
+            try
+            {
+                job( index );
+            }
+            catch( ... )
+            {
+                std::lock_guard<std::mutex> lock( error_mutex );
+                if ( error == nullptr )
+                    error = std::current_exception();
+                next_index = count;
+                break;
+            }
+        }
+    };
+
+    try
+    {
+        std::vector<std::thread> workers;
+        std::size_t thread_number = resolve_worker_number( ( options != nullptr ) ? options->worker_number : 0 , count );
+        try
+        {
+            for ( std::size_t i = 1 ; i < thread_number ; i++ )
+            {
+                workers.emplace_back( work );
+            }
+        }
+        catch( ... )
+        {
+            //fewer workers,same result
+        }
+        work();
+        for ( auto& worker : workers )
+        {
+            worker.join();
+        }
+    }
+    catch( ... )
+    {
+        return SUDOKU_C_ERROR_INTERNAL;
+    }
+    return ( error == nullptr ) ? SUDOKU_C_OK : SUDOKU_C_ERROR_INTERNAL;
+}
+
+//solutions of one puzzle under the batch limits,a fresh deadline every puzzle
+static std::uint8_t solve_one( const puzzle_t& puzzle , std::size_t solution_limit , const sudoku_batch_options * options ,
+                               std::vector<puzzle_t>& solutions )
+{
+    if ( check_puzzle( puzzle ) == false )
+        return SUDOKU_RESULT_ILLEGAL;
+    SolveLimits limits = make_limits( options );
+    if ( ( options != nullptr ) && ( options->timeout_ms != 0 ) )
+        limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( options->timeout_ms );
+    SolveStatus status = Sudoku( puzzle ).get_solution( solutions , solution_limit , limits );
+    if ( status != SolveStatus::COMPLETE )
+        return SUDOKU_RESULT_BUDGET_EXCEEDED;
+    return solutions.empty() ? SUDOKU_RESULT_NO_SOLUTION : SUDOKU_RESULT_OK;
+}
+
+//puzzles of one lockstep job in the solve/count batches
+constexpr std::size_t SOLVE_BATCH_BLOCK = 256;
+
+//timeout and node budget are per puzzle and per DancingLinks node,keep that search for them
+static bool use_lockstep( const sudoku_batch_options * options )
+{
+    return ( options == nullptr ) || ( ( options->timeout_ms == 0 ) && ( options->node_budget == 0 ) );
+}
+
+//puzzles [ begin , end ) in the lockstep lanes,results[p] for puzzle begin + p
+static void solve_block( const std::uint8_t * puzzles , std::size_t begin , std::size_t end , std::size_t solution_limit ,
+                         std::vector<BatchSolution>& results )
+{
+    std::vector<puzzle_t> block( end - begin );
+    for ( std::size_t p = 0 ; p < block.size() ; p++ )
+        block[p] = read_puzzle( puzzles , begin + p );
+    Sudoku::solve_batch( block , results , solution_limit , SolveLimits() , SolverEngine::LOCKSTEP );
+}
+
+//same result code as solve_one
+static std::uint8_t batch_result( const BatchSolution& solved )
+{
+    if ( solved.legal == false )
+        return SUDOKU_RESULT_ILLEGAL;
+    if ( solved.status != SolveStatus::COMPLETE )
+        return SUDOKU_RESULT_BUDGET_EXCEEDED;
+    return ( solved.solution_count == 0 ) ? SUDOKU_RESULT_NO_SOLUTION : SUDOKU_RESULT_OK;
+}
+
+extern "C" {
+
+uint32_t sudoku_abi_version( void )
+{
+    return SUDOKU_C_ABI_VERSION;
+}
+
+void sudoku_batch_options_init( sudoku_batch_options * options )
+{
+    if ( options != nullptr )
+        std::memset( options , 0 , sizeof( *options ) );
+}
+
+int sudoku_check_batch( const uint8_t * puzzles , size_t count , uint8_t * results , const sudoku_batch_options * options )
+{
+    if ( ( count > 0 ) && ( ( puzzles == nullptr ) || ( results == nullptr ) ) )
+        return SUDOKU_C_ERROR_ARGUMENT;
+    std::size_t block_number = ( count + GRID_BATCH_BLOCK - 1 )/GRID_BATCH_BLOCK;
+    return run_batch( block_number , options , [ = ]( std::size_t block )
+    {
+        std::size_t begin = block*GRID_BATCH_BLOCK;
+        std::size_t end = std::min( count , begin + GRID_BATCH_BLOCK );
+        std::vector<cell_t> cells = read_grid_block( puzzles , begin , end );
+        grid_scan_batch( cells.data() , end - begin , results + begin , nullptr );
+    } );
+}
+
+int sudoku_solve_batch( const uint8_t * puzzles , size_t count , uint8_t * solutions , uint8_t * results ,
+                        const sudoku_batch_options * options )
+{
+    if ( ( count > 0 ) && ( ( puzzles == nullptr ) || ( solutions == nullptr ) || ( results == nullptr ) ) )
+        return SUDOKU_C_ERROR_ARGUMENT;
+    if ( use_lockstep( options ) )
+    {
+        std::size_t block_number = ( count + SOLVE_BATCH_BLOCK - 1 )/SOLVE_BATCH_BLOCK;
+        return run_batch( block_number , options , [ = ]( std::size_t block )
+        {
+            std::size_t begin = block*SOLVE_BATCH_BLOCK;
+            std::vector<BatchSolution> solved;
+            solve_block( puzzles , begin , std::min( count , begin + SOLVE_BATCH_BLOCK ) , 1 , solved );
+            for ( std::size_t p = 0 ; p < solved.size() ; p++ )
+            {
+                results[begin + p] = batch_result( solved[p] );
+                write_puzzle( solutions , begin + p , ( results[begin + p] == SUDOKU_RESULT_OK ) ? solved[p].solution : puzzle_t() );
+            }
+        } );
+    }
+    return run_batch( count , options , [ = ]( std::size_t index )
+    {
+        std::vector<puzzle_t> found;
+        results[index] = solve_one( read_puzzle( puzzles , index ) , 1 , options , found );
+        write_puzzle( solutions , index , ( results[index] == SUDOKU_RESULT_OK ) ? found[0] : puzzle_t() );
+    } );
+}
+
+int sudoku_candidates_batch( const uint8_t * puzzles , size_t count , uint16_t * candidates , const sudoku_batch_options * options )
+{
+    if ( ( count > 0 ) && ( ( puzzles == nullptr ) || ( candidates == nullptr ) ) )
+        return SUDOKU_C_ERROR_ARGUMENT;
+    std::size_t block_number = ( count + GRID_BATCH_BLOCK - 1 )/GRID_BATCH_BLOCK;
+    return run_batch( block_number , options , [ = ]( std::size_t block )
+    {
+        std::size_t begin = block*GRID_BATCH_BLOCK;
+        std::size_t end = std::min( count , begin + GRID_BATCH_BLOCK );
+        std::size_t block_count = end - begin;
+        std::vector<cell_t> cells = read_grid_block( puzzles , begin , end );
+        std::vector<std::uint8_t> legal( block_count );
+        std::vector<candidate_mask_t> masks( block_count*SUDOKU_CELL_NUMBER );
+        grid_scan_batch( cells.data() , block_count , legal.data() , masks.data() );
+        //back to one puzzle after another
+        for ( std::size_t p = 0 ; p < block_count ; p++ )
+        {
+            uint16_t * target = candidates + ( begin + p )*SUDOKU_CELL_NUMBER;
+            for ( std::size_t k = 0 ; k < SUDOKU_CELL_NUMBER ; k++ )
+            {
+                target[k] = masks[k*block_count + p];
+            }
+        }
+    } );
+}
+
+int sudoku_count_batch( const uint8_t * puzzles , size_t count , uint32_t limit , uint32_t * counts , uint8_t * results ,
+                        const sudoku_batch_options * options )
+{
+    if ( ( count > 0 ) && ( ( puzzles == nullptr ) || ( counts == nullptr ) || ( results == nullptr ) ) )
+        return SUDOKU_C_ERROR_ARGUMENT;
+    if ( use_lockstep( options ) )
+    {
+        std::size_t block_number = ( count + SOLVE_BATCH_BLOCK - 1 )/SOLVE_BATCH_BLOCK;
+        return run_batch( block_number , options , [ = ]( std::size_t block )
+        {
+            std::size_t begin = block*SOLVE_BATCH_BLOCK;
+            std::vector<BatchSolution> solved;
+            solve_block( puzzles , begin , std::min( count , begin + SOLVE_BATCH_BLOCK ) , limit , solved );
+            for ( std::size_t p = 0 ; p < solved.size() ; p++ )
+            {
+                std::uint8_t result = batch_result( solved[p] );
+                counts[begin + p] = static_cast<uint32_t>( solved[p].solution_count );
+                results[begin + p] = ( result == SUDOKU_RESULT_NO_SOLUTION ) ? SUDOKU_RESULT_OK : result;
+            }
+        } );
+    }
+    return run_batch( count , options , [ = ]( std::size_t index )
+    {
+        std::vector<puzzle_t> found;
+        std::uint8_t result = solve_one( read_puzzle( puzzles , index ) , limit , options , found );
+        counts[index] = static_cast<uint32_t>( found.size() );
+        //zero solution is a count,not a failure
+        results[index] = ( result == SUDOKU_RESULT_NO_SOLUTION ) ? SUDOKU_RESULT_OK : result;
+    } );
+}
+
+}
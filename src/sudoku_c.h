@@ -0,0 +1,84 @@
+#ifndef SUDOKU_C_H
+#define SUDOKU_C_H
+
+/*
+* stable C interface of the engine( libsudoku.a/libsudoku.so ),no GUI,network or json dependency.
+* a puzzle is SUDOKU_PACKED_SIZE bytes:4 bit a cell,cell index row*9 + column,
+* even index in the low nibble of byte index/2,0 empty cell.
+* batch functions take count contiguous packed puzzles and run them on worker threads,
+* results are written at the index of their puzzle.
+* return SUDOKU_C_OK or a negative SUDOKU_C_ERROR_*,a failed call leave the outputs unspecified.
+*/
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined( __GNUC__ )
+    #define SUDOKU_C_API __attribute__( ( visibility( "default" ) ) )
+#else
+    #define SUDOKU_C_API
+#endif
+
+/* bumped on any incompatible change of this header */
+#define SUDOKU_C_ABI_VERSION 1
+
+#define SUDOKU_PACKED_SIZE 41
+#define SUDOKU_CELL_NUMBER 81
+
+/* per puzzle result */
+#define SUDOKU_RESULT_OK 0
+#define SUDOKU_RESULT_NO_SOLUTION 1
+/* clue repeat in a unit,cell value > 9 */
+#define SUDOKU_RESULT_ILLEGAL 2
+/* node budget or timeout reached before the answer */
+#define SUDOKU_RESULT_BUDGET_EXCEEDED 3
+
+/* call result */
+#define SUDOKU_C_OK 0
+/* null pointer with count > 0 */
+#define SUDOKU_C_ERROR_ARGUMENT -1
+/* allocation failure,thread creation failure */
+#define SUDOKU_C_ERROR_INTERNAL -2
+
+typedef struct sudoku_batch_options
+{
+    /* 0 hardware concurrency */
+    uint32_t worker_number;
+    /* search limit of one puzzle,0 unlimited */
+    uint32_t timeout_ms;
+    uint64_t node_budget;
+} sudoku_batch_options;
+
+/* SUDOKU_C_ABI_VERSION the library was built with */
+SUDOKU_C_API uint32_t sudoku_abi_version( void );
+
+/* defaults:every field 0 */
+SUDOKU_C_API void sudoku_batch_options_init( sudoku_batch_options * options );
+
+/* results[i]:1 legal,0 illegal( repeat clue,cell value > 9 ).no search */
+SUDOKU_C_API int sudoku_check_batch( const uint8_t * puzzles , size_t count , uint8_t * results ,
+                                     const sudoku_batch_options * options );
+
+/* solutions:count*SUDOKU_PACKED_SIZE bytes,the first solution found,all zero unless results[i] is SUDOKU_RESULT_OK.
+   options may be null.without timeout_ms and node_budget puzzles are searched 16 at a time( lockstep lanes ),
+   several times faster,the same results except which solution of a multi solution puzzle comes first */
+SUDOKU_C_API int sudoku_solve_batch( const uint8_t * puzzles , size_t count , uint8_t * solutions , uint8_t * results ,
+                                     const sudoku_batch_options * options );
+
+/* candidates:count*SUDOKU_CELL_NUMBER masks,digit k in bit k - 1,0 for a filled cell */
+SUDOKU_C_API int sudoku_candidates_batch( const uint8_t * puzzles , size_t count , uint16_t * candidates ,
+                                          const sudoku_batch_options * options );
+
+/* counts[i]:solution number,stop counting at limit( 0 unlimited ).2 is a uniqueness check.
+   results[i] SUDOKU_RESULT_BUDGET_EXCEEDED keep the partial count */
+SUDOKU_C_API int sudoku_count_batch( const uint8_t * puzzles , size_t count , uint32_t limit , uint32_t * counts ,
+                                     uint8_t * results , const sudoku_batch_options * options );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,517 @@
+//sudoku engine daemon:solve,count,generate,grade and canonicalize over a unix socket( protocol in solverproto.h ).
+//usage:sudokud [--socket PATH] [--threads N] [--cache N] [--budget MS]
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "dancinglinks.h"
+#include "puzzleimport.h"
+#include "solutioncache.h"
+#include "solverproto.h"
+#include "sudoku.h"
+
+//time budget of a request which don't give one
+constexpr std::uint32_t DEFAULT_BUDGET_MS = 2000;
+constexpr std::size_t DEFAULT_CACHE_CAPACITY = 1 << 16;
+//queued + running requests of one connection,the reader stop reading beyond it
+constexpr std::size_t MAX_IN_FLIGHT = 256;
+
+static int stop_pipe[2] = { -1 , -1 };
+
+static void on_stop_signal( int )
+{
+    char byte = 0;
+    //nothing to do if the pipe is full,a stop is already pending
+    ssize_t written = write( stop_pipe[1] , &byte , 1 );
+    ( void )written;
+}
+
+//fixed worker threads,a job queued before destruction still run
+class WorkerPool
+{
+    public:
+        explicit WorkerPool( std::size_t worker_number ):
+            stop( false )
+        {
+            for ( std::size_t i = 0 ; i < worker_number ; i++ )
+            {
+                this->workers.emplace_back( &WorkerPool::worker_loop , this );
+            }
+        }
+        WorkerPool( const WorkerPool& ) = delete;
+        WorkerPool& operator=( const WorkerPool& ) = delete;
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock( this->job_mutex );
+                this->stop = true;
+            }
+            this->job_condition.notify_all();
+            for ( auto& worker : this->workers )
+            {
+                worker.join();
+            }
+        }
+
+        void post( std::function<void()> job )
+        {
+            {
+                std::lock_guard<std::mutex> lock( this->job_mutex );
+                this->jobs.push_back( std::move( job ) );
+            }
+            this->job_condition.notify_one();
+        }
+    private:
+        void worker_loop( void )
+        {
+            while ( true )
+            {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock( this->job_mutex );
+                    this->job_condition.wait( lock , [ this ](){ return this->stop || ( this->jobs.empty() == false ); } );
+                    if ( this->jobs.empty() )
+                        return ;
+                    job = std::move( this->jobs.front() );
+                    this->jobs.pop_front();
+                }
+                job();
+            }
+        }
+
+        std::mutex job_mutex;
+        std::condition_variable job_condition;
+        std::deque< std::function<void()> > jobs;
+        bool stop;
+        std::vector<std::thread> workers;
+};
+
+//one client,shared by its reader thread and the jobs of its requests.fd closed with the last owner
+struct Connection
+{
+    explicit Connection( int fd ):
+        fd( fd ),
+        in_flight( 0 ),
+        closed( false )
+    {
+        ;
+    }
+    ~Connection()
+    {
+        close( this->fd );
+    }
+
+    int fd;
+    //responses of different workers never interleave
+    std::mutex write_mutex;
+    std::mutex flight_mutex;
+    std::condition_variable flight_condition;
+    std::size_t in_flight;
+    //peer gone or server stopping,running searches of the connection stop
+    std::atomic<bool> closed;
+};
+
+class SolverServer
+{
+    public:
+        SolverServer( std::size_t thread_number , std::size_t cache_capacity , std::uint32_t default_budget_ms ):
+            default_budget_ms( default_budget_ms ),
+            solutions( cache_capacity , "sudokud.solution_cache" ),
+            canonical_forms( cache_capacity , "sudokud.canonical_cache" ),
+            requests( 0 ),
+            pool( thread_number )
+        {
+            ;
+        }
+
+        //accept until stop_fd readable,then stop every connection and wait for them
+        void serve( int listen_fd , int stop_fd )
+        {
+            while ( true )
+            {
+                pollfd fds[2] = { { listen_fd , POLLIN , 0 } , { stop_fd , POLLIN , 0 } };
+                if ( poll( fds , 2 , -1 ) < 0 )
+                {
+                    if ( errno == EINTR )
+                        continue;
+                    std::fprintf( stderr , "sudokud:poll:%s\n" , std::strerror( errno ) );
+                    break;
+                }
+                if ( fds[1].revents != 0 )
+                    break;
+                if ( ( fds[0].revents & POLLIN ) == 0 )
+                    continue;
+                int fd = accept4( listen_fd , nullptr , nullptr , SOCK_CLOEXEC );
+                if ( fd < 0 )
+                {
+                    if ( ( errno != EINTR ) && ( errno != ECONNABORTED ) )
+                        std::fprintf( stderr , "sudokud:accept:%s\n" , std::strerror( errno ) );
+                    continue;
+                }
+                this->reap_sessions( false );
+                Session session;
+                session.connection = std::make_shared<Connection>( fd );
+                session.done = std::make_shared<std::atomic<bool>>( false );
+                session.reader = std::thread( &SolverServer::read_loop , this , session.connection , session.done );
+                this->sessions.push_back( std::move( session ) );
+            }
+            for ( auto& session : this->sessions )
+            {
+                session.connection->closed = true;
+                shutdown( session.connection->fd , SHUT_RDWR );
+            }
+            this->reap_sessions( true );
+        }
+    private:
+        struct Session
+        {
+            std::shared_ptr<Connection> connection;
+            std::shared_ptr<std::atomic<bool>> done;
+            std::thread reader;
+        };
+
+        void reap_sessions( bool all )
+        {
+            for ( auto session = this->sessions.begin() ; session != this->sessions.end() ; )
+            {
+                if ( all || session->done->load() )
+                {
+                    session->reader.join();
+                    session = this->sessions.erase( session );
+                }
+                else
+                    session++;
+            }
+        }
+
+        //requests are read ahead( pipelining ) and run in the pool,responses written in completion order
+        void read_loop( std::shared_ptr<Connection> connection , std::shared_ptr<std::atomic<bool>> done )
+        {
+            while ( connection->closed == false )
+            {
+                SolverRequest request;
+                try
+                {
+                    if ( read_request( connection->fd , request ) == false )
+                        break;
+                }
+                catch( const std::exception& e )
+                {
+                    if ( connection->closed == false )
+                        std::fprintf( stderr , "sudokud:%s\n" , e.what() );
+                    connection->closed = true;
+                    break;
+                }
+                {
+                    std::unique_lock<std::mutex> lock( connection->flight_mutex );
+                    connection->flight_condition.wait( lock ,
+                        [ &connection ](){ return ( connection->in_flight < MAX_IN_FLIGHT ) || connection->closed; } );
+                    connection->in_flight++;
+                }
+                this->pool.post(
+                    [ this , connection , request = std::move( request ) ]()
+                    {
+                        std::vector<std::uint8_t> frame = encode_response( this->handle( request , &connection->closed ) );
+                        if ( connection->closed == false )
+                        {
+                            std::lock_guard<std::mutex> lock( connection->write_mutex );
+                            try
+                            {
+                                write_frame( connection->fd , frame );
+                            }
+                            catch( const std::exception& )
+                            {
+                                //peer gone,stop its other searches
+                                connection->closed = true;
+                            }
+                        }
+                        {
+                            std::lock_guard<std::mutex> lock( connection->flight_mutex );
+                            connection->in_flight--;
+                        }
+                        connection->flight_condition.notify_all();
+                    }
+                );
+            }
+            //half closed peer still read the answers of its last requests
+            std::unique_lock<std::mutex> lock( connection->flight_mutex );
+            connection->flight_condition.wait( lock , [ &connection ](){ return connection->in_flight == 0; } );
+            *done = true;
+        }
+
+        SolverResponse handle( const SolverRequest& request , const std::atomic<bool> * stop )
+        {
+            auto begin = std::chrono::steady_clock::now();
+            this->requests++;
+            SolverResponse response = { request.id , request.op , SolverStatus::OK , 0 , {} };
+            std::uint32_t budget_ms = ( request.budget_ms != 0 ) ? request.budget_ms : this->default_budget_ms;
+            SolveLimits limits = SolveLimits::with_timeout( std::chrono::milliseconds( budget_ms ) , stop );
+
+            puzzle_t puzzle;
+            auto take_puzzle = [ &request , &response , &puzzle ]( std::size_t payload_size ) -> bool
+            {
+                if ( ( request.payload.size() != payload_size ) || ( take_packed( request.payload , 0 , puzzle ) == false ) )
+                {
+                    response.status = SolverStatus::BAD_REQUEST;
+                    return false;
+                }
+                if ( check_puzzle( puzzle ) == false )
+                {
+                    response.status = SolverStatus::ILLEGAL_PUZZLE;
+                    return false;
+                }
+                return true;
+            };
+            auto put_u32 = [ &response ]( std::uint32_t value )
+            {
+                const std::uint8_t * bytes = reinterpret_cast<const std::uint8_t *>( &value );
+                response.payload.insert( response.payload.end() , bytes , bytes + sizeof( value ) );
+            };
+            auto put_u64 = [ &response ]( std::uint64_t value )
+            {
+                const std::uint8_t * bytes = reinterpret_cast<const std::uint8_t *>( &value );
+                response.payload.insert( response.payload.end() , bytes , bytes + sizeof( value ) );
+            };
+
+            try
+            {
+                switch ( request.op )
+                {
+                    case SolverOp::SOLVE:
+                    {
+                        if ( take_puzzle( PACKED_PUZZLE_SIZE ) == false )
+                            break;
+                        puzzle_t solution;
+                        if ( this->solutions.solve( puzzle , solution , limits ) != SolveStatus::COMPLETE )
+                            response.status = SolverStatus::BUDGET_EXCEEDED;
+                        else if ( solution == puzzle_t() )
+                            response.status = SolverStatus::NO_SOLUTION;
+                        else
+                            append_packed( response.payload , solution );
+                        break;
+                    }
+                    case SolverOp::COUNT:
+                    {
+                        if ( take_puzzle( PACKED_PUZZLE_SIZE + sizeof( std::uint32_t ) ) == false )
+                            break;
+                        std::uint32_t limit;
+                        std::memcpy( &limit , request.payload.data() + PACKED_PUZZLE_SIZE , sizeof( limit ) );
+                        limit = std::clamp<std::uint32_t>( limit , 1 , SOLVER_MAX_COUNT );
+                        std::vector<puzzle_t> found;
+                        if ( Sudoku( puzzle ).get_solution( found , limit , limits ) != SolveStatus::COMPLETE )
+                            response.status = SolverStatus::BUDGET_EXCEEDED;
+                        else
+                            put_u32( found.size() );
+                        break;
+                    }
+                    case SolverOp::GENERATE:
+                    {
+                        if ( request.payload.empty() == false )
+                        {
+                            response.status = SolverStatus::BAD_REQUEST;
+                            break;
+                        }
+                        //out of budget keep the unique puzzle reached so far
+                        SolveStatus status;
+                        Sudoku game( limits , status );
+                        puzzle_t solution;
+                        if ( ( game.get_puzzle() == puzzle_t() ) ||
+                             ( this->solutions.solve( game.get_puzzle() , solution , SolveLimits() ) != SolveStatus::COMPLETE ) )
+                        {
+                            response.status = SolverStatus::BUDGET_EXCEEDED;
+                            break;
+                        }
+                        append_packed( response.payload , game.get_puzzle() );
+                        append_packed( response.payload , solution );
+                        response.payload.push_back( static_cast<std::uint8_t>( game.get_puzzle_level() ) );
+                        break;
+                    }
+                    case SolverOp::GRADE:
+                    {
+                        if ( take_puzzle( PACKED_PUZZLE_SIZE ) == false )
+                            break;
+                        response.payload.push_back( static_cast<std::uint8_t>( grade_puzzle( puzzle ) ) );
+                        break;
+                    }
+                    case SolverOp::CANONICALIZE:
+                    {
+                        if ( take_puzzle( PACKED_PUZZLE_SIZE ) == false )
+                            break;
+                        puzzle_t canonical;
+                        if ( this->canonical_forms.lookup( puzzle , canonical ) == false )
+                        {
+                            canonical = canonicalize_puzzle( puzzle );
+                            this->canonical_forms.insert( puzzle , canonical );
+                        }
+                        append_packed( response.payload , canonical );
+                        break;
+                    }
+                    case SolverOp::STATS:
+                    {
+                        put_u64( this->requests.load() );
+                        put_u64( this->solutions.get_hit_count() );
+                        put_u64( this->solutions.get_miss_count() );
+                        break;
+                    }
+                    default:
+                        response.status = SolverStatus::BAD_REQUEST;
+                        break;
+                }
+            }
+            catch( const std::exception& e )
+            {
+                std::fprintf( stderr , "sudokud:request %u:%s\n" , request.id , e.what() );
+                response.status = SolverStatus::BAD_REQUEST;
+                response.payload.clear();
+            }
+            if ( response.status != SolverStatus::OK )
+                response.payload.clear();
+            auto cost = std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - begin );
+            response.server_us = static_cast<std::uint32_t>( std::min<std::int64_t>( cost.count() , UINT32_MAX ) );
+            return response;
+        }
+
+        std::uint32_t default_budget_ms;
+        //warm across requests and connections
+        SolutionCache solutions;
+        //puzzle -> canonical form,same lru
+        SolutionCache canonical_forms;
+        std::atomic<std::uint64_t> requests;
+        std::list<Session> sessions;
+        //keep last member:destroyed first,jobs finish before the caches go
+        WorkerPool pool;
+};
+
+//bound listening socket,an existing socket file is replaced only when no daemon answer on it
+static int listen_socket( const std::string& path )
+{
+    std::string except_message( __func__ );
+    sockaddr_un address;
+    std::memset( &address , 0 , sizeof( address ) );
+    address.sun_family = AF_UNIX;
+    if ( path.size() >= sizeof( address.sun_path ) )
+    {
+        except_message += ":socket path '" + path + "' too long";
+        throw std::runtime_error( except_message );
+    }
+    std::memcpy( address.sun_path , path.c_str() , path.size() + 1 );
+
+    bool running = false;
+    try
+    {
+        close( connect_solver( path ) );
+        running = true;
+    }
+    catch( const std::runtime_error& )
+    {
+        //stale socket file of a dead daemon
+        ;
+    }
+    if ( running )
+    {
+        except_message += ":a daemon already listen on '" + path + "'";
+        throw std::runtime_error( except_message );
+    }
+    unlink( path.c_str() );
+
+    int fd = socket( AF_UNIX , SOCK_STREAM | SOCK_CLOEXEC , 0 );
+    if ( fd < 0 )
+    {
+        except_message += std::string( ":socket:" ) + std::strerror( errno );
+        throw std::runtime_error( except_message );
+    }
+    //owner only
+    mode_t old_mask = umask( 0077 );
+    int bound = bind( fd , reinterpret_cast<sockaddr *>( &address ) , sizeof( address ) );
+    umask( old_mask );
+    if ( ( bound != 0 ) || ( listen( fd , SOMAXCONN ) != 0 ) )
+    {
+        except_message += ":bind/listen '" + path + "':" + std::strerror( errno );
+        close( fd );
+        throw std::runtime_error( except_message );
+    }
+    return fd;
+}
+
+int main( int argc , char * argv[] )
+{
+    std::string socket_path( default_solver_socket() );
+    std::size_t thread_number = std::max( 1U , std::thread::hardware_concurrency() );
+    std::size_t cache_capacity = DEFAULT_CACHE_CAPACITY;
+    std::uint32_t budget_ms = DEFAULT_BUDGET_MS;
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        bool has_value = ( i + 1 < argc );
+        if ( ( option == "--socket" ) && has_value )
+            socket_path = argv[++i];
+        else if ( ( option == "--threads" ) && has_value )
+            thread_number = std::max<std::size_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else if ( ( option == "--cache" ) && has_value )
+            cache_capacity = std::max<std::size_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else if ( ( option == "--budget" ) && has_value )
+            budget_ms = std::max<std::uint32_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else
+        {
+            std::fprintf( stderr , "usage:%s [--socket PATH] [--threads N] [--cache N] [--budget MS]\n" , argv[0] );
+            return 1;
+        }
+    }
+
+    if ( pipe2( stop_pipe , O_CLOEXEC | O_NONBLOCK ) != 0 )
+    {
+        std::fprintf( stderr , "sudokud:pipe:%s\n" , std::strerror( errno ) );
+        return 1;
+    }
+    struct sigaction action;
+    std::memset( &action , 0 , sizeof( action ) );
+    action.sa_handler = on_stop_signal;
+    sigaction( SIGINT , &action , nullptr );
+    sigaction( SIGTERM , &action , nullptr );
+    signal( SIGPIPE , SIG_IGN );
+
+    int listen_fd = -1;
+    try
+    {
+        listen_fd = listen_socket( socket_path );
+    }
+    catch( const std::exception& e )
+    {
+        std::fprintf( stderr , "sudokud:%s\n" , e.what() );
+        return 1;
+    }
+    std::fprintf( stderr , "sudokud:listening on '%s',%zu threads,cache %zu\n" , socket_path.c_str() , thread_number , cache_capacity );
+    {
+        SolverServer server( thread_number , cache_capacity , budget_ms );
+        server.serve( listen_fd , stop_pipe[0] );
+    }
+    close( listen_fd );
+    unlink( socket_path.c_str() );
+    std::fprintf( stderr , "sudokud:stopped\n" );
+    return 0;
+}
@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cmath>
+
+#include "metrics.h"
+#include "taskexecutor.h"
+#include "trace.h"
+
+//shared by every executor,the hud show the process total
+static MetricGauge& queued_gauge( void )
+{
+    static MetricGauge& gauge = metrics().gauge( "executor.queued" );
+    return gauge;
+}
+
+static MetricGauge& running_gauge( void )
+{
+    static MetricGauge& gauge = metrics().gauge( "executor.running" );
+    return gauge;
+}
+
+void TaskContext::report_progress( double fraction )
+{
+    if ( !this->on_progress )
+        return ;
+    //only deliver 1% steps
+    double last = this->state->progress.load( std::memory_order_relaxed );
+    if ( ( last >= 0.0 ) && ( std::fabs( fraction - last ) < 0.01 ) && ( fraction < 1.0 ) )
+        return ;
+    this->state->progress.store( fraction , std::memory_order_relaxed );
+
+    auto state = this->state;
+    auto on_progress = this->on_progress;
+    this->executor.post( [ state , on_progress , fraction ]()
+    {
+        if ( state->cancelled == false )
+            on_progress( fraction );
+    } );
+}
+
+TaskExecutor::TaskExecutor( std::size_t worker_number ) noexcept( false ):
+    running_jobs( 0 ),
+    stop( false )
+{
+    if ( worker_number == 0 )
+    {
+        //keep at least two workers,a blocking network wait must not starve cpu jobs
+        worker_number = std::max( 2U , std::thread::hardware_concurrency() );
+    }
+    this->dispatcher.connect( sigc::mem_fun( *this , &TaskExecutor::dispatch ) );
+    for ( std::size_t i = 0 ; i < worker_number ; i++ )
+    {
+        this->workers.emplace_back( &TaskExecutor::worker_loop , this );
+    }
+}
+
+TaskExecutor::~TaskExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock( this->job_mutex );
+        this->stop = true;
+        queued_gauge().sub( this->jobs.size() );
+        this->jobs.clear();
+        for ( auto& weak_state : this->states )
+        {
+            auto state = weak_state.lock();
+            if ( state )
+                state->cancelled = true;
+        }
+    }
+    this->job_condition.notify_all();
+    for ( auto& worker : this->workers )
+    {
+        if ( worker.joinable() )
+            worker.join();
+    }
+}
+
+std::size_t TaskExecutor::get_pending_count( void ) const noexcept( true )
+{
+    std::lock_guard<std::mutex> lock( this->job_mutex );
+    return this->jobs.size() + this->running_jobs;
+}
+
+void TaskExecutor::post( std::function<void()> completion )
+{
+    {
+        std::lock_guard<std::mutex> lock( this->completion_mutex );
+        this->completions.push_back( std::move( completion ) );
+    }
+    this->dispatcher.emit();
+}
+
+void TaskExecutor::enqueue( const std::shared_ptr<TaskState>& state , std::function<void()> job )
+{
+    {
+        std::lock_guard<std::mutex> lock( this->job_mutex );
+        this->states.erase( std::remove_if( this->states.begin() , this->states.end() ,
+                                [](const std::weak_ptr<TaskState>& weak_state ){ return weak_state.expired(); } ) ,
+                            this->states.end() );
+        this->states.push_back( state );
+        this->jobs.push_back( std::move( job ) );
+        queued_gauge().add();
+    }
+    this->job_condition.notify_one();
+}
+
+void TaskExecutor::worker_loop( void )
+{
+    SUDOKU_TRACE_THREAD( "task worker" );
+    std::unique_lock<std::mutex> lock( this->job_mutex );
+    while ( true )
+    {
+        this->job_condition.wait( lock , [ this ](){ return this->stop || ( this->jobs.empty() == false ); } );
+        if ( this->stop )
+            break;
+        std::function<void()> job( std::move( this->jobs.front() ) );
+        this->jobs.pop_front();
+        queued_gauge().sub();
+        this->running_jobs++;
+        lock.unlock();
+
+        {
+            SUDOKU_TRACE_SCOPE( "TaskExecutor::job" );
+            MetricGaugeScope running( running_gauge() );
+            job();
+        }
+
+        lock.lock();
+        this->running_jobs--;
+    }
+}
+
+void TaskExecutor::dispatch( void )
+{
+    //completion may post new completion,swap out first
+    std::deque< std::function<void()> > ready;
+    {
+        std::lock_guard<std::mutex> lock( this->completion_mutex );
+        ready.swap( this->completions );
+    }
+    for ( auto& completion : ready )
+    {
+        completion();
+    }
+}
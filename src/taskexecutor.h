@@ -0,0 +1,162 @@
+#pragma once
+#ifndef TASKEXECUTOR_H
+#define TASKEXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glibmm/dispatcher.h>
+
+class TaskExecutor;
+
+//per task shared state,worker and gtk thread both hold it
+class TaskState
+{
+    public:
+        TaskState():
+            cancelled( false ),
+            progress( -1.0 )
+        {
+            ;
+        }
+
+        std::atomic<bool> cancelled;
+        //last reported progress,avoid flooding dispatcher
+        std::atomic<double> progress;
+};
+
+//passed to task function,only usable in the worker
+class TaskContext
+{
+    public:
+        TaskContext( TaskExecutor& executor , std::shared_ptr<TaskState> state , std::function<void( double )> on_progress ):
+            executor( executor ),
+            state( std::move( state ) ),
+            on_progress( std::move( on_progress ) )
+        {
+            ;
+        }
+
+        bool is_cancelled( void ) const noexcept( true )
+        {
+            return this->state->cancelled.load( std::memory_order_relaxed );
+        }
+
+        //cheap cancel check for long loop
+        const std::atomic<bool> * get_cancel_flag( void ) const noexcept( true )
+        {
+            return &( this->state->cancelled );
+        }
+
+        //fraction [ 0.0 , 1.0 ],delivered on gtk thread
+        void report_progress( double fraction );
+    private:
+        TaskExecutor& executor;
+        std::shared_ptr<TaskState> state;
+        std::function<void( double )> on_progress;
+};
+
+class TaskHandle
+{
+    public:
+        TaskHandle() = default;
+        explicit TaskHandle( std::shared_ptr<TaskState> state ):
+            state( std::move( state ) )
+        {
+            ;
+        }
+
+        //completion of a cancelled task is never delivered
+        void cancel( void ) noexcept( true )
+        {
+            if ( this->state )
+                this->state->cancelled = true;
+        }
+
+        bool is_cancelled( void ) const noexcept( true )
+        {
+            return this->state && this->state->cancelled;
+        }
+    private:
+        std::shared_ptr<TaskState> state;
+};
+
+//worker pool for cpu/blocking jobs,completion and progress run on the thread which construct the executor( gtk thread )
+class TaskExecutor
+{
+    public:
+        TaskExecutor( std::size_t worker_number = 0 ) noexcept( false );
+        TaskExecutor( const TaskExecutor& ) = delete;
+        TaskExecutor& operator=( const TaskExecutor& ) = delete;
+        ~TaskExecutor();
+
+        //work run in worker,on_done/on_error/on_progress run in gtk thread
+        template < typename Result >
+        TaskHandle submit( std::function<Result( TaskContext& )> work ,
+                           std::function<void( Result& )> on_done ,
+                           std::function<void( std::exception_ptr )> on_error = nullptr ,
+                           std::function<void( double )> on_progress = nullptr )
+        {
+            auto state = std::make_shared<TaskState>();
+            this->enqueue( state ,
+                [ this , state , work = std::move( work ) , on_done = std::move( on_done ) ,
+                  on_error = std::move( on_error ) , on_progress = std::move( on_progress ) ]()
+                {
+                    if ( state->cancelled )
+                        return ;
+                    TaskContext context( *this , state , on_progress );
+                    try
+                    {
+                        auto result = std::make_shared<Result>( work( context ) );
+                        this->post( [ state , result , on_done ]()
+                        {
+                            if ( ( state->cancelled == false ) && on_done )
+                                on_done( *result );
+                        } );
+                    }
+                    catch( ... )
+                    {
+                        std::exception_ptr error = std::current_exception();
+                        this->post( [ state , error , on_error ]()
+                        {
+                            if ( ( state->cancelled == false ) && on_error )
+                                on_error( error );
+                        } );
+                    }
+                }
+            );
+            return TaskHandle( state );
+        }
+
+        //queued + running jobs
+        std::size_t get_pending_count( void ) const noexcept( true );
+
+        //run completion on gtk thread,callable from any thread
+        void post( std::function<void()> completion );
+    private:
+        void enqueue( const std::shared_ptr<TaskState>& state , std::function<void()> job );
+        void worker_loop( void );
+        void dispatch( void );
+
+        mutable std::mutex job_mutex;
+        std::condition_variable job_condition;
+        std::deque< std::function<void()> > jobs;
+        std::size_t running_jobs;
+        bool stop;
+        //cancel all unfinished task on destruction
+        std::vector< std::weak_ptr<TaskState> > states;
+        std::vector<std::thread> workers;
+
+        std::mutex completion_mutex;
+        std::deque< std::function<void()> > completions;
+        Glib::Dispatcher dispatcher;
+};
+
+#endif
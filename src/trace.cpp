@@ -0,0 +1,190 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "trace.h"
+
+static std::uint64_t now_ns( void )
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+#ifdef SUDOKU_TRACING
+
+struct TraceEvent
+{
+    const char * name;
+    std::uint64_t begin_ns;
+    std::uint64_t end_ns;
+};
+
+//single writer( the owner thread ),readers see events below the released size
+struct TraceBuffer
+{
+    std::uint32_t thread_id;
+    std::atomic<const char *> thread_name{ nullptr };
+    std::atomic<std::size_t> size{ 0 };
+    std::atomic<std::uint64_t> dropped{ 0 };
+    std::array<TraceEvent , TRACE_BUFFER_EVENTS> events;
+};
+
+//owns every buffer,a buffer outlive its thread so late flushes still see it
+static class TraceRegistry
+{
+    public:
+        TraceRegistry():
+            epoch_ns( now_ns() )
+        {
+            ;
+        }
+        ~TraceRegistry()
+        {
+            trace_flush( trace_default_path() );
+        }
+
+        TraceBuffer * create_buffer( void )
+        {
+            std::unique_ptr<TraceBuffer> buffer( new TraceBuffer() );
+            std::lock_guard<std::mutex> lock( this->mutex );
+            buffer->thread_id = this->buffers.size() + 1;
+            this->buffers.push_back( std::move( buffer ) );
+            return this->buffers.back().get();
+        }
+
+        bool write( const std::string& path )
+        {
+            std::FILE * file = std::fopen( path.c_str() , "w" );
+            if ( file == nullptr )
+                return false;
+            long pid = static_cast<long>( getpid() );
+            std::fprintf( file , "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+            bool first = true;
+            auto separator = [ &first , file ]()
+            {
+                if ( first == false )
+                    std::fprintf( file , ",\n" );
+                first = false;
+            };
+            std::lock_guard<std::mutex> lock( this->mutex );
+            for ( const auto& buffer : this->buffers )
+            {
+                const char * thread_name = buffer->thread_name.load( std::memory_order_acquire );
+                if ( thread_name != nullptr )
+                {
+                    separator();
+                    std::fprintf( file , "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%u,\"args\":{\"name\":\"%s\"}}" ,
+                                  pid , buffer->thread_id , thread_name );
+                }
+                std::size_t size = buffer->size.load( std::memory_order_acquire );
+                for ( std::size_t i = 0 ; i < size ; i++ )
+                {
+                    const TraceEvent& event = buffer->events[i];
+                    separator();
+                    std::fprintf( file , "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%ld,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}" ,
+                                  event.name , pid , buffer->thread_id ,
+                                  ( event.begin_ns - this->epoch_ns )/1000.0 , ( event.end_ns - event.begin_ns )/1000.0 );
+                }
+                std::uint64_t dropped = buffer->dropped.load( std::memory_order_relaxed );
+                if ( dropped != 0 )
+                {
+                    separator();
+                    std::fprintf( file , "{\"name\":\"dropped spans\",\"ph\":\"C\",\"pid\":%ld,\"tid\":%u,\"ts\":0,\"args\":{\"dropped\":%llu}}" ,
+                                  pid , buffer->thread_id , static_cast<unsigned long long>( dropped ) );
+                }
+            }
+            std::fprintf( file , "\n]}\n" );
+            return std::fclose( file ) == 0;
+        }
+    private:
+        std::uint64_t epoch_ns;
+        std::mutex mutex;
+        std::vector< std::unique_ptr<TraceBuffer> > buffers;
+}trace_registry;
+
+static TraceBuffer * thread_buffer( void )
+{
+    thread_local TraceBuffer * buffer = trace_registry.create_buffer();
+    return buffer;
+}
+
+TraceScope::TraceScope( const char * name ) noexcept( true ):
+    name( name ),
+    begin_ns( now_ns() )
+{
+    ;
+}
+
+TraceScope::~TraceScope()
+{
+    std::uint64_t end_ns = now_ns();
+    TraceBuffer * buffer = thread_buffer();
+    std::size_t size = buffer->size.load( std::memory_order_relaxed );
+    if ( size >= buffer->events.size() )
+    {
+        buffer->dropped.fetch_add( 1 , std::memory_order_relaxed );
+        return ;
+    }
+    buffer->events[size] = { this->name , this->begin_ns , end_ns };
+    buffer->size.store( size + 1 , std::memory_order_release );
+}
+
+void trace_thread_name( const char * name ) noexcept( true )
+{
+    thread_buffer()->thread_name.store( name , std::memory_order_release );
+}
+
+bool trace_flush( const std::string& path ) noexcept( true )
+{
+    try
+    {
+        return trace_registry.write( path );
+    }
+    catch( ... )
+    {
+        return false;
+    }
+}
+
+#else
+
+TraceScope::TraceScope( const char * name ) noexcept( true ):
+    name( name ),
+    begin_ns( now_ns() )
+{
+    ;
+}
+
+TraceScope::~TraceScope()
+{
+    ;
+}
+
+void trace_thread_name( const char * ) noexcept( true )
+{
+    ;
+}
+
+bool trace_flush( const std::string& ) noexcept( true )
+{
+    return false;
+}
+
+#endif
+
+std::string trace_default_path( void ) noexcept( true )
+{
+    const char * path = std::getenv( "SUDOKU_TRACE_FILE" );
+    if ( ( path != nullptr ) && ( path[0] != '\0' ) )
+        return path;
+    return "sudoku-trace.json";
+}
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+
+#include <string>
+
+/*
+* scoped trace spans,compiled in only with -DSUDOKU_TRACING( make TRACE=1 ).
+*   SUDOKU_TRACE_SCOPE( "name" );   span from here to the end of the enclosing block
+* name must be a string literal( stored by pointer ).spans go to a per-thread buffer without lock,
+* a full buffer drop new spans.on exit every buffer is written as Chrome trace-event json
+* to $SUDOKU_TRACE_FILE( default sudoku-trace.json ),open it in chrome://tracing or ui.perfetto.dev
+*/
+
+//spans kept per thread before dropping
+constexpr std::size_t TRACE_BUFFER_EVENTS = 1 << 16;
+
+class TraceScope
+{
+    public:
+        explicit TraceScope( const char * name ) noexcept( true );
+        ~TraceScope();
+        TraceScope( const TraceScope& ) = delete;
+        TraceScope& operator=( const TraceScope& ) = delete;
+    private:
+        const char * name;
+        std::uint64_t begin_ns;
+};
+
+//name shown for the calling thread( string literal )
+void trace_thread_name( const char * name ) noexcept( true );
+
+//every span recorded so far as trace-event json,buffers keep their spans.
+//false when tracing is compiled out or the file can't be written
+bool trace_flush( const std::string& path ) noexcept( true );
+
+//$SUDOKU_TRACE_FILE or sudoku-trace.json
+std::string trace_default_path( void ) noexcept( true );
+
+#define SUDOKU_TRACE_CONCAT_( a , b ) a##b
+#define SUDOKU_TRACE_CONCAT( a , b ) SUDOKU_TRACE_CONCAT_( a , b )
+
+#ifdef SUDOKU_TRACING
+    #define SUDOKU_TRACE_SCOPE( name ) TraceScope SUDOKU_TRACE_CONCAT( trace_scope_ , __LINE__ )( name )
+    #define SUDOKU_TRACE_THREAD( name ) trace_thread_name( name )
+#else
+    #define SUDOKU_TRACE_SCOPE( name ) do {} while ( false )
+    #define SUDOKU_TRACE_THREAD( name ) do {} while ( false )
+#endif
+
+#endif
@@ -0,0 +1,521 @@
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dancinglinks.h"
+#include "sudoku.h"
+#include "variant.h"
+
+static constexpr std::size_t CELL_NUMBER = SUDOKU_SIZE*SUDOKU_SIZE;
+static constexpr std::uint16_t ALL_DIGITS = ( 1U << SUDOKU_SIZE ) - 1;
+static constexpr std::uint32_t MAX_CAGE_SUM = SUDOKU_SIZE*( SUDOKU_SIZE + 1 )/2;
+static constexpr std::uint64_t DEADLINE_CHECK_NODES = 1024;
+
+static std::size_t count_digits( std::uint16_t mask )
+{
+    return static_cast<std::size_t>( __builtin_popcount( mask ) );
+}
+
+//lowest digit of a non zero mask
+static cell_t lowest_digit( std::uint16_t mask )
+{
+    return static_cast<cell_t>( __builtin_ctz( mask ) + 1 );
+}
+
+//rows and columns
+static VariantSpec line_spec( void )
+{
+    VariantSpec spec;
+    for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        std::vector<cell_index_t> row , column;
+        for ( std::size_t k = 0 ; k < SUDOKU_SIZE ; k++ )
+        {
+            row.push_back( i*SUDOKU_SIZE + k );
+            column.push_back( k*SUDOKU_SIZE + i );
+        }
+        spec.units.push_back( row );
+        spec.units.push_back( column );
+    }
+    return spec;
+}
+
+VariantSpec classic_spec( void ) noexcept( true )
+{
+    VariantSpec spec = line_spec();
+    for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        std::vector<cell_index_t> box;
+        for ( std::size_t k = 0 ; k < SUDOKU_SIZE ; k++ )
+        {
+            std::size_t x = ( i/SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + k/SUDOKU_BOX_SIZE;
+            std::size_t y = ( i%SUDOKU_BOX_SIZE )*SUDOKU_BOX_SIZE + k%SUDOKU_BOX_SIZE;
+            box.push_back( x*SUDOKU_SIZE + y );
+        }
+        spec.units.push_back( box );
+    }
+    return spec;
+}
+
+VariantSpec jigsaw_spec( const std::string& regions ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    if ( regions.size() != CELL_NUMBER )
+    {
+        except_message += ":region map need " + std::to_string( CELL_NUMBER ) + " characters";
+        throw std::invalid_argument( except_message );
+    }
+    VariantSpec spec = line_spec();
+    std::array< std::vector<cell_index_t> , SUDOKU_SIZE > region_cells;
+    for ( std::size_t index = 0 ; index < CELL_NUMBER ; index++ )
+    {
+        char region = regions[index];
+        if ( ( region < '1' ) || ( region > '0' + SUDOKU_SIZE ) )
+        {
+            except_message += ":bad region '" + std::string( 1 , region ) + "' at " + std::to_string( index );
+            throw std::invalid_argument( except_message );
+        }
+        region_cells[region - '1'].push_back( index );
+    }
+    for ( const auto& cells : region_cells )
+    {
+        if ( cells.size() != SUDOKU_SIZE )
+        {
+            except_message += ":every region need " + std::to_string( SUDOKU_SIZE ) + " cells";
+            throw std::invalid_argument( except_message );
+        }
+        spec.units.push_back( cells );
+    }
+    return spec;
+}
+
+void add_diagonals( VariantSpec& spec ) noexcept( false )
+{
+    std::vector<cell_index_t> main , anti;
+    for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        main.push_back( i*SUDOKU_SIZE + i );
+        anti.push_back( i*SUDOKU_SIZE + SUDOKU_SIZE - 1 - i );
+    }
+    spec.units.push_back( main );
+    spec.units.push_back( anti );
+}
+
+void add_anti_knight( VariantSpec& spec ) noexcept( false )
+{
+    static constexpr int moves[][2] = { { 1 , 2 } , { 2 , 1 } , { 2 , -1 } , { 1 , -2 } };
+    for ( int x = 0 ; x < SUDOKU_SIZE ; x++ )
+    {
+        for ( int y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            //forward moves only,every pair once
+            for ( const auto& move : moves )
+            {
+                int to_x = x + move[0];
+                int to_y = y + move[1];
+                if ( ( to_x < SUDOKU_SIZE ) && ( to_y >= 0 ) && ( to_y < SUDOKU_SIZE ) )
+                    spec.different_pairs.emplace_back( x*SUDOKU_SIZE + y , to_x*SUDOKU_SIZE + to_y );
+            }
+        }
+    }
+}
+
+const std::vector<std::uint16_t>& cage_combinations( std::size_t size , std::uint32_t sum ) noexcept( true )
+{
+    typedef std::array< std::array< std::vector<std::uint16_t> , MAX_CAGE_SUM + 1 > , SUDOKU_SIZE + 1 > table_t;
+    static const table_t table = []()
+    {
+        table_t result;
+        for ( std::uint16_t mask = 1 ; mask <= ALL_DIGITS ; mask++ )
+        {
+            std::uint32_t mask_sum = 0;
+            for ( std::uint32_t digit = 1 ; digit <= SUDOKU_SIZE ; digit++ )
+            {
+                if ( mask & ( 1U << ( digit - 1 ) ) )
+                    mask_sum += digit;
+            }
+            result[count_digits( mask )][mask_sum].push_back( mask );
+        }
+        return result;
+    }();
+    static const std::vector<std::uint16_t> none;
+    if ( ( size > SUDOKU_SIZE ) || ( sum > MAX_CAGE_SUM ) )
+        return none;
+    return table[size][sum];
+}
+
+//cells of a unit or cage,throw invalid_argument on a bad cell
+static void check_cells( const std::vector<cell_index_t>& cells , const char * kind , std::string except_message )
+{
+    std::bitset<CELL_NUMBER> seen;
+    for ( cell_index_t cell : cells )
+    {
+        if ( cell >= CELL_NUMBER )
+        {
+            except_message += std::string( ":" ) + kind + " cell " + std::to_string( cell ) + " out of the board";
+            throw std::invalid_argument( except_message );
+        }
+        if ( seen.test( cell ) )
+        {
+            except_message += std::string( ":" ) + kind + " repeat cell " + std::to_string( cell );
+            throw std::invalid_argument( except_message );
+        }
+        seen.set( cell );
+    }
+}
+
+VariantModel::VariantModel( const VariantSpec& spec ) noexcept( false )
+{
+    std::string except_message( __func__ );
+    std::array< std::bitset<CELL_NUMBER> , CELL_NUMBER > peer_sets;
+    auto link_all = [ &peer_sets ]( const std::vector<cell_index_t>& cells )
+    {
+        for ( cell_index_t lhs : cells )
+        {
+            for ( cell_index_t rhs : cells )
+            {
+                if ( lhs != rhs )
+                    peer_sets[lhs].set( rhs );
+            }
+        }
+    };
+
+    for ( const auto& unit : spec.units )
+    {
+        check_cells( unit , "unit" , except_message );
+        if ( unit.size() > SUDOKU_SIZE )
+        {
+            except_message += ":unit of " + std::to_string( unit.size() ) + " cells";
+            throw std::invalid_argument( except_message );
+        }
+        link_all( unit );
+        if ( unit.size() == SUDOKU_SIZE )
+        {
+            std::array< cell_index_t , SUDOKU_SIZE > full_unit;
+            std::copy( unit.begin() , unit.end() , full_unit.begin() );
+            this->full_units.push_back( full_unit );
+        }
+    }
+    for ( const auto& cage : spec.cages )
+    {
+        check_cells( cage.cells , "cage" , except_message );
+        const std::vector<std::uint16_t>& combinations = cage_combinations( cage.cells.size() , cage.sum );
+        if ( combinations.empty() )
+        {
+            except_message += ":no " + std::to_string( cage.cells.size() ) + " distinct digits add up to " + std::to_string( cage.sum );
+            throw std::invalid_argument( except_message );
+        }
+        link_all( cage.cells );
+        this->cages.push_back( { cage.cells , &combinations } );
+    }
+    for ( const auto& pair : spec.different_pairs )
+    {
+        check_cells( { pair.first , pair.second } , "pair" , except_message );
+        peer_sets[pair.first].set( pair.second );
+        peer_sets[pair.second].set( pair.first );
+    }
+    for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+    {
+        for ( std::size_t peer = 0 ; peer < CELL_NUMBER ; peer++ )
+        {
+            if ( peer_sets[cell].test( peer ) )
+                this->peers[cell].push_back( peer );
+        }
+    }
+}
+
+bool VariantModel::check_clues( const puzzle_t& clues ) const noexcept( true )
+{
+    std::array<std::uint16_t , CELL_NUMBER> placed = { 0 };
+    for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+    {
+        cell_t value = clues[cell/SUDOKU_SIZE][cell%SUDOKU_SIZE];
+        if ( value > SUDOKU_SIZE )
+            return false;
+        if ( value == 0 )
+            continue;
+        for ( cell_index_t peer : this->peers[cell] )
+        {
+            if ( clues[peer/SUDOKU_SIZE][peer%SUDOKU_SIZE] == value )
+                return false;
+        }
+        placed[cell] = 1U << ( value - 1 );
+    }
+    //a complete cage must hit its sum,a partial one must still fit a combination
+    for ( const auto& cage : this->cages )
+    {
+        std::uint16_t cage_placed = 0;
+        for ( cell_index_t cell : cage.cells )
+        {
+            cage_placed |= placed[cell];
+        }
+        bool fit = std::any_of( cage.combinations->begin() , cage.combinations->end() , [ cage_placed ]( std::uint16_t combination )
+        {
+            return ( combination & cage_placed ) == cage_placed;
+        } );
+        if ( fit == false )
+            return false;
+    }
+    return true;
+}
+
+bool VariantModel::check_solution( const puzzle_t& clues , const puzzle_t& solution ) const noexcept( true )
+{
+    for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+    {
+        cell_t value = solution[cell/SUDOKU_SIZE][cell%SUDOKU_SIZE];
+        cell_t clue = clues[cell/SUDOKU_SIZE][cell%SUDOKU_SIZE];
+        if ( ( value == 0 ) || ( ( clue != 0 ) && ( clue != value ) ) )
+            return false;
+    }
+    return this->check_clues( solution );
+}
+
+//one bitmask search over a model,digit k of a cell in bit k - 1
+class VariantSearch
+{
+    public:
+        VariantSearch( const VariantModel& model , std::vector<puzzle_t>& solutions , std::size_t solution_limit , const SolveLimits& limits ) :
+            model( model ) , solutions( solutions ) , solution_limit( solution_limit ) , limits( limits )
+        {
+            this->found = 0;
+            this->node_count = 0;
+            this->status = SolveStatus::COMPLETE;
+        }
+
+        void run( const puzzle_t& clues )
+        {
+            Board board;
+            board.values.fill( 0 );
+            board.masks.fill( ALL_DIGITS );
+            board.filled = 0;
+            for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+            {
+                cell_t value = clues[cell/SUDOKU_SIZE][cell%SUDOKU_SIZE];
+                if ( ( value != 0 ) && ( this->place( board , cell , value ) == false ) )
+                    return ;
+            }
+            this->search( board );
+        }
+
+        SolveStatus get_status( void ) const
+        {
+            return this->status;
+        }
+
+        std::uint64_t get_node_count( void ) const
+        {
+            return this->node_count;
+        }
+    private:
+        struct Board
+        {
+            std::array<cell_t , CELL_NUMBER> values;
+            std::array<std::uint16_t , CELL_NUMBER> masks;
+            std::size_t filled;
+        };
+
+        //false:the digit contradict a rule
+        bool place( Board& board , std::size_t cell , cell_t digit )
+        {
+            std::uint16_t bit = 1U << ( digit - 1 );
+            if ( ( board.values[cell] != 0 ) || ( ( board.masks[cell] & bit ) == 0 ) )
+                return false;
+            board.values[cell] = digit;
+            board.masks[cell] = bit;
+            board.filled++;
+            for ( cell_index_t peer : this->model.peers[cell] )
+            {
+                if ( ( board.masks[peer] & bit ) == 0 )
+                    continue;
+                board.masks[peer] &= ~bit;
+                if ( board.masks[peer] == 0 )
+                    return false;
+            }
+            return true;
+        }
+
+        //naked singles,hidden singles of full units,cage combination filter until nothing change.
+        //false:contradiction
+        bool propagate( Board& board )
+        {
+            bool changed = true;
+            while ( changed )
+            {
+                changed = false;
+                for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+                {
+                    if ( ( board.values[cell] == 0 ) && ( count_digits( board.masks[cell] ) == 1 ) )
+                    {
+                        if ( this->place( board , cell , lowest_digit( board.masks[cell] ) ) == false )
+                            return false;
+                        changed = true;
+                    }
+                }
+                for ( const auto& unit : this->model.full_units )
+                {
+                    std::uint16_t once = 0 , twice = 0 , placed = 0;
+                    for ( cell_index_t cell : unit )
+                    {
+                        twice |= once & board.masks[cell];
+                        once |= board.masks[cell];
+                        if ( board.values[cell] != 0 )
+                            placed |= board.masks[cell];
+                    }
+                    if ( once != ALL_DIGITS )
+                        return false;
+                    std::uint16_t singles = once & ~twice & ~placed;
+                    while ( singles != 0 )
+                    {
+                        std::uint16_t bit = singles & -singles;
+                        singles &= ~bit;
+                        for ( cell_index_t cell : unit )
+                        {
+                            if ( board.masks[cell] & bit )
+                            {
+                                if ( this->place( board , cell , lowest_digit( bit ) ) == false )
+                                    return false;
+                                break;
+                            }
+                        }
+                        changed = true;
+                    }
+                }
+                for ( const auto& cage : this->model.cages )
+                {
+                    std::uint16_t placed = 0 , open = 0;
+                    for ( cell_index_t cell : cage.cells )
+                    {
+                        if ( board.values[cell] != 0 )
+                            placed |= board.masks[cell];
+                        else
+                            open |= board.masks[cell];
+                    }
+                    //combinations holding the placed digits whose rest can still go into open cells
+                    std::uint16_t allowed = 0;
+                    for ( std::uint16_t combination : *cage.combinations )
+                    {
+                        if ( ( ( combination & placed ) == placed ) && ( ( combination & ~placed & ~open ) == 0 ) )
+                            allowed |= combination;
+                    }
+                    if ( allowed == 0 )
+                        return false;
+                    allowed &= ~placed;
+                    for ( cell_index_t cell : cage.cells )
+                    {
+                        if ( ( board.values[cell] != 0 ) || ( ( board.masks[cell] & ~allowed ) == 0 ) )
+                            continue;
+                        board.masks[cell] &= allowed;
+                        if ( board.masks[cell] == 0 )
+                            return false;
+                        changed = true;
+                    }
+                }
+            }
+            return true;
+        }
+
+        bool check_limits( void )
+        {
+            this->node_count++;
+            if ( ( this->limits.node_budget != 0 ) && ( this->node_count > this->limits.node_budget ) )
+            {
+                this->status = SolveStatus::BUDGET_EXCEEDED;
+                return true;
+            }
+            if ( ( this->limits.stop != nullptr ) && this->limits.stop->load( std::memory_order_relaxed ) )
+            {
+                this->status = SolveStatus::CANCELLED;
+                return true;
+            }
+            if ( ( this->node_count%DEADLINE_CHECK_NODES == 0 ) &&
+                 ( this->limits.deadline != std::chrono::steady_clock::time_point::max() ) &&
+                 ( std::chrono::steady_clock::now() >= this->limits.deadline ) )
+            {
+                this->status = SolveStatus::BUDGET_EXCEEDED;
+                return true;
+            }
+            return false;
+        }
+
+        //true:stop the whole search( limit reached or aborted )
+        bool search( Board& board )
+        {
+            if ( this->check_limits() )
+                return true;
+            if ( this->propagate( board ) == false )
+                return false;
+            if ( board.filled == CELL_NUMBER )
+            {
+                puzzle_t solution;
+                for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+                {
+                    solution[cell/SUDOKU_SIZE][cell%SUDOKU_SIZE] = board.values[cell];
+                }
+                this->solutions.push_back( solution );
+                this->found++;
+                return ( this->solution_limit != 0 ) && ( this->found >= this->solution_limit );
+            }
+            //fewest candidates first
+            std::size_t branch_cell = CELL_NUMBER;
+            std::size_t branch_size = SUDOKU_SIZE + 1;
+            for ( std::size_t cell = 0 ; cell < CELL_NUMBER ; cell++ )
+            {
+                if ( board.values[cell] != 0 )
+                    continue;
+                std::size_t size = count_digits( board.masks[cell] );
+                if ( size < branch_size )
+                {
+                    branch_cell = cell;
+                    branch_size = size;
+                    if ( size == 2 )
+                        break;
+                }
+            }
+            std::uint16_t options = board.masks[branch_cell];
+            while ( options != 0 )
+            {
+                std::uint16_t bit = options & -options;
+                options &= ~bit;
+                Board next = board;
+                if ( this->place( next , branch_cell , lowest_digit( bit ) ) && this->search( next ) )
+                    return true;
+            }
+            return false;
+        }
+
+        const VariantModel& model;
+        std::vector<puzzle_t>& solutions;
+        std::size_t solution_limit;
+        const SolveLimits& limits;
+        std::size_t found;
+        std::uint64_t node_count;
+        SolveStatus status;
+};
+
+SolveStatus VariantModel::solve( const puzzle_t& clues , std::vector<puzzle_t>& solutions , std::size_t solution_limit ,
+                                 const SolveLimits& limits , std::uint64_t * nodes ) const noexcept( false )
+{
+    std::string except_message( __func__ );
+    for ( const auto& row : clues )
+    {
+        for ( cell_t value : row )
+        {
+            if ( value > SUDOKU_SIZE )
+            {
+                except_message += ":clue " + std::to_string( value ) + " out of range";
+                throw std::invalid_argument( except_message );
+            }
+        }
+    }
+    VariantSearch search( *this , solutions , solution_limit , limits );
+    search.run( clues );
+    if ( nodes != nullptr )
+        *nodes = search.get_node_count();
+    return search.get_status();
+}
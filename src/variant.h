@@ -0,0 +1,89 @@
+#pragma once
+#ifndef VARIANT_H
+#define VARIANT_H
+
+#include <cstdint>
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dancinglinks.h"
+#include "sudoku.h"
+
+//cell index:x*SUDOKU_SIZE + y
+typedef std::uint8_t cell_index_t;
+
+//distinct digits with a fixed sum
+struct VariantCage
+{
+    std::vector<cell_index_t> cells;
+    std::uint32_t sum;
+};
+
+//declarative rule set of a variant,every rule is a relation between cells.
+//  units:digits differ,a unit of SUDOKU_SIZE cells hold every digit exactly once
+//  cages:digits differ and add up to the sum( killer )
+//  different_pairs:the two cells never hold the same digit( anti-knight,anti-king )
+struct VariantSpec
+{
+    std::vector< std::vector<cell_index_t> > units;
+    std::vector<VariantCage> cages;
+    std::vector< std::pair<cell_index_t , cell_index_t> > different_pairs;
+};
+
+//rows,columns,boxes
+VariantSpec classic_spec( void ) noexcept( true );
+
+//rows,columns,the regions of a 81 character map( '1'-'9' region of the cell,reading order ).
+//throw invalid_argument unless every region has SUDOKU_SIZE cells
+VariantSpec jigsaw_spec( const std::string& regions ) noexcept( false );
+
+//both main diagonals as units
+void add_diagonals( VariantSpec& spec ) noexcept( false );
+
+//cells a chess knight move apart differ
+void add_anti_knight( VariantSpec& spec ) noexcept( false );
+
+//bitmask( digit k in bit k - 1 ) of every set of size distinct digits adding up to sum,
+//precomputed once for size 1-SUDOKU_SIZE,empty for an impossible cage
+const std::vector<std::uint16_t>& cage_combinations( std::size_t size , std::uint32_t sum ) noexcept( true );
+
+//VariantSpec compiled for the bitmask solver:peer lists,full units for hidden singles,cages with
+//their combination tables.immutable after construction,one model can serve many threads
+class VariantModel
+{
+    public:
+        //throw invalid_argument on a cell out of the board,repeated cell in a unit or cage,
+        //unit larger than SUDOKU_SIZE,impossible cage sum
+        explicit VariantModel( const VariantSpec& spec ) noexcept( false );
+        ~VariantModel() = default;
+
+        //append at most solution_limit( 0 all ) solutions,partial result when not COMPLETE.
+        //contradicting clues give COMPLETE without solution,nodes:search node number used.
+        //throw invalid_argument on a clue > SUDOKU_SIZE
+        SolveStatus solve( const puzzle_t& clues , std::vector<puzzle_t>& solutions , std::size_t solution_limit = 1 ,
+                           const SolveLimits& limits = SolveLimits() , std::uint64_t * nodes = nullptr ) const noexcept( false );
+
+        //no two clues break a rule,no search
+        bool check_clues( const puzzle_t& clues ) const noexcept( true );
+        //solution complete,keep the clues and satisfy every rule
+        bool check_solution( const puzzle_t& clues , const puzzle_t& solution ) const noexcept( true );
+    private:
+        friend class VariantSearch;
+
+        struct Cage
+        {
+            std::vector<cell_index_t> cells;
+            const std::vector<std::uint16_t> * combinations;
+        };
+
+        //cells which must differ from the cell,sorted
+        std::array< std::vector<cell_index_t> , SUDOKU_SIZE*SUDOKU_SIZE > peers;
+        //units holding every digit
+        std::vector< std::array< cell_index_t , SUDOKU_SIZE > > full_units;
+        std::vector<Cage> cages;
+};
+
+#endif
@@ -0,0 +1,164 @@
+//board operation checks,exit status is the failure number.
+//usage:board_check
+#include <cstdio>
+#include <cstdlib>
+
+#include <bitset>
+#include <filesystem>
+#include <random>
+#include <string>
+
+#include "replay.h"
+#include "sudoku.h"
+
+constexpr const char * CHECK_PUZZLE = "006031070437005000010467008029178300000000026300050000805004910003509087790086004";
+
+static int failures = 0;
+
+static void expect( bool condition , const std::string& what )
+{
+    std::printf( "%-4s %s\n" , condition ? "ok" : "FAIL" , what.c_str() );
+    if ( condition == false )
+        failures++;
+}
+
+static bool is_peer( std::size_t x , std::size_t y , std::size_t peer_x , std::size_t peer_y )
+{
+    return ( ( x != peer_x ) || ( y != peer_y ) ) &&
+           ( ( x == peer_x ) || ( y == peer_y ) ||
+             ( ( x/SUDOKU_BOX_SIZE == peer_x/SUDOKU_BOX_SIZE ) && ( y/SUDOKU_BOX_SIZE == peer_y/SUDOKU_BOX_SIZE ) ) );
+}
+
+//autoupdate keep removing candidates once allow_conflict put a conflicting digit on the board
+static void check_autoupdate_with_conflict( void )
+{
+    Sudoku sudoku( string_to_puzzle( CHECK_PUZZLE ) );
+    sudoku.autoupdate_candidate( true );
+    sudoku.allow_conflict( true );
+    //6 is already a clue of row 0
+    sudoku.fill_answer( 0 , 0 , 6 );
+    expect( sudoku.is_conflict( 0 , 0 ) , "conflicting digit kept on the board" );
+
+    constexpr std::size_t x = 4;
+    constexpr std::size_t y = 0;
+    candidate_mask_t mask = sudoku.get_candidate_mask( x , y );
+    cell_t value = static_cast<cell_t>( __builtin_ctz( mask ) + 1 );
+    candidate_mask_t bit = 1U << ( value - 1 );
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > holders;
+    for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        for ( std::size_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+        {
+            if ( is_peer( x , y , i , j ) && ( sudoku.get_candidate_mask( i , j ) & bit ) )
+                holders.set( i*SUDOKU_SIZE + j );
+        }
+    }
+    expect( holders.any() , "a peer of the second cell hold its digit" );
+    //the cell own candidate list lose it too
+    holders.set( x*SUDOKU_SIZE + y );
+
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > reported;
+    sudoku.set_change_listener( [ &reported ]( const CellChange& change ){ reported = change.candidates; } );
+    sudoku.fill_answer( x , y , value );
+    bool removed = true;
+    for ( std::size_t i = 0 ; i < SUDOKU_SIZE ; i++ )
+    {
+        for ( std::size_t j = 0 ; j < SUDOKU_SIZE ; j++ )
+        {
+            if ( is_peer( x , y , i , j ) && ( sudoku.get_candidate_mask( i , j ) & bit ) )
+                removed = false;
+        }
+    }
+    expect( removed , "peers of the second cell lost the digit" );
+    expect( reported == holders , "reported candidate changes match the eliminations" );
+}
+
+//a board holding a conflict still export its digits
+static void check_export_with_conflict( void )
+{
+    puzzle_t puzzle = string_to_puzzle( CHECK_PUZZLE );
+    puzzle[0][0] = 6;
+    std::string text = grid_to_string( puzzle );
+    std::string digits;
+    for ( char c : text )
+    {
+        if ( ( c >= '0' ) && ( c <= '9' ) )
+            digits.push_back( c );
+    }
+    expect( digits == "606031070" + std::string( CHECK_PUZZLE + SUDOKU_SIZE ) , "conflicting board exported as it is" );
+}
+
+//reported conflict changes equal a full rescan before and after,random fills,erases and state restores
+static void check_conflict_changes( void )
+{
+    Sudoku sudoku( string_to_puzzle( CHECK_PUZZLE ) );
+    sudoku.allow_conflict( true );
+    std::bitset< SUDOKU_SIZE*SUDOKU_SIZE > reported;
+    sudoku.set_change_listener( [ &reported ]( const CellChange& change ){ reported = change.conflicts; } );
+    std::mt19937 rand_gen( 1 );
+    std::uniform_int_distribution<std::size_t> cell_dist( 0 , SUDOKU_SIZE - 1 );
+    std::uniform_int_distribution<std::size_t> value_dist( 0 , SUDOKU_SIZE );
+    SudokuState saved = sudoku.get_state();
+    bool agree = true;
+    for ( int step = 0 ; step < 2000 ; step++ )
+    {
+        auto before = sudoku.get_conflicts();
+        reported.reset();
+        if ( step%50 == 49 )
+        {
+            SudokuState current = sudoku.get_state();
+            sudoku.set_state( saved );
+            saved = current;
+        }
+        else
+        {
+            sudoku.try_fill_answer( cell_dist( rand_gen ) , cell_dist( rand_gen ) , value_dist( rand_gen ) );
+        }
+        agree = agree && ( reported == ( before ^ sudoku.get_conflicts() ) );
+    }
+    expect( agree , "reported conflict changes match a full rescan" );
+}
+
+//PlayReplay then SaveReplay:the board record every played event,the saved stream replay to the same board
+static void check_replay_round_trip( void )
+{
+    Sudoku sudoku( string_to_puzzle( CHECK_PUZZLE ) );
+    ReplayStream stream;
+    stream.header = { SUDOKU_LEVEL::EASY , false , sudoku.get_state() };
+    cell_t value = static_cast<cell_t>( __builtin_ctz( sudoku.get_candidate_mask( 4 , 0 ) ) + 1 );
+    stream.events = { { 0 , ReplayEventType::AUTOUPDATE , 0 , 0 , 1 } ,
+                      { 10 , ReplayEventType::SELECT , 4 , 0 , 0 } ,
+                      { 20 , ReplayEventType::FILL_ANSWER , 4 , 0 , value } ,
+                      { 30 , ReplayEventType::AUTOUPDATE , 0 , 0 , 0 } ,
+                      { 40 , ReplayEventType::UNDO , 0 , 0 , 0 } ,
+                      { 50 , ReplayEventType::REDO , 0 , 0 , 0 } };
+
+    ReplayEngine played( stream );
+    ReplayRecorder recorder;
+    recorder.begin( stream.header );
+    for ( const ReplayEvent& event : stream.events )
+    {
+        played.step();
+        recorder.record( event.type , event.x , event.y , event.value );
+    }
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "board_check.replay";
+    save_replay( path , recorder.get_stream() );
+    ReplayEngine saved( load_replay( path ) );
+    std::filesystem::remove( path );
+    saved.run();
+
+    const SudokuState lhs = played.get_game().get_state();
+    const SudokuState rhs = saved.get_game().get_state();
+    expect( ( lhs.puzzle == rhs.puzzle ) && ( lhs.answers == rhs.answers ) && ( lhs.candidates == rhs.candidates ) &&
+            ( played.get_game().is_autoupdate_candidate() == saved.get_game().is_autoupdate_candidate() ) ,
+            "saved replay reproduce the played board" );
+}
+
+int main( void )
+{
+    check_autoupdate_with_conflict();
+    check_export_with_conflict();
+    check_conflict_changes();
+    check_replay_round_trip();
+    return ( failures == 0 ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,122 @@
+//network puzzle fetch latency under injected faults,against the loopback stand-in server.
+//usage:fetch_bench [--requests N] [--latency MS] [--jitter MS] [--truncate RATE] [--malformed RATE] [--prefetch DEPTH]
+//      fetch_bench --serve [--latency MS] ...   run stand-in server only,for SUDOKU_API_URL
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "httpstandin.h"
+#include "puzzlefetcher.h"
+#include "sudoku.h"
+
+static long max_rss_kb( void )
+{
+    rusage usage;
+    getrusage( RUSAGE_SELF , &usage );
+    return usage.ru_maxrss;
+}
+
+static double percentile( const std::vector<double>& sorted , double p )
+{
+    if ( sorted.empty() )
+        return 0.0;
+    return sorted[ static_cast<std::size_t>( p*( sorted.size() - 1 ) + 0.5 ) ];
+}
+
+int main( int argc , char * argv[] )
+{
+    StandinFaults faults;
+    faults.latency_ms = 5;
+    faults.jitter_ms = 5;
+    faults.truncate_rate = 0.05;
+    faults.malformed_rate = 0.05;
+    std::size_t request_number = 200;
+    std::size_t prefetch_depth = 0;
+    bool serve_only = false;
+
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        bool has_value = ( i + 1 < argc );
+        if ( option == "--serve" )
+            serve_only = true;
+        else if ( ( option == "--requests" ) && has_value )
+            request_number = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--latency" ) && has_value )
+            faults.latency_ms = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--jitter" ) && has_value )
+            faults.jitter_ms = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--truncate" ) && has_value )
+            faults.truncate_rate = std::strtod( argv[++i] , nullptr );
+        else if ( ( option == "--malformed" ) && has_value )
+            faults.malformed_rate = std::strtod( argv[++i] , nullptr );
+        else if ( ( option == "--prefetch" ) && has_value )
+            prefetch_depth = std::strtoul( argv[++i] , nullptr , 10 );
+        else
+        {
+            std::fprintf( stderr , "unknown option:%s\n" , option.c_str() );
+            return EXIT_FAILURE;
+        }
+    }
+
+    HttpStandinServer server( faults );
+    if ( serve_only )
+    {
+        std::printf( "SUDOKU_API_URL=%s\n" , server.get_api_url().c_str() );
+        std::fflush( stdout );
+        while ( true )
+            std::this_thread::sleep_for( std::chrono::hours( 1 ) );
+    }
+
+    std::filesystem::path cache_dir = std::filesystem::temp_directory_path() /
+                                      ( "sudoku-fetch-bench-" + std::to_string( getpid() ) );
+    long rss_before = max_rss_kb();
+    std::vector<double> latencies;
+    latencies.reserve( request_number );
+    std::size_t failures = 0;
+    std::size_t with_solution = 0;
+    {
+        PuzzleFetcher fetcher( server.get_api_url() , cache_dir , prefetch_depth );
+        for ( std::size_t i = 0 ; i < request_number ; i++ )
+        {
+            SUDOKU_LEVEL level = static_cast<SUDOKU_LEVEL>( i%static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) );
+            auto begin = std::chrono::steady_clock::now();
+            try
+            {
+                NetworkPuzzle puzzle = fetcher.fetch( level ).get();
+                if ( puzzle.has_solution )
+                    with_solution++;
+            }
+            catch( const std::exception& )
+            {
+                failures++;
+            }
+            std::chrono::duration<double,std::milli> cost = std::chrono::steady_clock::now() - begin;
+            latencies.push_back( cost.count() );
+        }
+    }
+    long rss_after = max_rss_kb();
+    std::error_code error;
+    std::filesystem::remove_all( cache_dir , error );
+
+    std::sort( latencies.begin() , latencies.end() );
+    std::printf( "requests:%zu server requests:%zu failures:%zu with solution:%zu\n" ,
+                 request_number , server.get_request_count() , failures , with_solution );
+    std::printf( "latency ms p50:%.3f p90:%.3f p99:%.3f max:%.3f\n" ,
+                 percentile( latencies , 0.50 ) , percentile( latencies , 0.90 ) ,
+                 percentile( latencies , 0.99 ) , latencies.empty() ? 0.0 : latencies.back() );
+    std::printf( "max rss kB before:%ld after:%ld\n" , rss_before , rss_after );
+    return EXIT_SUCCESS;
+}
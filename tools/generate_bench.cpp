@@ -0,0 +1,95 @@
+//difficulty targeted generation throughput of every level band.
+//usage:generate_bench [--count N] [--threads N] [--level easy|medium|hard|expert]
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "generator.h"
+#include "sudoku.h"
+
+int main( int argc , char * argv[] )
+{
+    std::size_t count = 32;
+    std::size_t worker_number = 0;
+    std::vector<SUDOKU_LEVEL> levels;
+
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        bool has_value = ( i + 1 < argc );
+        if ( ( option == "--count" ) && has_value )
+            count = std::max<std::size_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else if ( ( option == "--threads" ) && has_value )
+            worker_number = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--level" ) && has_value )
+        {
+            std::string name( argv[++i] );
+            bool found = false;
+            for ( std::size_t k = 0 ; k < static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) ; k++ )
+            {
+                if ( level_to_string( static_cast<SUDOKU_LEVEL>( k ) ) == name )
+                {
+                    levels.push_back( static_cast<SUDOKU_LEVEL>( k ) );
+                    found = true;
+                }
+            }
+            if ( found == false )
+            {
+                std::fprintf( stderr , "unknown level:%s\n" , name.c_str() );
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            std::fprintf( stderr , "unknown option:%s\n" , option.c_str() );
+            return EXIT_FAILURE;
+        }
+    }
+    if ( levels.empty() )
+    {
+        for ( std::size_t k = 0 ; k < static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) ; k++ )
+        {
+            levels.push_back( static_cast<SUDOKU_LEVEL>( k ) );
+        }
+    }
+
+    try
+    {
+        for ( SUDOKU_LEVEL level : levels )
+        {
+            GeneratorOptions options;
+            options.level = level;
+            options.count = count;
+            options.worker_number = worker_number;
+            GeneratorStats stats;
+            std::vector<GeneratedPuzzle> puzzles = generate_puzzles( options , &stats );
+            double clues = 0.0;
+            for ( const auto& puzzle : puzzles )
+            {
+                clues += puzzle.clues;
+            }
+            std::printf( "%-7s puzzles:%zu %.1f/s seconds:%.2f mean clues:%.1f\n" , level_to_string( level ).c_str() ,
+                         puzzles.size() , stats.get_accepted_rate() , stats.seconds , puzzles.empty() ? 0.0 : clues/puzzles.size() );
+            std::printf( "        grids:%llu carved:%llu mutations:%llu dropped:%llu graded" ,
+                         static_cast<unsigned long long>( stats.grids ) , static_cast<unsigned long long>( stats.carved ) ,
+                         static_cast<unsigned long long>( stats.mutations ) , static_cast<unsigned long long>( stats.dropped ) );
+            for ( std::size_t k = 0 ; k < stats.graded.size() ; k++ )
+            {
+                std::printf( " %s:%llu" , level_to_string( static_cast<SUDOKU_LEVEL>( k ) ).c_str() ,
+                             static_cast<unsigned long long>( stats.graded[k] ) );
+            }
+            std::printf( "\n" );
+        }
+    }
+    catch( const std::exception& e )
+    {
+        std::fprintf( stderr , "%s\n" , e.what() );
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
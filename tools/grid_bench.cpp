@@ -0,0 +1,145 @@
+//grid validation and candidate throughput,per puzzle calls against every batch kernel.
+//usage:grid_bench [--count N] [--seed N]
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gridkernel.h"
+#include "sudoku.h"
+
+constexpr const char * BENCH_PUZZLE = "006031070437005000010467008029178300000000026300050000805004910003509087790086004";
+constexpr std::size_t CELL_NUMBER = SUDOKU_SIZE*SUDOKU_SIZE;
+
+//relabelled,row shuffled copies of the bench puzzle,every eighth one has a repeated digit
+static std::vector<puzzle_t> make_corpus( std::size_t count , std::uint32_t seed )
+{
+    std::mt19937 random( seed );
+    puzzle_t base = string_to_puzzle( BENCH_PUZZLE );
+    std::vector<puzzle_t> corpus( count );
+    for ( std::size_t p = 0 ; p < count ; p++ )
+    {
+        std::array<cell_t , SUDOKU_SIZE + 1> labels;
+        std::iota( labels.begin() , labels.end() , 0 );
+        std::shuffle( labels.begin() + 1 , labels.end() , random );
+        std::array<std::size_t , SUDOKU_SIZE> rows;
+        for ( std::size_t band = 0 ; band < SUDOKU_BOX_SIZE ; band++ )
+        {
+            std::array<std::size_t , SUDOKU_BOX_SIZE> in_band;
+            std::iota( in_band.begin() , in_band.end() , band*SUDOKU_BOX_SIZE );
+            std::shuffle( in_band.begin() , in_band.end() , random );
+            std::copy( in_band.begin() , in_band.end() , rows.begin() + band*SUDOKU_BOX_SIZE );
+        }
+        for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
+        {
+            for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+            {
+                corpus[p][x][y] = labels[base[rows[x]][y]];
+            }
+        }
+        if ( p%8 == 7 )
+            corpus[p][0][0] = ( corpus[p][0][1] != 0 ) ? corpus[p][0][1] : corpus[p][0][2];
+    }
+    return corpus;
+}
+
+static double measure( const std::function<void()>& work )
+{
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+}
+
+int main( int argc , char * argv[] )
+{
+    std::size_t count = 1000000;
+    std::uint32_t seed = 1;
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        bool has_value = ( i + 1 < argc );
+        if ( ( option == "--count" ) && has_value )
+            count = std::max<std::size_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else if ( ( option == "--seed" ) && has_value )
+            seed = std::strtoul( argv[++i] , nullptr , 10 );
+        else
+        {
+            std::fprintf( stderr , "unknown option:%s\n" , option.c_str() );
+            return EXIT_FAILURE;
+        }
+    }
+
+    //structure of arrays in GRID_BATCH_BLOCK blocks,block b start at b*GRID_BATCH_BLOCK*CELL_NUMBER
+    std::vector<puzzle_t> corpus = make_corpus( count , seed );
+    std::vector<cell_t> cells( count*CELL_NUMBER );
+    for ( std::size_t begin = 0 ; begin < count ; begin += GRID_BATCH_BLOCK )
+    {
+        std::size_t block_count = std::min( GRID_BATCH_BLOCK , count - begin );
+        for ( std::size_t p = 0 ; p < block_count ; p++ )
+        {
+            for ( std::size_t k = 0 ; k < CELL_NUMBER ; k++ )
+            {
+                cells[begin*CELL_NUMBER + k*block_count + p] = corpus[begin + p][k/SUDOKU_SIZE][k%SUDOKU_SIZE];
+            }
+        }
+    }
+    auto scan = [ & ]( std::uint8_t * legal , candidate_mask_t * candidates , GridKernel kernel )
+    {
+        for ( std::size_t begin = 0 ; begin < count ; begin += GRID_BATCH_BLOCK )
+        {
+            std::size_t block_count = std::min( GRID_BATCH_BLOCK , count - begin );
+            grid_scan_batch( cells.data() + begin*CELL_NUMBER , block_count , legal + begin ,
+                             ( candidates == nullptr ) ? nullptr : candidates + begin*CELL_NUMBER , kernel );
+        }
+    };
+
+    std::vector<std::uint8_t> expected_legal( count );
+    double seconds = measure( [ & ]()
+    {
+        for ( std::size_t p = 0 ; p < count ; p++ )
+        {
+            expected_legal[p] = check_puzzle( corpus[p] ) ? 1 : 0;
+        }
+    } );
+    std::printf( "%-22s %8.2f Mpuzzle/s\n" , "check_puzzle" , count/seconds/1e6 );
+    seconds = measure( [ & ]()
+    {
+        for ( std::size_t p = 0 ; p < count ; p++ )
+        {
+            candidate_t candidates = generate_candidates( corpus[p] );
+            if ( candidates[0][0].size() > SUDOKU_SIZE )
+                std::abort();
+        }
+    } );
+    std::printf( "%-22s %8.2f Mpuzzle/s\n" , "generate_candidates" , count/seconds/1e6 );
+
+    std::vector<candidate_mask_t> expected_candidates( count*CELL_NUMBER );
+    std::vector<std::uint8_t> legal( count );
+    scan( legal.data() , expected_candidates.data() , GridKernel::SCALAR );
+    bool agree = ( legal == expected_legal );
+    for ( GridKernel kernel : { GridKernel::SCALAR , GridKernel::SSSE3 , GridKernel::AVX2 } )
+    {
+        if ( grid_kernel_supported( kernel ) == false )
+        {
+            std::printf( "%-22s unsupported\n" , grid_kernel_to_string( kernel ) );
+            continue;
+        }
+        std::vector<candidate_mask_t> candidates( count*CELL_NUMBER );
+        double check_seconds = measure( [ & ](){ scan( legal.data() , nullptr , kernel ); } );
+        agree = agree && ( legal == expected_legal );
+        double candidate_seconds = measure( [ & ](){ scan( legal.data() , candidates.data() , kernel ); } );
+        agree = agree && ( legal == expected_legal ) && ( candidates == expected_candidates );
+        std::printf( "%-22s %8.2f Mpuzzle/s check %8.2f Mpuzzle/s candidates\n" , grid_kernel_to_string( kernel ) ,
+                     count/check_seconds/1e6 , count/candidate_seconds/1e6 );
+    }
+    std::printf( "default kernel:%s,results %s\n" , grid_kernel_to_string( grid_default_kernel() ) , agree ? "agree" : "DIFFER" );
+    return agree ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,213 @@
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "httpstandin.h"
+
+static const char * level_response_body( const std::string& level )
+{
+    //same format as the real api,only the puzzle differ by level
+    if ( level == "easy" )
+    {
+        return "{\"answer\":\"success\",\"message\":\"Level exist\",\"desc\":["
+               "\"006031070437005000010467008029178300000000026300050000805004910003509087790086004\","
+               "\"586231479437895162912467538629178345158943726374652891865724913243519687791386254\","
+               "123,3,false]}";
+    }
+    return "{\"answer\":\"success\",\"message\":\"Level exist\",\"desc\":["
+           "\"008000402000320780702506000003050004009740200006200000000000500900005600620000190\","
+           "\"368179452591324786742586319213658974859743261476291835187962543934815627625437198\","
+           "310,7,false]}";
+}
+
+static bool send_all( int fd , const char * data , std::size_t size )
+{
+    while ( size != 0 )
+    {
+        ssize_t sent = ::send( fd , data , size , MSG_NOSIGNAL );
+        if ( sent <= 0 )
+            return false;
+        data += sent;
+        size -= static_cast<std::size_t>( sent );
+    }
+    return true;
+}
+
+HttpStandinServer::HttpStandinServer( StandinFaults faults ) noexcept( false ):
+    faults( faults ),
+    listen_fd( -1 ),
+    port( 0 ),
+    stop( false ),
+    request_count( 0 )
+{
+    std::string except_message( __func__ );
+
+    this->listen_fd = ::socket( AF_INET , SOCK_STREAM , 0 );
+    if ( this->listen_fd < 0 )
+    {
+        except_message += ":create socket failure";
+        throw std::runtime_error( except_message );
+    }
+    int reuse = 1;
+    ::setsockopt( this->listen_fd , SOL_SOCKET , SO_REUSEADDR , &reuse , sizeof( reuse ) );
+
+    sockaddr_in address;
+    std::memset( &address , 0 , sizeof( address ) );
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+    address.sin_port = 0;
+    socklen_t address_size = sizeof( address );
+    if ( ( ::bind( this->listen_fd , reinterpret_cast<sockaddr *>( &address ) , sizeof( address ) ) != 0 ) ||
+         ( ::listen( this->listen_fd , 64 ) != 0 ) ||
+         ( ::getsockname( this->listen_fd , reinterpret_cast<sockaddr *>( &address ) , &address_size ) != 0 ) )
+    {
+        ::close( this->listen_fd );
+        except_message += ":bind loopback address failure";
+        throw std::runtime_error( except_message );
+    }
+    this->port = ntohs( address.sin_port );
+    this->acceptor = std::thread( &HttpStandinServer::accept_loop , this );
+}
+
+HttpStandinServer::~HttpStandinServer()
+{
+    this->stop = true;
+    //wakeup blocked accept() and recv()
+    ::shutdown( this->listen_fd , SHUT_RDWR );
+    {
+        std::lock_guard<std::mutex> lock( this->connection_mutex );
+        for ( int fd : this->connection_fds )
+        {
+            ::shutdown( fd , SHUT_RDWR );
+        }
+    }
+    if ( this->acceptor.joinable() )
+        this->acceptor.join();
+    for ( auto& connection : this->connection_threads )
+    {
+        if ( connection.joinable() )
+            connection.join();
+    }
+    ::close( this->listen_fd );
+}
+
+std::uint16_t HttpStandinServer::get_port( void ) const noexcept( true )
+{
+    return this->port;
+}
+
+std::string HttpStandinServer::get_api_url( void ) const noexcept( true )
+{
+    return "http://127.0.0.1:" + std::to_string( this->port ) + "/api/getLevel/";
+}
+
+std::size_t HttpStandinServer::get_request_count( void ) const noexcept( true )
+{
+    return this->request_count;
+}
+
+void HttpStandinServer::accept_loop( void )
+{
+    while ( this->stop == false )
+    {
+        int connection_fd = ::accept( this->listen_fd , nullptr , nullptr );
+        if ( connection_fd < 0 )
+        {
+            if ( this->stop )
+                break;
+            continue;
+        }
+        std::lock_guard<std::mutex> lock( this->connection_mutex );
+        if ( this->stop )
+        {
+            ::close( connection_fd );
+            break;
+        }
+        this->connection_fds.push_back( connection_fd );
+        this->connection_threads.emplace_back( &HttpStandinServer::serve_connection , this , connection_fd );
+    }
+}
+
+void HttpStandinServer::serve_connection( int connection_fd )
+{
+    std::random_device rand_div;
+    std::mt19937 rand_gen( rand_div() );
+    std::uniform_real_distribution<double> fault_dist( 0.0 , 1.0 );
+    std::uniform_int_distribution<std::uint32_t> jitter_dist( 0 , this->faults.jitter_ms );
+
+    std::string request;
+    char buff[4096];
+    bool keep_alive = true;
+    while ( keep_alive && ( this->stop == false ) )
+    {
+        std::size_t header_end = request.find( "\r\n\r\n" );
+        if ( header_end == std::string::npos )
+        {
+            ssize_t size = ::recv( connection_fd , buff , sizeof( buff ) , 0 );
+            if ( ( size <= 0 ) || ( request.size() > 64*1024 ) )
+                break;
+            request.append( buff , static_cast<std::size_t>( size ) );
+            continue;
+        }
+
+        std::string header( request , 0 , header_end );
+        request.erase( 0 , header_end + 4 );
+        this->request_count++;
+        keep_alive = ( header.find( "Connection: close" ) == std::string::npos );
+
+        //"GET /api/getLevel/$(level) HTTP/1.1"
+        std::string level;
+        std::size_t level_begin = header.find( "/api/getLevel/" );
+        std::size_t level_end = header.find( ' ' , 4 );
+        if ( ( level_begin != std::string::npos ) && ( level_end != std::string::npos ) && ( level_end > level_begin ) )
+        {
+            level_begin += std::strlen( "/api/getLevel/" );
+            level.assign( header , level_begin , level_end - level_begin );
+        }
+
+        std::uint32_t delay = this->faults.latency_ms + jitter_dist( rand_gen );
+        if ( delay != 0 )
+            std::this_thread::sleep_for( std::chrono::milliseconds( delay ) );
+
+        std::string body( level_response_body( level ) );
+        double fault = fault_dist( rand_gen );
+        bool truncate = ( fault < this->faults.truncate_rate );
+        if ( ( truncate == false ) && ( fault < this->faults.truncate_rate + this->faults.malformed_rate ) )
+        {
+            //unbalanced brackets and a broken puzzle string
+            body = "{\"answer\":\"success\",\"desc\":[\"0080004020\"]]}";
+        }
+
+        std::string response( "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n" );
+        response += "Content-Length: " + std::to_string( body.size() ) + "\r\n";
+        response += keep_alive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+        if ( truncate )
+        {
+            response.append( body , 0 , body.size()/2 );
+            send_all( connection_fd , response.data() , response.size() );
+            break;
+        }
+        response += body;
+        if ( send_all( connection_fd , response.data() , response.size() ) == false )
+            break;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock( this->connection_mutex );
+        auto fd_iter = std::find( this->connection_fds.begin() , this->connection_fds.end() , connection_fd );
+        if ( fd_iter != this->connection_fds.end() )
+            this->connection_fds.erase( fd_iter );
+    }
+    ::close( connection_fd );
+}
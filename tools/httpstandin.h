@@ -0,0 +1,55 @@
+#pragma once
+#ifndef HTTPSTANDIN_H
+#define HTTPSTANDIN_H
+
+#include <cstdint>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//fault injection of every response
+struct StandinFaults
+{
+    //fixed delay + uniform [ 0 , jitter_ms ] delay before response
+    std::uint32_t latency_ms = 0;
+    std::uint32_t jitter_ms = 0;
+    //send full Content-Length but only half body,then close connection
+    double truncate_rate = 0.0;
+    //send a complete http response with broken json body
+    double malformed_rate = 0.0;
+};
+
+//loopback stand-in of https://sudoku.com/api/getLevel/$(Level),plain http/1.1 with keep-alive.
+//listen 127.0.0.1 random port,never touch external network.
+class HttpStandinServer
+{
+    public:
+        HttpStandinServer( StandinFaults faults = StandinFaults() ) noexcept( false );
+        HttpStandinServer( const HttpStandinServer& ) = delete;
+        HttpStandinServer& operator=( const HttpStandinServer& ) = delete;
+        ~HttpStandinServer();
+
+        std::uint16_t get_port( void ) const noexcept( true );
+        //PuzzleFetcher api url
+        std::string get_api_url( void ) const noexcept( true );
+        std::size_t get_request_count( void ) const noexcept( true );
+    private:
+        void accept_loop( void );
+        void serve_connection( int connection_fd );
+
+        StandinFaults faults;
+        int listen_fd;
+        std::uint16_t port;
+        std::atomic<bool> stop;
+        std::atomic<std::size_t> request_count;
+
+        std::mutex connection_mutex;
+        std::vector<int> connection_fds;
+        std::vector<std::thread> connection_threads;
+        std::thread acceptor;
+};
+
+#endif
@@ -0,0 +1,146 @@
+//headless BoardRenderer frame time on an image surface,no display needed.
+//usage:render_bench [--frames N] [--scale S] [--dark]
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cairomm/context.h>
+#include <cairomm/surface.h>
+
+#include "boardrenderer.h"
+#include "sudoku.h"
+
+static const char * BENCH_PUZZLE = "008000402000320780702506000003050004009740200006200000000000500900005600620000190";
+
+static double percentile( const std::vector<double>& sorted , double p )
+{
+    if ( sorted.empty() )
+        return 0.0;
+    return sorted[ static_cast<std::size_t>( p*( sorted.size() - 1 ) + 0.5 ) ];
+}
+
+//first frame( cache build ) reported alone,the rest as percentiles
+static void run_case( const std::string& name , std::size_t frame_number , const std::function<void( void )>& frame )
+{
+    std::vector<double> costs;
+    costs.reserve( frame_number );
+    for ( std::size_t i = 0 ; i < frame_number ; i++ )
+    {
+        auto begin = std::chrono::steady_clock::now();
+        frame();
+        std::chrono::duration<double,std::milli> cost = std::chrono::steady_clock::now() - begin;
+        costs.push_back( cost.count() );
+    }
+    double first = costs.empty() ? 0.0 : costs.front();
+    if ( costs.empty() == false )
+        costs.erase( costs.begin() );
+    std::sort( costs.begin() , costs.end() );
+    std::printf( "%-18s first:%8.3f p50:%8.3f p90:%8.3f p99:%8.3f max:%8.3f ms\n" , name.c_str() , first ,
+                 percentile( costs , 0.50 ) , percentile( costs , 0.90 ) , percentile( costs , 0.99 ) ,
+                 costs.empty() ? 0.0 : costs.back() );
+}
+
+int main( int argc , char * argv[] )
+{
+    std::size_t frame_number = 500;
+    int scale = 1;
+    Themes theme = Themes::LIGHT;
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        bool has_value = ( i + 1 < argc );
+        if ( ( option == "--frames" ) && has_value )
+            frame_number = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--scale" ) && has_value )
+            scale = std::atoi( argv[++i] );
+        else if ( option == "--dark" )
+            theme = Themes::DARK;
+        else
+        {
+            std::fprintf( stderr , "unknown option:%s\n" , option.c_str() );
+            return EXIT_FAILURE;
+        }
+    }
+
+    BoardRenderer renderer;
+    renderer.set_theme( theme );
+    renderer.set_device_scale( scale );
+    int board_size = renderer.get_board_size();
+    auto surface = Cairo::ImageSurface::create( Cairo::FORMAT_ARGB32 , board_size*scale , board_size*scale );
+    cairo_surface_set_device_scale( surface->cobj() , scale , scale );
+    auto cairo_context = Cairo::Context::create( surface );
+
+    puzzle_t empty_puzzle = puzzle_t();
+    candidate_t empty_candidates = candidate_t();
+    puzzle_t puzzle = string_to_puzzle( BENCH_PUZZLE );
+    candidate_t candidates = generate_candidates( puzzle );
+    candidate_t full_candidates;
+    for ( auto& row : full_candidates )
+    {
+        for ( auto& cell : row )
+            cell = { 1 , 2 , 3 , 4 , 5 , 6 , 7 , 8 , 9 };
+    }
+    Sudoku game( puzzle );
+    puzzle_t solution = game.get_solution( false ).at( 0 );
+
+    BoardView empty_view;
+    empty_view.puzzle = &empty_puzzle;
+    empty_view.candidates = &empty_candidates;
+
+    BoardView candidate_view;
+    candidate_view.puzzle = &puzzle;
+    candidate_view.candidates = &candidates;
+    candidate_view.select_cell = true;
+    candidate_view.select_x = 0;
+    candidate_view.select_y = 2;
+
+    BoardView full_candidate_view;
+    full_candidate_view.puzzle = &empty_puzzle;
+    full_candidate_view.candidates = &full_candidates;
+    full_candidate_view.select_cell = true;
+
+    BoardView solution_view;
+    solution_view.puzzle = &solution;
+    solution_view.select_cell = true;
+    solution_view.highlight_number = false;
+
+    auto frame_of = [ & ]( const BoardView& view ) -> std::function<void( void )>
+    {
+        return [ & , view ]()
+        {
+            renderer.draw_frame( cairo_context , board_size , board_size , view );
+            surface->flush();
+        };
+    };
+
+    std::printf( "board:%dx%d scale:%d frames:%zu\n" , board_size , board_size , scale , frame_number );
+    run_case( "empty" , frame_number , frame_of( empty_view ) );
+    run_case( "candidates" , frame_number , frame_of( candidate_view ) );
+    run_case( "full candidates" , frame_number , frame_of( full_candidate_view ) );
+    run_case( "solution" , frame_number , frame_of( solution_view ) );
+    //every frame rebuild layers and glyphs
+    run_case( "candidates cold" , frame_number , [ & ]()
+        {
+            BoardRenderer cold_renderer;
+            cold_renderer.set_theme( theme );
+            cold_renderer.set_device_scale( scale );
+            cold_renderer.draw_frame( cairo_context , board_size , board_size , candidate_view );
+            surface->flush();
+        }
+    );
+    //pango text path used by print
+    run_case( "print path" , frame_number , [ & ]()
+        {
+            renderer.draw_print( cairo_context , puzzle );
+            surface->flush();
+        }
+    );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,145 @@
+//batch solving throughput on one thread,DancingLinks against the lockstep lanes of every kernel.
+//usage:solve_bench [--count N] [--seed N] [--limit N]
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gridkernel.h"
+#include "lockstep.h"
+#include "sudoku.h"
+
+//easy,three hard ones( many guesses ) and one with two solutions( 8 and 9 of the bottom rows swap )
+static const char * const BENCH_PUZZLES[] =
+{
+    "006031070437005000010467008029178300000000026300050000805004910003509087790086004",
+    "800000000003600000070090200050007000000045700000100030001000068008500010090000400",
+    "400000805030000000000700000020000060000080400000010000000603070500200000104000000",
+    "000000010400000000020000000000050407008000300001090000300400200050100000000806000",
+    "906070403000400200070023010500000100040208060003000005030700050007005000405010708",
+};
+
+//relabelled,row shuffled copies of the bench puzzles,every sixteenth one has a repeated digit
+static std::vector<puzzle_t> make_corpus( std::size_t count , std::uint32_t seed )
+{
+    std::mt19937 random( seed );
+    std::vector<puzzle_t> bases;
+    for ( const char * puzzle : BENCH_PUZZLES )
+        bases.push_back( string_to_puzzle( puzzle ) );
+    //second solution:the two digits of a 2x2 rectangle swapped
+    bases.back()[7][0] = 0;
+    std::vector<puzzle_t> corpus( count );
+    for ( std::size_t p = 0 ; p < count ; p++ )
+    {
+        const puzzle_t& base = bases[p%bases.size()];
+        std::array<cell_t , SUDOKU_SIZE + 1> labels;
+        std::iota( labels.begin() , labels.end() , 0 );
+        std::shuffle( labels.begin() + 1 , labels.end() , random );
+        std::array<std::size_t , SUDOKU_SIZE> rows;
+        for ( std::size_t band = 0 ; band < SUDOKU_BOX_SIZE ; band++ )
+        {
+            std::array<std::size_t , SUDOKU_BOX_SIZE> in_band;
+            std::iota( in_band.begin() , in_band.end() , band*SUDOKU_BOX_SIZE );
+            std::shuffle( in_band.begin() , in_band.end() , random );
+            std::copy( in_band.begin() , in_band.end() , rows.begin() + band*SUDOKU_BOX_SIZE );
+        }
+        for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
+        {
+            for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+            {
+                corpus[p][x][y] = labels[base[rows[x]][y]];
+            }
+        }
+        if ( p%16 == 15 )
+        {
+            auto first = std::find_if( corpus[p][0].begin() , corpus[p][0].end() , []( cell_t value ){ return value != 0; } );
+            corpus[p][0][( first == corpus[p][0].begin() ) ? 1 : 0] = *first;
+        }
+    }
+    return corpus;
+}
+
+//a full legal grid keeping every clue
+static bool is_solution_of( const puzzle_t& puzzle , const puzzle_t& solution )
+{
+    for ( std::size_t x = 0 ; x < SUDOKU_SIZE ; x++ )
+    {
+        for ( std::size_t y = 0 ; y < SUDOKU_SIZE ; y++ )
+        {
+            if ( ( solution[x][y] == 0 ) || ( ( puzzle[x][y] != 0 ) && ( puzzle[x][y] != solution[x][y] ) ) )
+                return false;
+        }
+    }
+    return check_puzzle( solution );
+}
+
+static double measure( const std::function<void()>& work )
+{
+    auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double>( std::chrono::steady_clock::now() - begin ).count();
+}
+
+int main( int argc , char * argv[] )
+{
+    std::size_t count = 100000;
+    std::uint32_t seed = 1;
+    std::size_t limit = 2;
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        bool has_value = ( i + 1 < argc );
+        if ( ( option == "--count" ) && has_value )
+            count = std::max<std::size_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else if ( ( option == "--seed" ) && has_value )
+            seed = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--limit" ) && has_value )
+            limit = std::strtoul( argv[++i] , nullptr , 10 );
+        else
+        {
+            std::fprintf( stderr , "unknown option:%s\n" , option.c_str() );
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<puzzle_t> corpus = make_corpus( count , seed );
+    std::vector<BatchSolution> expected;
+    double seconds = measure( [ & ](){ Sudoku::solve_batch( corpus , expected , limit , SolveLimits() , SolverEngine::DANCING_LINKS ); } );
+    std::printf( "%-22s %10.0f puzzle/s\n" , "dancing links" , count/seconds );
+
+    bool agree = true;
+    for ( GridKernel kernel : { GridKernel::SCALAR , GridKernel::AVX2 } )
+    {
+        if ( grid_kernel_supported( kernel ) == false )
+        {
+            std::printf( "lockstep %-13s unsupported\n" , grid_kernel_to_string( kernel ) );
+            continue;
+        }
+        std::vector<BatchSolution> results( count );
+        seconds = measure( [ & ](){ lockstep_solve( corpus.data() , count , results.data() , limit , SolveLimits() , nullptr , kernel ); } );
+        std::uint64_t nodes = 0;
+        for ( std::size_t p = 0 ; p < count ; p++ )
+        {
+            const BatchSolution& lhs = expected[p];
+            const BatchSolution& rhs = results[p];
+            nodes += rhs.nodes;
+            bool same = ( lhs.legal == rhs.legal ) && ( lhs.status == rhs.status ) && ( lhs.solution_count == rhs.solution_count );
+            //several solutions:any one of them may come first
+            if ( same && ( rhs.solution_count > 0 ) )
+                same = ( lhs.solution_count == 1 ) ? ( lhs.solution == rhs.solution ) : is_solution_of( corpus[p] , rhs.solution );
+            agree = agree && same;
+        }
+        std::printf( "lockstep %-13s %10.0f puzzle/s %6.2f guesses/puzzle\n" , grid_kernel_to_string( kernel ) ,
+                     count/seconds , static_cast<double>( nodes )/count );
+    }
+    std::printf( "solution limit %zu,results %s\n" , limit , agree ? "agree" : "DIFFER" );
+    return agree ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,231 @@
+//request latency of a running sudokud under concurrent pipelined load.
+//usage:solverd_load [--socket PATH] [--connections N] [--depth N] [--requests N] [--puzzles N]
+//                   [--op solve|count|grade|canonicalize|generate|mix] [--budget MS]
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <unistd.h>
+
+#include "puzzlepool.h"
+#include "solverproto.h"
+#include "sudoku.h"
+
+static double percentile( const std::vector<double>& sorted , double p )
+{
+    if ( sorted.empty() )
+        return 0.0;
+    return sorted[ static_cast<std::size_t>( p*( sorted.size() - 1 ) + 0.5 ) ];
+}
+
+static bool parse_op( const std::string& name , SolverOp& op , bool& mix )
+{
+    static const std::map<std::string , SolverOp> ops = {
+        { "solve" , SolverOp::SOLVE } , { "count" , SolverOp::COUNT } , { "grade" , SolverOp::GRADE } ,
+        { "canonicalize" , SolverOp::CANONICALIZE } , { "generate" , SolverOp::GENERATE }
+    };
+    mix = ( name == "mix" );
+    if ( mix )
+        return true;
+    auto found = ops.find( name );
+    if ( found == ops.end() )
+        return false;
+    op = found->second;
+    return true;
+}
+
+//corpus puzzles,generated ones when the corpus is missing
+static std::vector<puzzle_t> collect_puzzles( std::size_t number )
+{
+    std::vector<puzzle_t> puzzles;
+    for ( std::size_t i = 0 ; i < number ; i++ )
+    {
+        puzzle_t puzzle = get_local_puzzle( static_cast<SUDOKU_LEVEL>( i%static_cast<std::size_t>( SUDOKU_LEVEL::_LEVEL_COUNT ) ) );
+        if ( puzzle == puzzle_t() )
+            puzzle = Sudoku().get_puzzle();
+        puzzles.push_back( puzzle );
+    }
+    return puzzles;
+}
+
+static SolverRequest make_request( std::uint32_t id , SolverOp op , const puzzle_t& puzzle , std::uint32_t budget_ms )
+{
+    SolverRequest request = { id , op , budget_ms , {} };
+    if ( ( op == SolverOp::GENERATE ) || ( op == SolverOp::STATS ) )
+        return request;
+    append_packed( request.payload , puzzle );
+    if ( op == SolverOp::COUNT )
+    {
+        //uniqueness check
+        std::uint32_t limit = 2;
+        const std::uint8_t * bytes = reinterpret_cast<const std::uint8_t *>( &limit );
+        request.payload.insert( request.payload.end() , bytes , bytes + sizeof( limit ) );
+    }
+    return request;
+}
+
+int main( int argc , char * argv[] )
+{
+    std::string socket_path( default_solver_socket() );
+    std::size_t connection_number = 4;
+    std::size_t depth = 16;
+    std::size_t request_number = 10000;
+    std::size_t puzzle_number = 64;
+    std::uint32_t budget_ms = 0;
+    SolverOp op = SolverOp::SOLVE;
+    bool mix = true;
+
+    for ( int i = 1 ; i < argc ; i++ )
+    {
+        std::string option( argv[i] );
+        bool has_value = ( i + 1 < argc );
+        if ( ( option == "--socket" ) && has_value )
+            socket_path = argv[++i];
+        else if ( ( option == "--connections" ) && has_value )
+            connection_number = std::max<std::size_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else if ( ( option == "--depth" ) && has_value )
+            depth = std::max<std::size_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else if ( ( option == "--requests" ) && has_value )
+            request_number = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--puzzles" ) && has_value )
+            puzzle_number = std::max<std::size_t>( 1 , std::strtoul( argv[++i] , nullptr , 10 ) );
+        else if ( ( option == "--budget" ) && has_value )
+            budget_ms = std::strtoul( argv[++i] , nullptr , 10 );
+        else if ( ( option == "--op" ) && has_value && parse_op( argv[i + 1] , op , mix ) )
+            i++;
+        else
+        {
+            std::fprintf( stderr , "unknown option:%s\n" , option.c_str() );
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<puzzle_t> puzzles = collect_puzzles( puzzle_number );
+    std::mutex result_mutex;
+    std::vector<double> latencies;
+    std::vector<double> server_times;
+    latencies.reserve( request_number );
+    server_times.reserve( request_number );
+    std::array<std::size_t , 256> status_counts = { 0 };
+    std::atomic<std::size_t> failed_connections( 0 );
+
+    //every connection keep depth requests outstanding
+    auto run_connection = [ & ]( std::size_t connection_index )
+    {
+        std::size_t share = request_number/connection_number + ( ( connection_index < request_number%connection_number ) ? 1 : 0 );
+        std::vector<double> own_latencies;
+        std::vector<double> own_server_times;
+        std::array<std::size_t , 256> own_counts = { 0 };
+        int fd = -1;
+        try
+        {
+            fd = connect_solver( socket_path );
+            std::unordered_map< std::uint32_t , std::chrono::steady_clock::time_point > outstanding;
+            std::size_t sent = 0;
+            std::size_t received = 0;
+            while ( received < share )
+            {
+                while ( ( sent < share ) && ( outstanding.size() < depth ) )
+                {
+                    std::uint32_t id = static_cast<std::uint32_t>( sent );
+                    SolverOp request_op = op;
+                    if ( mix )
+                    {
+                        static constexpr SolverOp mix_ops[] = { SolverOp::SOLVE , SolverOp::SOLVE , SolverOp::COUNT , SolverOp::GRADE };
+                        request_op = mix_ops[sent%( sizeof( mix_ops )/sizeof( mix_ops[0] ) )];
+                    }
+                    const puzzle_t& puzzle = puzzles[( connection_index*7919 + sent )%puzzles.size()];
+                    outstanding[id] = std::chrono::steady_clock::now();
+                    write_frame( fd , encode_request( make_request( id , request_op , puzzle , budget_ms ) ) );
+                    sent++;
+                }
+                SolverResponse response;
+                if ( read_response( fd , response ) == false )
+                    throw std::runtime_error( "daemon closed the connection" );
+                auto found = outstanding.find( response.id );
+                if ( found == outstanding.end() )
+                    throw std::runtime_error( "response for unknown request " + std::to_string( response.id ) );
+                std::chrono::duration<double,std::milli> cost = std::chrono::steady_clock::now() - found->second;
+                outstanding.erase( found );
+                own_latencies.push_back( cost.count() );
+                own_server_times.push_back( response.server_us/1000.0 );
+                own_counts[static_cast<std::uint8_t>( response.status )]++;
+                received++;
+            }
+        }
+        catch( const std::exception& e )
+        {
+            std::fprintf( stderr , "connection %zu:%s\n" , connection_index , e.what() );
+            failed_connections++;
+        }
+        if ( fd >= 0 )
+            close( fd );
+        std::lock_guard<std::mutex> lock( result_mutex );
+        latencies.insert( latencies.end() , own_latencies.begin() , own_latencies.end() );
+        server_times.insert( server_times.end() , own_server_times.begin() , own_server_times.end() );
+        for ( std::size_t i = 0 ; i < own_counts.size() ; i++ )
+            status_counts[i] += own_counts[i];
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> connections;
+    for ( std::size_t i = 0 ; i < connection_number ; i++ )
+    {
+        connections.emplace_back( run_connection , i );
+    }
+    for ( auto& connection : connections )
+    {
+        connection.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+    std::sort( latencies.begin() , latencies.end() );
+    std::sort( server_times.begin() , server_times.end() );
+    std::printf( "requests:%zu connections:%zu depth:%zu failed connections:%zu\n" ,
+                 latencies.size() , connection_number , depth , failed_connections.load() );
+    std::printf( "throughput:%.0f req/s\n" , latencies.size()/std::max( elapsed.count() , 1e-9 ) );
+    std::printf( "latency ms p50:%.3f p90:%.3f p99:%.3f max:%.3f\n" ,
+                 percentile( latencies , 0.50 ) , percentile( latencies , 0.90 ) ,
+                 percentile( latencies , 0.99 ) , latencies.empty() ? 0.0 : latencies.back() );
+    std::printf( "server ms p50:%.3f p99:%.3f\n" , percentile( server_times , 0.50 ) , percentile( server_times , 0.99 ) );
+    for ( std::size_t i = 0 ; i < status_counts.size() ; i++ )
+    {
+        if ( status_counts[i] != 0 )
+            std::printf( "status %s:%zu\n" , solver_status_to_string( static_cast<SolverStatus>( i ) ) , status_counts[i] );
+    }
+
+    //warm cache effect
+    try
+    {
+        int fd = connect_solver( socket_path );
+        write_frame( fd , encode_request( make_request( 0 , SolverOp::STATS , puzzle_t() , 0 ) ) );
+        SolverResponse response;
+        if ( read_response( fd , response ) && ( response.payload.size() == 3*sizeof( std::uint64_t ) ) )
+        {
+            std::uint64_t stats[3];
+            std::memcpy( stats , response.payload.data() , sizeof( stats ) );
+            std::printf( "daemon requests:%llu solution cache hit:%llu miss:%llu\n" ,
+                         static_cast<unsigned long long>( stats[0] ) , static_cast<unsigned long long>( stats[1] ) ,
+                         static_cast<unsigned long long>( stats[2] ) );
+        }
+        close( fd );
+    }
+    catch( const std::exception& e )
+    {
+        std::fprintf( stderr , "stats:%s\n" , e.what() );
+    }
+    return failed_connections.load() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}